@@ -0,0 +1,57 @@
+#include "boot_profile.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+namespace BootProfile {
+
+namespace {
+
+struct Phase {
+  const char *name;
+  int64_t us; // esp_timer time, from app start
+  uint32_t freeHeap;
+};
+
+Phase phases[MAX_PHASES];
+int phaseCount = 0;
+bool frameExpected = false;
+bool firstFrame = false;
+
+} // namespace
+
+void mark(const char *phase) {
+  if (phaseCount >= MAX_PHASES) {
+    return;
+  }
+  phases[phaseCount] = {phase, esp_timer_get_time(), ESP.getFreeHeap()};
+  phaseCount++;
+}
+
+void expectFrame() { frameExpected = true; }
+
+void frameFlushed() {
+  if (!frameExpected || firstFrame) {
+    return;
+  }
+  firstFrame = true;
+  mark("first frame");
+}
+
+bool firstFrameShown() { return firstFrame; }
+
+void report() {
+  Serial.printf("Boot: %d phases (%s)\n", phaseCount,
+                FAST_BOOT ? "fast boot" : "debug boot");
+  int64_t previous = 0;
+  for (int i = 0; i < phaseCount; i++) {
+    const Phase &phase = phases[i];
+    Serial.printf("  %-16s at %6lu ms  +%5lu ms  heap %lu\n", phase.name,
+                  static_cast<unsigned long>(phase.us / 1000),
+                  static_cast<unsigned long>((phase.us - previous) / 1000),
+                  static_cast<unsigned long>(phase.freeHeap));
+    previous = phase.us;
+  }
+}
+
+} // namespace BootProfile
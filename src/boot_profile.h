@@ -0,0 +1,33 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <cstdint>
+
+// Production builds set FAST_BOOT=1: no wait for a serial monitor, a status
+// frame on the panel before the EEZ screens are built, and the mould
+// library, keyboard and keypad set up after the first real frame instead of
+// before it.
+#ifndef FAST_BOOT
+#define FAST_BOOT 0
+#endif
+
+// Boot phase timestamps. mark() records the time since the app started and
+// the free heap; report() prints each phase with the time it took.
+namespace BootProfile {
+
+constexpr int MAX_PHASES = 24;
+
+// `phase` must outlive the report; pass a string literal.
+void mark(const char *phase);
+
+// The next frame flushed after expectFrame() is marked "first frame", so
+// status frames drawn earlier don't count.
+void expectFrame();
+void frameFlushed();
+bool firstFrameShown();
+
+void report();
+
+} // namespace BootProfile
+
+#endif // BOOT_PROFILE_H
@@ -1,4 +1,6 @@
 #include "display_comms.h"
+#include "refill_engine.h"
+#include "shot_stats.h"
 #include "ui/ui.h"
 #include "ui/screens.h"
 #include "ui/vars.h"
@@ -28,11 +30,70 @@ static size_t rxLen = 0;
 static Status status = {};
 static MouldParams mould = {};
 static CommonParams common = {};
+static uint32_t received = 0;
+
+// The engine is only touched from the comms context. Each change is copied
+// out under the spinlock for the UI, which never sees a half-updated stack.
+static RefillEngine refill;
+static RefillBlock publishedBlocks[RefillStack::CAPACITY];
+static int publishedCount = 0;
+static volatile uint32_t publishedRevision = 0; // bumped on every copy
+static uint32_t publishedEngineRevision = 0;    // engine revision copied
+static portMUX_TYPE refillLock = portMUX_INITIALIZER_UNLOCKED;
+
+// A warm-start restore handed over from another task, for the comms context
+// to apply before the next message. Guarded by refillLock.
+struct RefillRestore {
+    float turns;
+    char state[sizeof(Status::state)];
+    int count;
+    RefillBlock blocks[RefillStack::CAPACITY];
+};
+static RefillRestore restoreRequest = {};
+static volatile bool restorePending = false;
+
+static void publishRefill() {
+    if (refill.revision() == publishedEngineRevision) return;
+    const RefillStack &stack = refill.stack();
+    portENTER_CRITICAL(&refillLock);
+    publishedCount = stack.count();
+    for (int i = 0; i < publishedCount; i++) {
+        publishedBlocks[i] = stack.at(i);
+    }
+    publishedEngineRevision = refill.revision();
+    publishedRevision++;
+    portEXIT_CRITICAL(&refillLock);
+}
+
+static void applyRefillRestore() {
+    if (!restorePending) return;
+    static RefillRestore request;
+    portENTER_CRITICAL(&refillLock);
+    request = restoreRequest;
+    restorePending = false;
+    portEXIT_CRITICAL(&refillLock);
+    refill.restore(request.turns, request.state, request.blocks,
+                   request.count);
+    publishRefill();
+}
+
+// Shot statistics follow the same pattern, with their own lock.
+static ShotStats shots;
+static ShotSummary publishedShots = {};
+static volatile uint32_t publishedShotRevision = 0;
+static portMUX_TYPE shotLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void publishShots() {
+    if (shots.revision() == publishedShotRevision) return;
+    ShotSummary summary;
+    shots.summary(summary);
+    portENTER_CRITICAL(&shotLock);
+    publishedShots = summary;
+    publishedShotRevision = shots.revision();
+    portEXIT_CRITICAL(&shotLock);
+}
 
 static float turnsToCm3(float turns) {
-    // Keep aligned with controller's TURNS_PER_CM3_VOL
-    static const float TURNS_PER_CM3 = 0.99925f;
-    if (TURNS_PER_CM3 == 0.0f) return 0.0f;
     return turns / TURNS_PER_CM3;
 }
 
@@ -47,6 +108,8 @@ void begin(HardwareSerial &serial, int rxPin, int txPin, uint32_t baud) {
     uart->begin(baud, SERIAL_8N1, rxPin, txPin);
     rxLen = 0;
     status.encoderTurns = 0.0f;
+    status.encoderSampleMs = 0;
+    status.encoderSampleCount = 0;
     status.tempC = 0.0f;
     status.state[0] = '\0';
     status.errorCode = 0;
@@ -89,6 +152,7 @@ static void trimInPlace(char *text) {
 }
 
 static void parseMessage(const char *msg) {
+    applyRefillRestore();
     char cmd[24];
     const char *rest = nextToken(msg, cmd, sizeof(cmd), '|');
     trimInPlace(cmd);
@@ -96,6 +160,12 @@ static void parseMessage(const char *msg) {
     if (strcasecmp(cmd, "ENC") == 0) {
         if (rest) {
             status.encoderTurns = static_cast<float>(atof(rest));
+            status.encoderSampleMs = millis();
+            status.encoderSampleCount++;
+            received |= RX_ENC;
+            refill.onEncoder(status.encoderTurns, status.encoderSampleMs);
+            publishRefill();
+            shots.onEncoder(status.encoderTurns, status.encoderSampleMs);
         }
         return;
     }
@@ -103,6 +173,9 @@ static void parseMessage(const char *msg) {
     if (strcasecmp(cmd, "TEMP") == 0) {
         if (rest) {
             status.tempC = static_cast<float>(atof(rest));
+            received |= RX_TEMP;
+            refill.onTemperature(status.tempC, millis());
+            publishRefill();
         }
         return;
     }
@@ -114,6 +187,11 @@ static void parseMessage(const char *msg) {
             trimInPlace(field);
             strncpy(status.state, field, sizeof(status.state) - 1);
             status.state[sizeof(status.state) - 1] = '\0';
+            received |= RX_STATE;
+            refill.onState(status.state, millis());
+            publishRefill();
+            shots.onState(status.state, millis());
+            publishShots();
         }
         return;
     }
@@ -129,12 +207,15 @@ static void parseMessage(const char *msg) {
                 status.errorMsg[sizeof(status.errorMsg) - 1] = '\0';
                 trimInPlace(status.errorMsg);
             }
+            received |= RX_ERROR;
         }
         return;
     }
 
     if (strcasecmp(cmd, "MOULD_OK") == 0) {
         char field[64];
+        char previousName[sizeof(mould.name)];
+        strcpy(previousName, mould.name);
         int idx = 0;
         while (rest) {
             rest = nextToken(rest, field, sizeof(field), '|');
@@ -159,6 +240,12 @@ static void parseMessage(const char *msg) {
             }
             idx++;
         }
+        received |= RX_MOULD;
+        // Another mould's shots say nothing about this one.
+        if (strcmp(previousName, mould.name) != 0) {
+            shots.reset();
+            publishShots();
+        }
         return;
     }
 
@@ -187,12 +274,23 @@ static void parseMessage(const char *msg) {
             }
             idx++;
         }
+        received |= RX_COMMON;
         return;
     }
 
     COMMS_LOG("Unknown message: %s", msg);
 }
 
+void inject(const char *line) {
+    if (!line) return;
+    char buf[sizeof(rxBuffer)];
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    trimInPlace(buf);
+    COMMS_LOG("Injected: %s", buf);
+    parseMessage(buf);
+}
+
 void update() {
     if (!uart) return;
     while (uart->available() > 0) {
@@ -325,6 +423,70 @@ bool sendCommon(const CommonParams &params) {
 const Status &getStatus() { return status; }
 const MouldParams &getMould() { return mould; }
 const CommonParams &getCommon() { return common; }
+uint32_t receivedMask() { return received; }
+
+void restoreRefill(float turns, const char *state,
+                   const RefillBlock *blocks, int count) {
+    if (count > RefillStack::CAPACITY) count = RefillStack::CAPACITY;
+    portENTER_CRITICAL(&refillLock);
+    restorePending = true;
+    restoreRequest.turns = turns;
+    strncpy(restoreRequest.state, state, sizeof(restoreRequest.state) - 1);
+    restoreRequest.state[sizeof(restoreRequest.state) - 1] = '\0';
+    restoreRequest.count = count;
+    // The UI sees the restored stack now, before the engine takes it over.
+    publishedCount = count;
+    for (int i = 0; i < count; i++) {
+        restoreRequest.blocks[i] = blocks[i];
+        publishedBlocks[i] = blocks[i];
+    }
+    publishedRevision++;
+    portEXIT_CRITICAL(&refillLock);
+}
+
+const RefillEngine &refillEngine() {
+    applyRefillRestore();
+    return refill;
+}
+
+uint32_t refillRevision() { return publishedRevision; }
+
+int copyRefillBlocks(RefillBlock *out, int maxCount) {
+    portENTER_CRITICAL(&refillLock);
+    int count = publishedCount < maxCount ? publishedCount : maxCount;
+    for (int i = 0; i < count; i++) {
+        out[i] = publishedBlocks[i];
+    }
+    portEXIT_CRITICAL(&refillLock);
+    return count;
+}
+
+const ShotStats &shotStats() { return shots; }
+
+void resetShotStats() {
+    shots.reset();
+    publishShots();
+}
+
+uint32_t shotRevision() { return publishedShotRevision; }
+
+void copyShotSummary(ShotSummary &out) {
+    portENTER_CRITICAL(&shotLock);
+    out = publishedShots;
+    portEXIT_CRITICAL(&shotLock);
+}
+
+bool sameMould(const MouldParams &a, const MouldParams &b) {
+    return strncmp(a.name, b.name, sizeof(a.name)) == 0 &&
+           a.fillVolume == b.fillVolume && a.fillSpeed == b.fillSpeed &&
+           a.fillPressure == b.fillPressure && a.packVolume == b.packVolume &&
+           a.packSpeed == b.packSpeed && a.packPressure == b.packPressure &&
+           a.packTime == b.packTime && a.coolingTime == b.coolingTime &&
+           a.fillAccel == b.fillAccel && a.fillDecel == b.fillDecel &&
+           a.packAccel == b.packAccel && a.packDecel == b.packDecel &&
+           strncmp(a.mode, b.mode, sizeof(a.mode)) == 0 &&
+           a.injectTorque == b.injectTorque;
+}
 
 static bool stateEquals(const char *a, const char *b) {
     if (!a || !b) return false;
@@ -4,6 +4,11 @@
 #include <Arduino.h>
 #include <stdint.h>
 
+class RefillEngine;
+class ShotStats;
+struct RefillBlock;
+struct ShotSummary;
+
 namespace DisplayComms {
 
 struct MouldParams {
@@ -24,6 +29,10 @@ struct MouldParams {
     float injectTorque;
 };
 
+// Compares field by field; MouldParams has a padding byte after `mode`
+// that memcmp would read.
+bool sameMould(const MouldParams &a, const MouldParams &b);
+
 struct CommonParams {
     float trapAccel;
     float compressTorque;
@@ -43,12 +52,18 @@ struct CommonParams {
 
 struct Status {
     float encoderTurns;
+    uint32_t encoderSampleMs;    // millis() when the last ENC line arrived
+    uint32_t encoderSampleCount; // bumps on every ENC line, even if unchanged
     float tempC;
     char state[24];
     uint16_t errorCode;
     char errorMsg[64];
 };
 
+// Plunger encoder turns per cm3 dosed. Keep aligned with the controller's
+// TURNS_PER_CM3_VOL.
+constexpr float TURNS_PER_CM3 = 0.99925f;
+
 void begin(HardwareSerial &serial, int rxPin, int txPin, uint32_t baud = 115200);
 void update();
 void applyUiUpdates();
@@ -66,6 +81,43 @@ const MouldParams &getMould();
 const CommonParams &getCommon();
 bool isSafeForUpdate();
 
+// Message kinds received since boot, so callers can tell live data from
+// the zeroed defaults.
+enum Received : uint32_t {
+    RX_ENC = 1u << 0,
+    RX_TEMP = 1u << 1,
+    RX_STATE = 1u << 2,
+    RX_ERROR = 1u << 3,
+    RX_MOULD = 1u << 4,
+    RX_COMMON = 1u << 5,
+};
+uint32_t receivedMask();
+
+// Parses one protocol line as if it had arrived on the UART (MOCK commands).
+// Same context as update().
+void inject(const char *line);
+
+// Refill accounting runs here, on every STATE and ENC message in order.
+// refillEngine() belongs to the comms context, i.e. the task calling
+// update(); the UI reads the published block list instead. restoreRefill()
+// may be called from any task: the stack is published at once and handed
+// to the engine in the comms context before the next message.
+void restoreRefill(float turns, const char *state,
+                   const RefillBlock *blocks, int count);
+const RefillEngine &refillEngine();
+
+// Any context. The revision changes whenever the block list does.
+uint32_t refillRevision();
+int copyRefillBlocks(RefillBlock *out, int maxCount);
+
+// Shot statistics, from the same STATE and ENC messages; reset when the
+// mould changes. Comms context:
+const ShotStats &shotStats();
+void resetShotStats();
+// Any context:
+uint32_t shotRevision();
+void copyShotSummary(ShotSummary &out);
+
 } // namespace DisplayComms
 
 #endif // DISPLAY_COMMS_H
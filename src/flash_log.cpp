@@ -0,0 +1,106 @@
+#include "flash_log.h"
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace FlashLog {
+
+namespace {
+
+const esp_partition_t *partition = nullptr;
+spi_flash_mmap_handle_t mapHandle = 0;
+const uint8_t *mapped = nullptr;
+uint32_t bankBytes = 0;
+
+// Sleep between sector erases, long enough for the GUI task to run a tick.
+constexpr uint32_t ERASE_YIELD_MS = 5;
+
+bool blank(const uint8_t *data, uint32_t size) {
+  const uint32_t *word = reinterpret_cast<const uint32_t *>(data);
+  for (uint32_t i = 0; i < size / 4; i++) {
+    if (word[i] != 0xffffffff) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool begin(const char *label) {
+  if (mapped) {
+    return true;
+  }
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                       ESP_PARTITION_SUBTYPE_ANY, label);
+  if (!partition) {
+    return false;
+  }
+  // Each bank is erased on its own, so it must be whole sectors.
+  bankBytes = (partition->size / 2) & ~(SPI_FLASH_SEC_SIZE - 1);
+  if (bankBytes == 0) {
+    Serial.printf("FlashLog: partition '%s' too small\n", label);
+    partition = nullptr;
+    return false;
+  }
+  const void *ptr = nullptr;
+  esp_err_t err = esp_partition_mmap(partition, 0, bankBytes * 2,
+                                     SPI_FLASH_MMAP_DATA, &ptr, &mapHandle);
+  if (err != ESP_OK) {
+    Serial.printf("FlashLog: mapping '%s' FAILED (%s)\n", label,
+                  esp_err_to_name(err));
+    partition = nullptr;
+    return false;
+  }
+  mapped = static_cast<const uint8_t *>(ptr);
+  Serial.printf("FlashLog: '%s' mapped, 2 banks of %lu bytes\n", label,
+                static_cast<unsigned long>(bankBytes));
+  return true;
+}
+
+bool available() { return mapped != nullptr; }
+
+uint32_t bankSize() { return bankBytes; }
+
+const uint8_t *bank(int index) {
+  return mapped ? mapped + index * bankBytes : nullptr;
+}
+
+// The flash driver flushes the cache over the range it changes, so the
+// mapping sees erases and writes as soon as they return.
+bool erase(int index) {
+  if (!mapped) {
+    return false;
+  }
+  for (uint32_t offset = 0; offset < bankBytes; offset += SPI_FLASH_SEC_SIZE) {
+    if (blank(bank(index) + offset, SPI_FLASH_SEC_SIZE)) {
+      continue;
+    }
+    esp_err_t err = esp_partition_erase_range(
+        partition, index * bankBytes + offset, SPI_FLASH_SEC_SIZE);
+    if (err != ESP_OK) {
+      Serial.printf("FlashLog: erase of bank %d FAILED (%s)\n", index,
+                    esp_err_to_name(err));
+      return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(ERASE_YIELD_MS));
+  }
+  return true;
+}
+
+bool write(int index, uint32_t offset, const void *data, size_t size) {
+  if (!mapped || offset + size > bankBytes) {
+    return false;
+  }
+  esp_err_t err =
+      esp_partition_write(partition, index * bankBytes + offset, data, size);
+  if (err != ESP_OK) {
+    Serial.printf("FlashLog: write FAILED (%s)\n", esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+} // namespace FlashLog
@@ -0,0 +1,37 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Raw data partition split into two equal banks and mapped into the address
+// space through the flash cache, so a log kept there is read in place with
+// no filesystem and no copy. The layout inside a bank is up to the caller;
+// this module only erases and writes. Writes and erases stall both cores
+// while the cache is off, so they belong on a background task.
+//
+// A whole bank is never erased in one call to the flash driver: erase()
+// goes one 4 KB sector at a time, skips sectors that are already blank and
+// sleeps between the others so the GUI task gets to draw. The longest
+// freeze is therefore one sector erase, typically 30-50 ms and a few
+// hundred ms worst case per the flash datasheet, instead of the whole
+// bank's worth (well over a second for 128 KB).
+namespace FlashLog {
+
+// Maps the partition named `label`. False if the partition table has none.
+bool begin(const char *label);
+bool available();
+
+uint32_t bankSize();
+
+// Read-only view of a whole bank; erased bytes read 0xff.
+const uint8_t *bank(int index);
+
+// Call from a task that may sleep; see above.
+bool erase(int index);
+// Flash bits only go from 1 to 0, so `offset` must lie in erased space.
+bool write(int index, uint32_t offset, const void *data, size_t size);
+
+} // namespace FlashLog
+
+#endif // FLASH_LOG_H
@@ -10,6 +10,7 @@
 #include <lvgl.h>
 
 // EEZ Studio generated UI files
+#include "boot_profile.h"
 #include "display_comms.h"
 #include "prd_ui.h"
 #include "ui/eez-flow.h"
@@ -124,6 +125,9 @@ void my_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
   lv_draw_sw_rgb565_swap(px_map, w * h);
   lcd.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)px_map);
   lv_disp_flush_ready(disp);
+  if (lv_display_flush_is_last(disp)) {
+    BootProfile::frameFlushed();
+  }
 }
 
 uint32_t my_tick_cb() { return (esp_timer_get_time() / 1000LL); }
@@ -146,6 +150,22 @@ void my_touch_read_cb(lv_indev_t *drv, lv_indev_data_t *data) {
   delay(15);
 }
 
+#if FAST_BOOT
+// Plain screen with one label, pushed straight to the panel while the EEZ
+// screens are built.
+lv_obj_t *showStatusFrame(const char *text) {
+  lv_obj_t *screen = lv_obj_create(nullptr);
+  lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+  lv_obj_t *label = lv_label_create(screen);
+  lv_label_set_text(label, text);
+  lv_obj_set_style_text_color(label, lv_color_white(), 0);
+  lv_obj_center(label);
+  lv_screen_load(screen);
+  lv_refr_now(nullptr);
+  return screen;
+}
+#endif
+
 // GUI Task to handle LVGL and UI updates
 void guiTask(void *pvParameters) {
   uint32_t lastHeartbeat = 0;
@@ -170,8 +190,11 @@ void guiTask(void *pvParameters) {
 }
 
 void setup() {
+  BootProfile::mark("setup");
   Serial.begin(115200);
+#if !FAST_BOOT
   delay(3000); // Wait for Serial Monitor
+#endif
   Serial.println("Booting Motorized Injector UI...");
 
   // Initialize backlight
@@ -183,7 +206,10 @@ void setup() {
   lcd.init();
   lcd.setRotation(1); // set rotation to match LVGL's rotation
   lcd.fillScreen(TFT_BLACK);
+#if !FAST_BOOT
   delay(200);
+#endif
+  BootProfile::mark("display");
 
   Serial.print("Display ");
   Serial.print(lcd.width());
@@ -222,8 +248,21 @@ void setup() {
   // lv_display_set_default(display);
 
   Serial.println("Display initialized");
+  BootProfile::mark("lvgl");
+
+#if FAST_BOOT
+  lv_obj_t *statusScreen = showStatusFrame("Starting...");
+  BootProfile::mark("status frame");
+#endif
 
   ui_init();
+#if FAST_BOOT
+  // ui_init loads the main screen, so the status screen is no longer shown.
+  if (lv_screen_active() != statusScreen) {
+    lv_obj_delete(statusScreen);
+  }
+#endif
+  BootProfile::mark("ui_init");
 
   // Sync max barrel capacity from native constant into EEZ global state
   plunger_stateValue plungerStateValue(
@@ -235,6 +274,7 @@ void setup() {
   // Initialize touch
   touch_init();
   Serial.println("Touch initialized");
+  BootProfile::mark("touch");
 
   // Initialize controller UART link. (DISABLED for Debugging due to Pin 43/44
   // conflict with USB-Serial) DisplayComms::begin(Serial2, DISPLAY_UART_RX_PIN,
@@ -247,6 +287,7 @@ void setup() {
   // Create GUI task on Core 1 with 16KB stack
   xTaskCreatePinnedToCore(guiTask, "guiTask", 16384, NULL, 5, NULL, 1);
   Serial.println("GUI Task Created");
+  BootProfile::mark("gui task");
 }
 
 extern void handleDebugCommand(const char *cmd);
@@ -0,0 +1,103 @@
+#include "motion_smoother.h"
+
+void MotionSmoother::setLimits(float minLimit, float maxLimit) {
+  minValue = minLimit;
+  maxValue = maxLimit;
+}
+
+void MotionSmoother::reset(float value, uint32_t nowMs) {
+  count = 1;
+  head = 0;
+  values[0] = value;
+  times[0] = nowMs;
+  velocity = 0.0f;
+  meanIntervalMs = 0;
+}
+
+void MotionSmoother::addSample(float value, uint32_t sampleMs) {
+  if (count == 0 || sampleMs - times[head] > STALE_GAP_MS) {
+    reset(value, sampleMs);
+    return;
+  }
+  if (sampleMs == times[head]) {
+    values[head] = value;
+  } else {
+    head = (head + 1) % HISTORY;
+    values[head] = value;
+    times[head] = sampleMs;
+    if (count < HISTORY) {
+      count++;
+    }
+  }
+  refit();
+}
+
+void MotionSmoother::refit() {
+  velocity = 0.0f;
+  meanIntervalMs = 0;
+  if (count < 2) {
+    return;
+  }
+
+  // Least-squares slope with time measured back from the newest sample, so
+  // the numbers stay small and millis() wrap-around is harmless.
+  float sumT = 0.0f;
+  float sumV = 0.0f;
+  for (int i = 0; i < count; i++) {
+    int idx = (head - i + HISTORY) % HISTORY;
+    sumT -= static_cast<float>(times[head] - times[idx]);
+    sumV += values[idx];
+  }
+  float meanT = sumT / count;
+  float meanV = sumV / count;
+
+  float num = 0.0f;
+  float den = 0.0f;
+  for (int i = 0; i < count; i++) {
+    int idx = (head - i + HISTORY) % HISTORY;
+    float t = -static_cast<float>(times[head] - times[idx]) - meanT;
+    num += t * (values[idx] - meanV);
+    den += t * t;
+  }
+  if (den > 0.0f) {
+    velocity = num / den;
+  }
+  if (velocity > -MIN_VELOCITY && velocity < MIN_VELOCITY) {
+    velocity = 0.0f;
+  }
+
+  int oldest = (head - (count - 1) + HISTORY) % HISTORY;
+  meanIntervalMs = (times[head] - times[oldest]) / (count - 1);
+}
+
+uint32_t MotionSmoother::extrapolationLimitMs() const {
+  uint32_t limit = meanIntervalMs + meanIntervalMs / 2;
+  return limit < MAX_EXTRAPOLATE_MS ? limit : MAX_EXTRAPOLATE_MS;
+}
+
+float MotionSmoother::estimate(uint32_t nowMs) const {
+  if (count == 0) {
+    return 0.0f;
+  }
+  float value = values[head];
+  if (velocity != 0.0f) {
+    uint32_t dt = nowMs - times[head];
+    uint32_t limit = extrapolationLimitMs();
+    if (dt > limit) {
+      dt = limit;
+    }
+    value += velocity * static_cast<float>(dt);
+  }
+  if (value < minValue)
+    value = minValue;
+  if (value > maxValue)
+    value = maxValue;
+  return value;
+}
+
+bool MotionSmoother::isSettled(uint32_t nowMs) const {
+  if (count == 0 || velocity == 0.0f) {
+    return true;
+  }
+  return nowMs - times[head] >= extrapolationLimitMs();
+}
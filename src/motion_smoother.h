@@ -0,0 +1,45 @@
+#ifndef MOTION_SMOOTHER_H
+#define MOTION_SMOOTHER_H
+
+#include <cstdint>
+
+// Turns sparse, timestamped position samples (e.g. ENC lines at 10-20 Hz)
+// into a per-frame position. Velocity is a least-squares fit over the last
+// few samples; between samples the latest value is extrapolated along it,
+// capped to roughly one sample interval so a stalled stream settles instead
+// of running away.
+class MotionSmoother {
+public:
+  void setLimits(float minValue, float maxValue);
+
+  // Drop history and hold `value` (state changes, first sample, long gaps).
+  void reset(float value, uint32_t nowMs);
+  void addSample(float value, uint32_t sampleMs);
+
+  float estimate(uint32_t nowMs) const;
+
+  // True once estimate() can no longer change until the next sample.
+  bool isSettled(uint32_t nowMs) const;
+
+private:
+  static constexpr int HISTORY = 4;
+  // A gap longer than this starts a fresh motion instead of fitting across it.
+  static constexpr uint32_t STALE_GAP_MS = 500;
+  static constexpr uint32_t MAX_EXTRAPOLATE_MS = 150;
+  static constexpr float MIN_VELOCITY = 0.0005f; // units per ms
+
+  void refit();
+  uint32_t extrapolationLimitMs() const;
+
+  float values[HISTORY] = {};
+  uint32_t times[HISTORY] = {};
+  int count = 0;
+  int head = 0; // index of the newest sample
+
+  float velocity = 0.0f; // units per ms
+  uint32_t meanIntervalMs = 0;
+  float minValue = -1e9f;
+  float maxValue = 1e9f;
+};
+
+#endif // MOTION_SMOOTHER_H
@@ -0,0 +1,427 @@
+#include "mould_library.h"
+
+#include "storage_worker.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace MouldLibrary {
+
+namespace {
+
+constexpr int LEGACY_MAX_PROFILES = 16;
+constexpr int MAX_DEFERRED_REMOVALS = StorageWorker::MAX_PENDING_RECORDS;
+
+struct CacheSlot {
+  bool valid;
+  bool dirty; // newer than flash, waiting for room in the worker's table
+  uint32_t id;
+  uint32_t stamp; // cacheClock at last access
+  DisplayComms::MouldParams mould;
+};
+
+Entry *entries = nullptr;
+Storage::MouldIndexHeader header = {};
+bool ready = false;
+
+CacheSlot cache[CACHE_SIZE];
+uint32_t cacheClock = 0;
+
+// Tombstones the worker's table had no room for yet.
+uint32_t deferredRemovals[MAX_DEFERRED_REMOVALS];
+int deferredRemovalCount = 0;
+
+// MRU order as a doubly linked list over positions.
+int16_t mruPrev[MAX_PROFILES];
+int16_t mruNextPos[MAX_PROFILES];
+int16_t mruHead = -1;
+int16_t mruTail = -1;
+uint32_t rev = 0;
+
+bool validPosition(int position) {
+  return ready && position >= 0 && position < static_cast<int>(header.count);
+}
+
+bool saveIndex() { return StorageWorker::saveIndex(header, entries); }
+
+CacheSlot *findCached(uint32_t id) {
+  for (CacheSlot &slot : cache) {
+    if (slot.valid && slot.id == id) {
+      slot.stamp = ++cacheClock;
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+// Dirty slots are never evicted; nullptr when every slot is dirty.
+CacheSlot *claimSlot(uint32_t id) {
+  CacheSlot *victim = nullptr;
+  for (CacheSlot &slot : cache) {
+    if (slot.dirty) {
+      continue;
+    }
+    if (!slot.valid) {
+      victim = &slot;
+      break;
+    }
+    if (!victim || slot.stamp < victim->stamp) {
+      victim = &slot;
+    }
+  }
+  if (!victim) {
+    return nullptr;
+  }
+  victim->valid = true;
+  victim->dirty = false;
+  victim->id = id;
+  victim->stamp = ++cacheClock;
+  return victim;
+}
+
+void dropCached(uint32_t id) {
+  for (CacheSlot &slot : cache) {
+    if (slot.valid && slot.id == id) {
+      slot.valid = false;
+      slot.dirty = false;
+    }
+  }
+}
+
+// Queues the record, or keeps it dirty in the cache for flush() while the
+// worker's table is full. False only when the cache is all dirty as well.
+bool saveOrDefer(uint32_t id, const DisplayComms::MouldParams &mould) {
+  CacheSlot *slot = findCached(id);
+  if (!slot) {
+    slot = claimSlot(id);
+  }
+  bool queued = StorageWorker::saveRecord(id, mould);
+  if (!slot) {
+    return queued;
+  }
+  slot->mould = mould;
+  slot->dirty = !queued;
+  return true;
+}
+
+void mruUnlink(int position) {
+  int prev = mruPrev[position];
+  int next = mruNextPos[position];
+  if (prev >= 0) {
+    mruNextPos[prev] = next;
+  } else {
+    mruHead = next;
+  }
+  if (next >= 0) {
+    mruPrev[next] = prev;
+  } else {
+    mruTail = prev;
+  }
+}
+
+void mruPushFront(int position) {
+  mruPrev[position] = -1;
+  mruNextPos[position] = mruHead;
+  if (mruHead >= 0) {
+    mruPrev[mruHead] = position;
+  } else {
+    mruTail = position;
+  }
+  mruHead = position;
+}
+
+void mruPushBack(int position) {
+  mruNextPos[position] = -1;
+  mruPrev[position] = mruTail;
+  if (mruTail >= 0) {
+    mruNextPos[mruTail] = position;
+  } else {
+    mruHead = position;
+  }
+  mruTail = position;
+}
+
+// Positions above a removed one shift down by one; so do their links.
+void mruClose(int removed) {
+  auto shift = [removed](int16_t &link) {
+    if (link > removed) {
+      link--;
+    }
+  };
+  for (int i = removed; i < static_cast<int>(header.count); i++) {
+    mruPrev[i] = mruPrev[i + 1];
+    mruNextPos[i] = mruNextPos[i + 1];
+  }
+  for (int i = 0; i < static_cast<int>(header.count); i++) {
+    shift(mruPrev[i]);
+    shift(mruNextPos[i]);
+  }
+  shift(mruHead);
+  shift(mruTail);
+}
+
+// One sort at load; afterwards the order is kept by touch/add/remove.
+void mruBuild() {
+  mruHead = mruTail = -1;
+  int n = static_cast<int>(header.count);
+  int16_t *order = new (std::nothrow) int16_t[n > 0 ? n : 1];
+  if (!order) {
+    for (int i = 0; i < n; i++) {
+      mruPushBack(i);
+    }
+    return;
+  }
+  for (int i = 0; i < n; i++) {
+    order[i] = static_cast<int16_t>(i);
+  }
+  std::stable_sort(order, order + n, [](int16_t a, int16_t b) {
+    return entries[a].lastUsed > entries[b].lastUsed;
+  });
+  for (int i = 0; i < n; i++) {
+    mruPushBack(order[i]);
+  }
+  delete[] order;
+}
+
+void setEntryName(Entry &e, const char *name) {
+  strncpy(e.name, name, sizeof(e.name) - 1);
+  e.name[sizeof(e.name) - 1] = '\0';
+}
+
+// Appends without saving the index, so migration can batch it.
+int append(const DisplayComms::MouldParams &mould) {
+  if (header.count >= static_cast<uint32_t>(MAX_PROFILES)) {
+    return -1;
+  }
+  uint32_t id = ++header.nextId;
+  if (!saveOrDefer(id, mould)) {
+    return -1;
+  }
+  Entry &e = entries[header.count];
+  e.id = id;
+  e.lastUsed = 0;
+  setEntryName(e, mould.name);
+  int position = static_cast<int>(header.count++);
+  mruPushBack(position);
+  rev++;
+  return position;
+}
+
+void migrateLegacy() {
+  DisplayComms::MouldParams *legacy = new (std::nothrow)
+      DisplayComms::MouldParams[LEGACY_MAX_PROFILES];
+  if (!legacy) {
+    return;
+  }
+  int legacyCount = 0;
+  Storage::loadMoulds(legacy, legacyCount, LEGACY_MAX_PROFILES);
+  for (int i = 0; i < legacyCount; i++) {
+    append(legacy[i]);
+  }
+  delete[] legacy;
+
+  if (saveIndex()) {
+    Storage::removeLegacyMoulds();
+    Serial.printf("MouldLibrary: migrated %d legacy profiles.\n", legacyCount);
+  }
+}
+
+} // namespace
+
+bool begin() {
+  if (ready) {
+    return true;
+  }
+  size_t bytes = MAX_PROFILES * sizeof(Entry);
+#ifdef BOARD_HAS_PSRAM
+  entries = static_cast<Entry *>(ps_malloc(bytes));
+#endif
+  if (!entries) {
+    entries = static_cast<Entry *>(malloc(bytes));
+  }
+  if (!entries) {
+    Serial.println("MouldLibrary: index allocation FAILED");
+    return false;
+  }
+  ready = true;
+
+  if (!Storage::loadMouldIndex(header, entries, MAX_PROFILES)) {
+    header = {};
+    if (Storage::hasLegacyMoulds()) {
+      migrateLegacy();
+    }
+  }
+  mruBuild();
+  rev++;
+  Serial.printf("MouldLibrary: %lu profiles, index %u bytes in RAM.\n",
+                static_cast<unsigned long>(header.count),
+                static_cast<unsigned>(header.count * sizeof(Entry)));
+  return true;
+}
+
+int count() { return ready ? static_cast<int>(header.count) : 0; }
+
+const Entry *entry(int position) {
+  return validPosition(position) ? &entries[position] : nullptr;
+}
+
+const DisplayComms::MouldParams *get(int position) {
+  if (!validPosition(position)) {
+    return nullptr;
+  }
+  uint32_t id = entries[position].id;
+  CacheSlot *slot = findCached(id);
+  if (slot) {
+    return &slot->mould;
+  }
+  slot = claimSlot(id);
+  if (!slot) {
+    // Every slot is dirty, waiting for flush(); read past the cache.
+    static DisplayComms::MouldParams scratch;
+    return StorageWorker::loadRecord(id, scratch) ? &scratch : nullptr;
+  }
+  if (!StorageWorker::loadRecord(id, slot->mould)) {
+    slot->valid = false;
+    return nullptr;
+  }
+  return &slot->mould;
+}
+
+bool put(int position, const DisplayComms::MouldParams &mould) {
+  if (!validPosition(position)) {
+    return false;
+  }
+  Entry &e = entries[position];
+  const DisplayComms::MouldParams *current = get(position);
+  if (current && DisplayComms::sameMould(*current, mould)) {
+    return true;
+  }
+  if (!saveOrDefer(e.id, mould)) {
+    return false;
+  }
+
+  if (strncmp(e.name, mould.name, sizeof(e.name) - 1) != 0) {
+    setEntryName(e, mould.name);
+    rev++;
+    return saveIndex();
+  }
+  return true;
+}
+
+int add(const DisplayComms::MouldParams &mould) {
+  if (!ready) {
+    return -1;
+  }
+  int position = append(mould);
+  if (position >= 0) {
+    saveIndex();
+  }
+  return position;
+}
+
+bool remove(int position) {
+  if (!validPosition(position) ||
+      (deferredRemovalCount == MAX_DEFERRED_REMOVALS &&
+       StorageWorker::freeSlots() == 0)) {
+    return false;
+  }
+  uint32_t id = entries[position].id;
+  mruUnlink(position);
+  memmove(&entries[position], &entries[position + 1],
+          (header.count - position - 1) * sizeof(Entry));
+  header.count--;
+  mruClose(position);
+  rev++;
+  dropCached(id);
+  bool ok = saveIndex();
+  if (!StorageWorker::removeRecord(id)) { // appends a tombstone
+    deferredRemovals[deferredRemovalCount++] = id;
+  }
+  return ok;
+}
+
+int find(const char *name) {
+  for (int position = 0; position < count(); position++) {
+    if (strncmp(entries[position].name, name, sizeof(Entry::name) - 1) == 0) {
+      return position;
+    }
+  }
+  return -1;
+}
+
+int merge(const DisplayComms::MouldParams *moulds, int size) {
+  if (!ready) {
+    return 0;
+  }
+  int stored = 0;
+  bool appended = false;
+  for (int i = 0; i < size; i++) {
+    int position = find(moulds[i].name);
+    if (position >= 0) {
+      stored += put(position, moulds[i]) ? 1 : 0;
+    } else if (append(moulds[i]) >= 0) {
+      stored++;
+      appended = true;
+    }
+  }
+  if (appended) {
+    saveIndex();
+  }
+  return stored;
+}
+
+void touch(int position) {
+  if (!validPosition(position)) {
+    return;
+  }
+  entries[position].lastUsed = ++header.useClock;
+  if (mruHead != position) {
+    mruUnlink(position);
+    mruPushFront(position);
+    rev++;
+  }
+  saveIndex();
+}
+
+void flush() {
+  for (CacheSlot &slot : cache) {
+    if (slot.dirty && StorageWorker::saveRecord(slot.id, slot.mould)) {
+      slot.dirty = false;
+    }
+  }
+  while (deferredRemovalCount > 0 &&
+         StorageWorker::removeRecord(
+             deferredRemovals[deferredRemovalCount - 1])) {
+    deferredRemovalCount--;
+  }
+}
+
+bool writesDeferred() {
+  for (const CacheSlot &slot : cache) {
+    if (slot.dirty) {
+      return true;
+    }
+  }
+  return deferredRemovalCount > 0;
+}
+
+int mruFirst() { return ready ? mruHead : -1; }
+
+int mruNext(int position) {
+  return validPosition(position) ? mruNextPos[position] : -1;
+}
+
+uint32_t revision() { return rev; }
+
+int page(int first, const Entry **out, int maxCount) {
+  int n = 0;
+  for (int position = first; n < maxCount && validPosition(position);
+       position++) {
+    out[n++] = &entries[position];
+  }
+  return n;
+}
+
+} // namespace MouldLibrary
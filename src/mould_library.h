@@ -0,0 +1,74 @@
+#ifndef MOULD_LIBRARY_H
+#define MOULD_LIBRARY_H
+
+#include "display_comms.h"
+#include "storage.h"
+
+#include <cstdint>
+
+// Mould profiles kept in flash. RAM holds only the index (id, name and use
+// stamp per profile, in list order); full parameter records are read on
+// demand through a small LRU cache. Position 0 is the machine's current
+// mould, as in the list UI.
+//
+// Writes go through StorageWorker: once it is running, a true return means
+// the write is queued, and failures arrive later in its report. While the
+// worker's table is full, records wait dirty in the cache (which never
+// evicts them) and removals in a short list, until flush() hands them on.
+namespace MouldLibrary {
+
+constexpr int MAX_PROFILES = 1024;
+constexpr int CACHE_SIZE = 4;
+
+typedef Storage::MouldIndexEntry Entry;
+
+// Loads the index, migrating the old single-file library on first boot.
+bool begin();
+
+int count();
+const Entry *entry(int position);
+
+// Full record for `position`. The pointer is into the cache (or a scratch
+// record while every slot is dirty) and stays valid until the next get(),
+// put() or add().
+const DisplayComms::MouldParams *get(int position);
+
+// Writes the record only if it changed, and the index only if the name did.
+bool put(int position, const DisplayComms::MouldParams &mould);
+
+// Appends a profile; returns its position, or -1 if full or unwritable.
+int add(const DisplayComms::MouldParams &mould);
+bool remove(int position);
+
+// Position of the first profile called `name`, or -1.
+int find(const char *name);
+
+// Bulk import: a profile whose name is already in the library replaces it,
+// the rest are appended, and the index is saved once for the whole batch.
+// Returns how many were stored; the rest didn't fit or couldn't be queued.
+int merge(const DisplayComms::MouldParams *moulds, int size);
+
+// Queues deferred writes the worker now has room for. Call every tick.
+void flush();
+// Some write is still waiting for flush().
+bool writesDeferred();
+
+// Marks a profile as just used (sent or saved) and moves it to the front of
+// the MRU order in O(1).
+void touch(int position);
+
+// Most recently used first; never-used profiles follow in insertion order.
+// Both return -1 past the end.
+int mruFirst();
+int mruNext(int position);
+
+// Bumped whenever positions, names or MRU order change, so derived views
+// (search results) know to rebuild.
+uint32_t revision();
+
+// Up to `maxCount` consecutive index entries from `first`, for list paging.
+int page(int first, const Entry **out, int maxCount);
+
+} // namespace MouldLibrary
+
+#endif // MOULD_LIBRARY_H
@@ -0,0 +1,167 @@
+#include "mould_search.h"
+
+#include "mould_library.h"
+
+#include <cstring>
+
+namespace MouldSearch {
+
+namespace {
+
+char currentQuery[MAX_QUERY + 1] = "";
+// Query and library revision the results were built for.
+char builtQuery[MAX_QUERY + 1] = "";
+uint32_t builtRevision = 0;
+bool built = false;
+
+int16_t results[MouldLibrary::MAX_PROFILES];
+int resultTotal = 0;
+int prefixTotal = 0; // results[0..prefixTotal) are prefix matches
+
+int16_t rank[MouldLibrary::MAX_PROFILES]; // display order per position
+int16_t scratch[MouldLibrary::MAX_PROFILES];
+
+char fold(char c) { return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c; }
+
+bool startsWith(const char *name, const char *query) {
+  for (; *query; name++, query++) {
+    if (fold(*name) != *query) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool contains(const char *name, const char *query) {
+  if (!*query) {
+    return true;
+  }
+  for (; *name; name++) {
+    if (startsWith(name, query)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 0 = no match, 1 = substring, 2 = prefix.
+int matchKind(int position, const char *query) {
+  const MouldLibrary::Entry *entry = MouldLibrary::entry(position);
+  if (!entry) {
+    return 0;
+  }
+  if (startsWith(entry->name, query)) {
+    return 2;
+  }
+  return contains(entry->name, query) ? 1 : 0;
+}
+
+// Walks the library in display order, ranking every position on the way.
+void fullScan(const char *query) {
+  int order = 0;
+  int substringTotal = 0;
+  prefixTotal = 0;
+
+  auto visit = [&](int position) {
+    rank[position] = static_cast<int16_t>(order++);
+    int kind = matchKind(position, query);
+    if (kind == 2) {
+      results[prefixTotal++] = static_cast<int16_t>(position);
+    } else if (kind == 1) {
+      scratch[substringTotal++] = static_cast<int16_t>(position);
+    }
+  };
+
+  if (MouldLibrary::count() > 0) {
+    visit(0);
+  }
+  for (int position = MouldLibrary::mruFirst(); position >= 0;
+       position = MouldLibrary::mruNext(position)) {
+    if (position != 0) {
+      visit(position);
+    }
+  }
+  memcpy(&results[prefixTotal], scratch, substringTotal * sizeof(int16_t));
+  resultTotal = prefixTotal + substringTotal;
+}
+
+// The query grew, so every new match is among the old results. Prefix
+// matches stay prefix matches or drop to substring; the two substring
+// sources are each in display order and are merged by rank.
+void narrow(const char *query) {
+  int newPrefix = 0;
+  int demoted = 0; // old prefix matches that are now substring matches
+  for (int i = 0; i < prefixTotal; i++) {
+    int kind = matchKind(results[i], query);
+    if (kind == 2) {
+      results[newPrefix++] = results[i];
+    } else if (kind == 1) {
+      scratch[demoted++] = results[i];
+    }
+  }
+
+  int kept = 0; // surviving old substring matches, compacted after demoted
+  for (int i = prefixTotal; i < resultTotal; i++) {
+    if (matchKind(results[i], query) == 1) {
+      scratch[demoted + kept++] = results[i];
+    }
+  }
+
+  int out = newPrefix;
+  int a = 0;
+  int b = demoted;
+  int aEnd = demoted;
+  int bEnd = demoted + kept;
+  while (a < aEnd || b < bEnd) {
+    if (b >= bEnd || (a < aEnd && rank[scratch[a]] < rank[scratch[b]])) {
+      results[out++] = scratch[a++];
+    } else {
+      results[out++] = scratch[b++];
+    }
+  }
+  prefixTotal = newPrefix;
+  resultTotal = out;
+}
+
+} // namespace
+
+void setQuery(const char *query) {
+  int n = 0;
+  if (query) {
+    for (; query[n] && n < MAX_QUERY; n++) {
+      currentQuery[n] = fold(query[n]);
+    }
+  }
+  currentQuery[n] = '\0';
+}
+
+const char *query() { return currentQuery; }
+
+void refresh() {
+  uint32_t revision = MouldLibrary::revision();
+  if (built && revision == builtRevision &&
+      strcmp(currentQuery, builtQuery) == 0) {
+    return;
+  }
+  size_t builtLen = strlen(builtQuery);
+  if (built && revision == builtRevision &&
+      strncmp(currentQuery, builtQuery, builtLen) == 0) {
+    narrow(currentQuery);
+  } else {
+    fullScan(currentQuery);
+  }
+  strcpy(builtQuery, currentQuery);
+  builtRevision = revision;
+  built = true;
+}
+
+int resultCount() { return resultTotal; }
+
+int result(int index) {
+  if (index < 0 || index >= resultTotal) {
+    return -1;
+  }
+  return results[index];
+}
+
+} // namespace MouldSearch
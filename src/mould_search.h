@@ -0,0 +1,30 @@
+#ifndef MOULD_SEARCH_H
+#define MOULD_SEARCH_H
+
+#include <cstdint>
+
+// Filtered, ordered view of the mould library for the list UI. Names that
+// start with the query come first, then names that merely contain it
+// (ASCII, case-insensitive); each group keeps display order: the current
+// mould (position 0) pinned first, then most recently used.
+//
+// Typing narrows the previous results instead of rescanning the library,
+// and the view is rebuilt only when MouldLibrary::revision() moves.
+namespace MouldSearch {
+
+constexpr int MAX_QUERY = 31;
+
+void setQuery(const char *query);
+const char *query();
+
+// Brings the results up to date; call before reading them.
+void refresh();
+
+int resultCount();
+
+// Library position of the result at `index`, or -1.
+int result(int index);
+
+} // namespace MouldSearch
+
+#endif // MOULD_SEARCH_H
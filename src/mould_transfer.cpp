@@ -0,0 +1,697 @@
+#include "mould_transfer.h"
+
+#include "display_comms.h"
+#include "mould_library.h"
+#include "storage_worker.h"
+
+#include <Arduino.h>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace MouldTransfer {
+
+namespace {
+
+constexpr size_t IN_CHUNK = 1024;
+constexpr size_t OUT_CHUNK = 2048;
+constexpr size_t MAX_RECORD = 512; // one CSV row or JSON object
+constexpr int MAX_COLUMNS = 24;
+// One batch fills the worker's table and no more; import waits for the table
+// to drain before handing over the next one, so nothing is deferred.
+constexpr int BATCH = StorageWorker::MAX_PENDING_RECORDS;
+constexpr float MAX_VALUE = 9999; // as the mould edit form
+
+typedef DisplayComms::MouldParams Mould;
+
+enum Column : int8_t { SKIP = -1, NAME = 0, MODE = 1, FIRST_NUMBER = 2 };
+
+struct NumberField {
+  const char *key;
+  size_t offset;
+};
+
+const NumberField NUMBER_FIELDS[] = {
+    {"fillVolume", offsetof(Mould, fillVolume)},
+    {"fillSpeed", offsetof(Mould, fillSpeed)},
+    {"fillPressure", offsetof(Mould, fillPressure)},
+    {"packVolume", offsetof(Mould, packVolume)},
+    {"packSpeed", offsetof(Mould, packSpeed)},
+    {"packPressure", offsetof(Mould, packPressure)},
+    {"packTime", offsetof(Mould, packTime)},
+    {"coolingTime", offsetof(Mould, coolingTime)},
+    {"fillAccel", offsetof(Mould, fillAccel)},
+    {"fillDecel", offsetof(Mould, fillDecel)},
+    {"packAccel", offsetof(Mould, packAccel)},
+    {"packDecel", offsetof(Mould, packDecel)},
+    {"injectTorque", offsetof(Mould, injectTorque)},
+};
+
+constexpr int NUMBER_COUNT = sizeof(NUMBER_FIELDS) / sizeof(NUMBER_FIELDS[0]);
+
+// Allocated for the length of a transfer only.
+struct Buffers {
+  uint8_t in[IN_CHUNK];
+  char out[OUT_CHUNK];
+  char record[MAX_RECORD + 1];
+  Mould batch[BATCH];
+};
+
+struct Job {
+  bool active;
+  bool importing;
+  Format format;
+  bool ok;
+  uint32_t startMs;
+  uint32_t bytes;
+  uint32_t records;
+  uint32_t rejected;
+
+  int position; // export: next library position
+  size_t outLen;
+
+  size_t inLen;
+  size_t inPos;
+  bool eof;
+  size_t recordLen;
+  bool overflow;   // record longer than MAX_RECORD; rejected when it ends
+  bool inString;   // CSV: inside quotes; JSON: inside a string
+  bool escape;     // JSON: after a backslash
+  bool inObject;   // JSON: collecting an object
+  bool haveHeader; // CSV
+  int columnCount;
+  int8_t columns[MAX_COLUMNS];
+  int batchCount;
+};
+
+Job job = {};
+File file;
+Buffers *buf = nullptr;
+
+Report report = {};
+bool reportReady = false;
+
+float &number(Mould &mould, int index) {
+  return *reinterpret_cast<float *>(reinterpret_cast<uint8_t *>(&mould) +
+                                    NUMBER_FIELDS[index].offset);
+}
+
+float number(const Mould &mould, int index) {
+  return number(const_cast<Mould &>(mould), index);
+}
+
+int columnFor(const char *key) {
+  if (strcasecmp(key, "name") == 0) {
+    return NAME;
+  }
+  if (strcasecmp(key, "mode") == 0) {
+    return MODE;
+  }
+  for (int i = 0; i < NUMBER_COUNT; i++) {
+    if (strcasecmp(key, NUMBER_FIELDS[i].key) == 0) {
+      return FIRST_NUMBER + i;
+    }
+  }
+  return SKIP;
+}
+
+bool setField(Mould &mould, int column, const char *text) {
+  if (column == NAME) {
+    size_t length = strlen(text);
+    if (length == 0 || length >= sizeof(mould.name)) {
+      return false;
+    }
+    memcpy(mould.name, text, length + 1);
+    return true;
+  }
+  if (column == MODE) {
+    if (strcmp(text, "2D") != 0 && strcmp(text, "3D") != 0) {
+      return false;
+    }
+    memcpy(mould.mode, text, sizeof(mould.mode));
+    return true;
+  }
+  char *end = nullptr;
+  float value = strtof(text, &end);
+  while (end && (*end == ' ' || *end == '\t')) {
+    end++;
+  }
+  if (end == text || !end || *end != '\0' || !std::isfinite(value) ||
+      value < 0 || value > MAX_VALUE) {
+    return false;
+  }
+  number(mould, column - FIRST_NUMBER) = value;
+  return true;
+}
+
+bool allocate() {
+#ifdef BOARD_HAS_PSRAM
+  buf = static_cast<Buffers *>(ps_malloc(sizeof(Buffers)));
+#endif
+  if (!buf) {
+    buf = static_cast<Buffers *>(malloc(sizeof(Buffers)));
+  }
+  return buf != nullptr;
+}
+
+// --- Export ---
+
+void flushOut() {
+  if (job.outLen == 0) {
+    return;
+  }
+  if (file.write(reinterpret_cast<const uint8_t *>(buf->out), job.outLen) !=
+      job.outLen) {
+    job.ok = false;
+  }
+  job.bytes += job.outLen;
+  job.outLen = 0;
+}
+
+void emit(const char *text, size_t length) {
+  if (job.outLen + length > OUT_CHUNK) {
+    flushOut();
+  }
+  memcpy(buf->out + job.outLen, text, length);
+  job.outLen += length;
+}
+
+void emit(const char *text) { emit(text, strlen(text)); }
+
+// Quoted when it holds a separator, quote or line break.
+size_t csvName(char *out, const char *name) {
+  if (!strpbrk(name, ",\"\r\n")) {
+    return snprintf(out, MAX_RECORD, "%s", name);
+  }
+  size_t n = 0;
+  out[n++] = '"';
+  for (const char *p = name; *p; p++) {
+    if (*p == '"') {
+      out[n++] = '"';
+    }
+    out[n++] = *p;
+  }
+  out[n++] = '"';
+  out[n] = '\0';
+  return n;
+}
+
+size_t jsonName(char *out, const char *name) {
+  size_t n = 0;
+  out[n++] = '"';
+  for (const char *p = name; *p; p++) {
+    if (*p == '"' || *p == '\\') {
+      out[n++] = '\\';
+      out[n++] = *p;
+    } else if (static_cast<uint8_t>(*p) < 0x20) {
+      out[n++] = ' ';
+    } else {
+      out[n++] = *p;
+    }
+  }
+  out[n++] = '"';
+  out[n] = '\0';
+  return n;
+}
+
+void writeHeader() {
+  if (job.format == JSON) {
+    emit("{\"moulds\": [");
+    return;
+  }
+  emit("name,mode");
+  for (const NumberField &field : NUMBER_FIELDS) {
+    emit(",");
+    emit(field.key);
+  }
+  emit("\n");
+}
+
+void writeRecord(const Mould &mould) {
+  // Names are at most 31 bytes, so even fully escaped a record fits.
+  char line[MAX_RECORD];
+  size_t n;
+  if (job.format == CSV) {
+    n = csvName(line, mould.name);
+    n += snprintf(line + n, sizeof(line) - n, ",%.2s", mould.mode);
+    for (int i = 0; i < NUMBER_COUNT; i++) {
+      n += snprintf(line + n, sizeof(line) - n, ",%.7g", number(mould, i));
+    }
+    n += snprintf(line + n, sizeof(line) - n, "\n");
+  } else {
+    n = snprintf(line, sizeof(line), "%s\n  {\"name\": ",
+                 job.records ? "," : "");
+    n += jsonName(line + n, mould.name);
+    n += snprintf(line + n, sizeof(line) - n, ", \"mode\": \"%.2s\"",
+                  mould.mode);
+    for (int i = 0; i < NUMBER_COUNT; i++) {
+      n += snprintf(line + n, sizeof(line) - n, ", \"%s\": %.7g",
+                    NUMBER_FIELDS[i].key, number(mould, i));
+    }
+    n += snprintf(line + n, sizeof(line) - n, "}");
+  }
+  emit(line, n);
+}
+
+// True when the whole library has been written.
+bool exportSome(uint32_t deadline) {
+  while (static_cast<int32_t>(millis() - deadline) < 0) {
+    if (job.position >= MouldLibrary::count()) {
+      if (job.format == JSON) {
+        emit("\n]}\n");
+      }
+      flushOut();
+      return true;
+    }
+    const Mould *mould = MouldLibrary::get(job.position++);
+    if (!mould) {
+      job.rejected++;
+      continue;
+    }
+    writeRecord(*mould);
+    job.records++;
+    if (!job.ok) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// --- Import ---
+
+void flushBatch() {
+  if (job.batchCount == 0) {
+    return;
+  }
+  int stored = MouldLibrary::merge(buf->batch, job.batchCount);
+  job.records += stored;
+  job.rejected += job.batchCount - stored;
+  job.batchCount = 0;
+}
+
+void accept(const Mould &mould) { buf->batch[job.batchCount++] = mould; }
+
+// Merges the pending batch once the worker's table has room for all of it.
+// False while it is still waiting.
+bool flushBatchWhenReady() {
+  if (job.batchCount > StorageWorker::freeSlots()) {
+    return false;
+  }
+  flushBatch();
+  return true;
+}
+
+// Splits a CSV row in place. Quoted fields lose their quotes and doubled
+// quotes inside them. Returns the field count, or -1 if malformed.
+int splitCsv(char *line, char **fields, int maxFields) {
+  int n = 0;
+  char *p = line;
+  for (;;) {
+    if (n == maxFields) {
+      return -1;
+    }
+    char *out = p;
+    fields[n++] = out;
+    if (*p == '"') {
+      p++;
+      for (;;) {
+        if (*p == '\0') {
+          return -1;
+        }
+        if (*p == '"') {
+          if (p[1] != '"') {
+            p++;
+            break;
+          }
+          p++;
+        }
+        *out++ = *p++;
+      }
+    } else {
+      while (*p && *p != ',') {
+        *out++ = *p++;
+      }
+    }
+    char next = *p;
+    *out = '\0';
+    if (next == '\0') {
+      return n;
+    }
+    if (next != ',') {
+      return -1;
+    }
+    p++;
+  }
+}
+
+bool readHeader(char **fields, int count) {
+  bool name = false;
+  bool mode = false;
+  job.columnCount = count;
+  for (int i = 0; i < count; i++) {
+    job.columns[i] = static_cast<int8_t>(columnFor(fields[i]));
+    name = name || job.columns[i] == NAME;
+    mode = mode || job.columns[i] == MODE;
+  }
+  return name && mode;
+}
+
+void parseCsvRow(char *line) {
+  size_t length = strlen(line);
+  if (length && line[length - 1] == '\r') {
+    line[--length] = '\0';
+  }
+  if (length == 0) {
+    return;
+  }
+  char *fields[MAX_COLUMNS];
+  int count = splitCsv(line, fields, MAX_COLUMNS);
+  if (!job.haveHeader) {
+    job.haveHeader = true;
+    if (count < 0 || !readHeader(fields, count)) {
+      Serial.println("MouldTransfer: CSV header needs name and mode columns");
+      job.ok = false;
+    }
+    return;
+  }
+  Mould mould = {};
+  bool valid = count >= 0;
+  for (int i = 0; valid && i < count && i < job.columnCount; i++) {
+    if (job.columns[i] != SKIP) {
+      valid = setField(mould, job.columns[i], fields[i]);
+    }
+  }
+  if (valid && mould.name[0] && mould.mode[0]) {
+    accept(mould);
+  } else {
+    job.rejected++;
+  }
+}
+
+const char *skipSpace(const char *p) {
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+    p++;
+  }
+  return p;
+}
+
+// Unescapes the string at `p` into `out`, truncating to `size`. Returns its
+// full length, or -1 if malformed; `p` ends up past the closing quote.
+int readString(const char *&p, char *out, size_t size) {
+  if (*p != '"') {
+    return -1;
+  }
+  p++;
+  size_t n = 0;
+  for (;;) {
+    char c = *p++;
+    if (c == '\0') {
+      return -1;
+    }
+    if (c == '"') {
+      break;
+    }
+    if (c == '\\') {
+      c = *p++;
+      switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        break;
+      case 'u':
+        // Non-ASCII has no glyph in the UI font anyway.
+        for (int i = 0; i < 4; i++) {
+          if (!isxdigit(static_cast<unsigned char>(*p++))) {
+            return -1;
+          }
+        }
+        c = '?';
+        break;
+      case '\0':
+        return -1;
+      default:
+        c = ' ';
+        break;
+      }
+    }
+    if (n + 1 < size) {
+      out[n] = c;
+    }
+    n++;
+  }
+  out[n + 1 < size ? n : size - 1] = '\0';
+  return static_cast<int>(n);
+}
+
+// One flat object: string keys, string or number values.
+bool parseJsonObject(const char *text, Mould &mould) {
+  mould = {};
+  const char *p = skipSpace(text + 1);
+  if (*p == '}') {
+    return false;
+  }
+  for (;;) {
+    char key[24];
+    char value[40];
+    if (readString(p, key, sizeof(key)) < 0) {
+      return false;
+    }
+    p = skipSpace(p);
+    if (*p++ != ':') {
+      return false;
+    }
+    p = skipSpace(p);
+    int length;
+    if (*p == '"') {
+      length = readString(p, value, sizeof(value));
+    } else {
+      const char *start = p;
+      while (*p && *p != ',' && *p != '}' && *p != ' ' && *p != '\n' &&
+             *p != '\r' && *p != '\t') {
+        p++;
+      }
+      length = static_cast<int>(p - start);
+      if (length == 0) {
+        return false;
+      }
+      size_t copied = length < static_cast<int>(sizeof(value))
+                          ? length
+                          : sizeof(value) - 1;
+      memcpy(value, start, copied);
+      value[copied] = '\0';
+    }
+    int column = columnFor(key);
+    if (length < 0) {
+      return false;
+    }
+    if (column != SKIP &&
+        (length >= static_cast<int>(sizeof(value)) ||
+         !setField(mould, column, value))) {
+      return false;
+    }
+    p = skipSpace(p);
+    if (*p == ',') {
+      p = skipSpace(p + 1);
+      continue;
+    }
+    return *p == '}' && mould.name[0] && mould.mode[0];
+  }
+}
+
+void endRecord() {
+  buf->record[job.recordLen] = '\0';
+  if (job.overflow) {
+    job.rejected++;
+  } else if (job.format == CSV) {
+    parseCsvRow(buf->record);
+  } else {
+    Mould mould;
+    if (parseJsonObject(buf->record, mould)) {
+      accept(mould);
+    } else {
+      job.rejected++;
+    }
+  }
+  job.recordLen = 0;
+  job.overflow = false;
+}
+
+void append(char c) {
+  if (job.recordLen < MAX_RECORD) {
+    buf->record[job.recordLen++] = c;
+  } else {
+    job.overflow = true;
+  }
+}
+
+void consumeCsv(char c) {
+  if (c == '"') {
+    job.inString = !job.inString;
+  } else if (c == '\n' && !job.inString) {
+    endRecord();
+    return;
+  }
+  append(c);
+}
+
+// Collects the innermost {...}: a '{' restarts the record, so the wrapper
+// object and array are skipped without being buffered.
+void consumeJson(char c) {
+  if (job.inString) {
+    if (job.inObject) {
+      append(c);
+    }
+    if (job.escape) {
+      job.escape = false;
+    } else if (c == '\\') {
+      job.escape = true;
+    } else if (c == '"') {
+      job.inString = false;
+    }
+    return;
+  }
+  if (c == '"') {
+    job.inString = true;
+  } else if (c == '{') {
+    job.inObject = true;
+    job.recordLen = 0;
+    job.overflow = false;
+  } else if (c == '}' && job.inObject) {
+    append(c);
+    job.inObject = false;
+    endRecord();
+    return;
+  }
+  if (job.inObject) {
+    append(c);
+  }
+}
+
+// True at the end of the file.
+bool importSome(uint32_t deadline) {
+  while (job.ok && static_cast<int32_t>(millis() - deadline) < 0) {
+    if (job.batchCount == BATCH && !flushBatchWhenReady()) {
+      return false; // storage is catching up; go on next step
+    }
+    if (job.inPos == job.inLen) {
+      if (job.eof) {
+        if (job.format == CSV && job.recordLen) {
+          endRecord(); // last row without a line break
+        }
+        return flushBatchWhenReady();
+      }
+      int got = file.read(buf->in, IN_CHUNK);
+      job.inLen = got > 0 ? got : 0;
+      job.inPos = 0;
+      job.bytes += job.inLen;
+      job.eof = job.inLen < IN_CHUNK;
+      continue;
+    }
+    while (job.inPos < job.inLen && job.ok && job.batchCount < BATCH) {
+      char c = static_cast<char>(buf->in[job.inPos++]);
+      if (job.format == CSV) {
+        consumeCsv(c);
+      } else {
+        consumeJson(c);
+      }
+    }
+  }
+  return !job.ok;
+}
+
+void finish() {
+  file.close();
+  free(buf);
+  buf = nullptr;
+  job.active = false;
+
+  uint32_t ms = millis() - job.startMs;
+  report = {job.ok,       job.importing, job.format, job.records,
+            job.rejected, job.bytes,     ms};
+  reportReady = true;
+  Serial.printf("MouldTransfer: %s %s %lu profiles (%lu rejected), %lu bytes "
+                "in %lu ms, %lu KB/s\n",
+                job.ok ? "done," : "FAILED,",
+                job.importing ? "imported" : "exported",
+                static_cast<unsigned long>(job.records),
+                static_cast<unsigned long>(job.rejected),
+                static_cast<unsigned long>(job.bytes),
+                static_cast<unsigned long>(ms),
+                static_cast<unsigned long>(ms ? job.bytes / ms : 0));
+}
+
+bool start(fs::FS &fs, const char *path, Format format, bool importing) {
+  if (job.active) {
+    Serial.println("MouldTransfer: a transfer is already running");
+    return false;
+  }
+  file = fs.open(path, importing ? FILE_READ : FILE_WRITE);
+  if (!file || file.isDirectory()) {
+    Serial.printf("MouldTransfer: can't open %s\n", path);
+    file.close();
+    return false;
+  }
+  if (!allocate()) {
+    Serial.println("MouldTransfer: buffer allocation FAILED");
+    file.close();
+    return false;
+  }
+  job = {};
+  job.importing = importing;
+  job.format = format;
+  job.ok = true;
+  job.startMs = millis();
+  reportReady = false;
+  Serial.printf("MouldTransfer: %s %s as %s\n",
+                importing ? "importing" : "exporting", path,
+                format == JSON ? "JSON" : "CSV");
+  if (!importing) {
+    writeHeader();
+  }
+  // Only now is the job complete enough for step() to see.
+  job.active = true;
+  return true;
+}
+
+} // namespace
+
+Format formatFor(const char *path) {
+  const char *dot = path ? strrchr(path, '.') : nullptr;
+  return dot && strcasecmp(dot, ".json") == 0 ? JSON : CSV;
+}
+
+bool startExport(fs::FS &fs, const char *path, Format format) {
+  return start(fs, path, format, false);
+}
+
+bool startImport(fs::FS &fs, const char *path, Format format) {
+  return start(fs, path, format, true);
+}
+
+bool busy() { return job.active; }
+
+bool step(uint32_t budgetMs) {
+  if (!job.active) {
+    return false;
+  }
+  uint32_t deadline = millis() + budgetMs;
+  bool done = job.importing ? importSome(deadline) : exportSome(deadline);
+  if (done) {
+    finish();
+  }
+  return !done;
+}
+
+bool takeReport(Report &out) {
+  if (!reportReady) {
+    return false;
+  }
+  out = report;
+  reportReady = false;
+  return true;
+}
+
+} // namespace MouldTransfer
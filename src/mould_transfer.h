@@ -0,0 +1,52 @@
+#ifndef MOULD_TRANSFER_H
+#define MOULD_TRANSFER_H
+
+#include <FS.h>
+#include <cstdint>
+
+// Bulk export and import of the whole mould library as CSV or JSON, for
+// moving profiles between machines or keeping a backup on the SD card.
+//
+// Files are streamed in fixed chunks: export formats one record at a time
+// into an output buffer, import parses one row or object at a time and hands
+// small batches to MouldLibrary::merge(). RAM use doesn't grow with the
+// library. Work is done in step(), a few milliseconds per call, so the UI
+// keeps drawing through a long transfer. Everything here, start included,
+// belongs to the task that owns MouldLibrary.
+//
+// CSV has a header row naming the columns; columns are matched by name, so
+// unknown ones are skipped and missing numbers read as 0. JSON is an array
+// of flat objects, optionally wrapped as {"moulds": [...]}. Rows that fail
+// validation are counted and skipped, not fatal.
+namespace MouldTransfer {
+
+enum Format { CSV, JSON };
+
+struct Report {
+  bool ok;
+  bool import;
+  Format format;
+  uint32_t records;  // exported, or imported into the library
+  uint32_t rejected; // malformed or out-of-range rows, or library full
+  uint32_t bytes;
+  uint32_t ms;
+};
+
+// Format from the file extension; CSV unless it ends in ".json".
+Format formatFor(const char *path);
+
+// False if a transfer is already running or the file can't be opened.
+bool startExport(fs::FS &fs, const char *path, Format format);
+bool startImport(fs::FS &fs, const char *path, Format format);
+
+bool busy();
+
+// Works for about `budgetMs`; true while there is more to do.
+bool step(uint32_t budgetMs);
+
+// The report of the transfer that just finished, once.
+bool takeReport(Report &out);
+
+} // namespace MouldTransfer
+
+#endif // MOULD_TRANSFER_H
@@ -0,0 +1,283 @@
+#include "numeric_keypad.h"
+
+#include "obj_handle.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace NumericKeypad {
+
+namespace {
+
+// Button ids in map order.
+enum Key {
+  KEY_7,
+  KEY_8,
+  KEY_9,
+  KEY_BACKSPACE,
+  KEY_4,
+  KEY_5,
+  KEY_6,
+  KEY_STEP_DOWN,
+  KEY_1,
+  KEY_2,
+  KEY_3,
+  KEY_STEP_UP,
+  KEY_SIGN,
+  KEY_0,
+  KEY_POINT,
+  KEY_ENTER,
+};
+
+const char *const MAP[] = {
+    "7",   "8", "9", LV_SYMBOL_BACKSPACE, "\n",
+    "4",   "5", "6", LV_SYMBOL_MINUS,     "\n",
+    "1",   "2", "3", LV_SYMBOL_PLUS,      "\n",
+    "+/-", "0", ".", LV_SYMBOL_OK,        "",
+};
+
+constexpr int TEXT_SIZE = 32;
+
+struct State {
+  ObjHandle::Handle target;
+  PropertyGrid::Field field;
+};
+
+State *getState(lv_obj_t *keypad) {
+  if (!keypad) {
+    return nullptr;
+  }
+  return static_cast<State *>(lv_obj_get_user_data(keypad));
+}
+
+bool bounded(const PropertyGrid::Field &field) {
+  return field.minValue < field.maxValue;
+}
+
+float clampToField(const PropertyGrid::Field &field, float value) {
+  if (!bounded(field)) {
+    return value;
+  }
+  return value < field.minValue   ? field.minValue
+         : value > field.maxValue ? field.maxValue
+                                  : value;
+}
+
+int decimalsIn(const char *text) {
+  const char *point = strchr(text, '.');
+  return point ? static_cast<int>(strlen(point + 1)) : 0;
+}
+
+// Fewest decimals (up to 3) that represent `step` exactly.
+int decimalsOf(float step) {
+  float scaled = step;
+  for (int decimals = 0; decimals < 3; decimals++) {
+    if (fabsf(scaled - roundf(scaled)) < 0.0005f) {
+      return decimals;
+    }
+    scaled *= 10.0f;
+  }
+  return 3;
+}
+
+void format(const PropertyGrid::Field &field, float value, int decimals,
+            char *out) {
+  if (field.type == PropertyGrid::INTEGER) {
+    snprintf(out, TEXT_SIZE, "%ld", lroundf(value));
+  } else {
+    snprintf(out, TEXT_SIZE, "%.*f", decimals, value);
+  }
+}
+
+// Typing only grows a value's magnitude, so a keystroke that takes it past
+// the bound on its own side of zero can never be completed into a valid
+// value. Values short of the other bound are caught on enter.
+bool acceptable(const PropertyGrid::Field &field, const char *text) {
+  size_t limit = field.maxLength ? field.maxLength : TEXT_SIZE - 1;
+  if (strlen(text) > limit) {
+    return false;
+  }
+  if (!bounded(field)) {
+    return true;
+  }
+  float value = static_cast<float>(atof(text));
+  return !(value > 0 && value > field.maxValue) &&
+         !(value < 0 && value < field.minValue);
+}
+
+void setText(lv_obj_t *textarea, const char *current, const char *next) {
+  if (strcmp(current, next) != 0) {
+    lv_textarea_set_text(textarea, next);
+  }
+}
+
+void onKey(lv_event_t *e) {
+  lv_obj_t *keypad = lv_event_get_target_obj(e);
+  State *state = getState(keypad);
+  lv_obj_t *textarea = state ? ObjHandle::get(state->target) : nullptr;
+  if (!textarea) {
+    return;
+  }
+  const PropertyGrid::Field &field = state->field;
+  uint32_t key = lv_buttonmatrix_get_selected_button(keypad);
+  const char *current = lv_textarea_get_text(textarea);
+  char next[TEXT_SIZE];
+  snprintf(next, sizeof(next), "%s", current);
+  size_t len = strlen(next);
+
+  switch (key) {
+  case KEY_BACKSPACE:
+    if (len > 0) {
+      next[len - 1] = '\0';
+    }
+    break;
+  case KEY_SIGN:
+    if (next[0] == '-') {
+      memmove(next, next + 1, len);
+    } else if (len + 1 < sizeof(next)) {
+      memmove(next + 1, next, len + 1);
+      next[0] = '-';
+    }
+    if (!acceptable(field, next)) {
+      return;
+    }
+    break;
+  case KEY_POINT:
+    if (field.type != PropertyGrid::DECIMAL || strchr(next, '.') ||
+        len + 1 >= sizeof(next)) {
+      return;
+    }
+    next[len] = '.';
+    next[len + 1] = '\0';
+    if (!acceptable(field, next)) {
+      return;
+    }
+    break;
+  case KEY_STEP_DOWN:
+  case KEY_STEP_UP: {
+    float step = field.step > 0 ? field.step : 1.0f;
+    float value = static_cast<float>(atof(current));
+    value += key == KEY_STEP_UP ? step : -step;
+    int decimals = decimalsIn(current);
+    if (decimalsOf(step) > decimals) {
+      decimals = decimalsOf(step);
+    }
+    format(field, clampToField(field, value), decimals, next);
+    break;
+  }
+  case KEY_ENTER: {
+    float value = static_cast<float>(atof(current));
+    float clamped = clampToField(field, value);
+    if (clamped != value || current[0] == '\0') {
+      // Show the nearest valid value; a second enter accepts it.
+      format(field, clamped, decimalsIn(current), next);
+      setText(textarea, current, next);
+      return;
+    }
+    // As lv_keyboard does: the keypad first, then its text area.
+    lv_obj_send_event(keypad, LV_EVENT_READY, nullptr);
+    lv_obj_send_event(textarea, LV_EVENT_READY, nullptr);
+    close(keypad);
+    return;
+  }
+  default: {
+    const char *label = lv_buttonmatrix_get_button_text(keypad, key);
+    if (!label || label[0] < '0' || label[0] > '9' ||
+        len + 1 >= sizeof(next)) {
+      return;
+    }
+    // Replace a lone zero rather than building "07".
+    if (strcmp(next, "0") == 0 || strcmp(next, "-0") == 0) {
+      len--;
+    }
+    next[len] = label[0];
+    next[len + 1] = '\0';
+    if (!acceptable(field, next)) {
+      return;
+    }
+    break;
+  }
+  }
+  setText(textarea, current, next);
+}
+
+void onDelete(lv_event_t *e) {
+  lv_obj_t *keypad = lv_event_get_target_obj(e);
+  State *state = getState(keypad);
+  if (state) {
+    ObjHandle::release(state->target);
+    lv_free(state);
+    lv_obj_set_user_data(keypad, nullptr);
+  }
+}
+
+void setKeyEnabled(lv_obj_t *keypad, uint32_t key, bool enabled) {
+  if (enabled) {
+    lv_buttonmatrix_clear_button_ctrl(keypad, key,
+                                      LV_BUTTONMATRIX_CTRL_DISABLED);
+  } else {
+    lv_buttonmatrix_set_button_ctrl(keypad, key,
+                                    LV_BUTTONMATRIX_CTRL_DISABLED);
+  }
+}
+
+} // namespace
+
+lv_obj_t *create(lv_obj_t *parent) {
+  State *state = static_cast<State *>(lv_malloc_zeroed(sizeof(State)));
+  if (!state) {
+    return nullptr;
+  }
+  lv_obj_t *keypad = lv_buttonmatrix_create(parent);
+  if (!keypad) {
+    lv_free(state);
+    return nullptr;
+  }
+  lv_buttonmatrix_set_map(keypad, MAP);
+  lv_buttonmatrix_set_button_ctrl(keypad, KEY_ENTER,
+                                  LV_BUTTONMATRIX_CTRL_NO_REPEAT);
+  lv_buttonmatrix_set_button_ctrl(keypad, KEY_SIGN,
+                                  LV_BUTTONMATRIX_CTRL_NO_REPEAT);
+  lv_obj_set_size(keypad, WIDTH, HEIGHT);
+  lv_obj_remove_flag(keypad, LV_OBJ_FLAG_CLICK_FOCUSABLE);
+  lv_obj_add_flag(keypad, LV_OBJ_FLAG_HIDDEN);
+
+  lv_obj_set_user_data(keypad, state);
+  lv_obj_add_event_cb(keypad, onKey, LV_EVENT_VALUE_CHANGED, nullptr);
+  lv_obj_add_event_cb(keypad, onDelete, LV_EVENT_DELETE, nullptr);
+  return keypad;
+}
+
+void open(lv_obj_t *keypad, lv_obj_t *textarea,
+          const PropertyGrid::Field &field) {
+  State *state = getState(keypad);
+  if (!state || !textarea) {
+    return;
+  }
+  ObjHandle::release(state->target);
+  state->target = ObjHandle::track(textarea);
+  state->field = field;
+  setKeyEnabled(keypad, KEY_POINT, field.type == PropertyGrid::DECIMAL);
+  setKeyEnabled(keypad, KEY_SIGN, !bounded(field) || field.minValue < 0);
+  lv_obj_remove_flag(keypad, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_move_foreground(keypad);
+}
+
+void close(lv_obj_t *keypad) {
+  State *state = getState(keypad);
+  if (!state) {
+    return;
+  }
+  ObjHandle::release(state->target);
+  state->target = ObjHandle::Handle();
+  lv_obj_add_flag(keypad, LV_OBJ_FLAG_HIDDEN);
+}
+
+lv_obj_t *target(lv_obj_t *keypad) {
+  State *state = getState(keypad);
+  return state ? ObjHandle::get(state->target) : nullptr;
+}
+
+} // namespace NumericKeypad
@@ -0,0 +1,31 @@
+#ifndef NUMERIC_KEYPAD_H
+#define NUMERIC_KEYPAD_H
+
+#include "property_grid.h"
+
+#include <lvgl.h>
+
+// Compact keypad for numeric fields: digits, sign, decimal point, backspace,
+// -/+ step and enter on a fixed button map. It edits the target text area
+// directly and keeps the value inside the field's limits, so only the text
+// area and the pressed key redraw on a keypress. Text fields still use the
+// full lv_keyboard.
+namespace NumericKeypad {
+
+constexpr lv_coord_t WIDTH = 330;
+constexpr lv_coord_t HEIGHT = 240;
+
+lv_obj_t *create(lv_obj_t *parent);
+
+// Edits `textarea` under `field`'s type and limits until enter or close().
+// Enter sends LV_EVENT_READY to the keypad and then the text area, like
+// lv_keyboard, and hides the keypad.
+void open(lv_obj_t *keypad, lv_obj_t *textarea,
+          const PropertyGrid::Field &field);
+void close(lv_obj_t *keypad);
+
+lv_obj_t *target(lv_obj_t *keypad);
+
+} // namespace NumericKeypad
+
+#endif // NUMERIC_KEYPAD_H
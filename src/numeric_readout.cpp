@@ -0,0 +1,206 @@
+#include "numeric_readout.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace NumericReadout {
+
+namespace {
+
+constexpr int CHARSET_LEN = sizeof("0123456789.-+ ") - 1;
+constexpr uint8_t BLANK = 0xff;
+constexpr int SUFFIX_LEN = 8;
+
+// One NUL-terminated string per strip glyph, so a cell draw never has to
+// build text. Shared by every readout.
+char glyphText[CHARSET_LEN][2];
+bool glyphsBuilt = false;
+
+struct State {
+  const lv_font_t *font;
+  lv_coord_t cellWidth;
+  lv_coord_t height;
+  uint8_t cellCount;
+  uint8_t cells[MAX_CELLS]; // strip index per cell, or BLANK
+  char suffix[SUFFIX_LEN];
+};
+
+void buildGlyphs() {
+  if (glyphsBuilt) {
+    return;
+  }
+  for (int i = 0; i < CHARSET_LEN; i++) {
+    glyphText[i][0] = CHARSET[i];
+    glyphText[i][1] = '\0';
+  }
+  glyphsBuilt = true;
+}
+
+uint8_t stripIndex(char c) {
+  if (c == ' ') {
+    return BLANK;
+  }
+  const char *hit = strchr(CHARSET, c);
+  if (!hit || c == '\0') {
+    return BLANK;
+  }
+  return static_cast<uint8_t>(hit - CHARSET);
+}
+
+State *getState(lv_obj_t *readout) {
+  if (!readout) {
+    return nullptr;
+  }
+  return static_cast<State *>(lv_obj_get_user_data(readout));
+}
+
+void cellArea(lv_obj_t *readout, const State *state, int cell,
+              lv_area_t *area) {
+  lv_obj_get_coords(readout, area);
+  area->x1 += cell * state->cellWidth;
+  area->x2 = area->x1 + state->cellWidth - 1;
+  area->y2 = area->y1 + state->height - 1;
+}
+
+void onDraw(lv_event_t *e) {
+  lv_obj_t *readout = lv_event_get_target_obj(e);
+  State *state = getState(readout);
+  lv_layer_t *layer = lv_event_get_layer(e);
+  if (!state || !layer) {
+    return;
+  }
+
+  lv_draw_label_dsc_t dsc;
+  lv_draw_label_dsc_init(&dsc);
+  dsc.font = state->font;
+  dsc.color = lv_obj_get_style_text_color(readout, LV_PART_MAIN);
+  dsc.opa = lv_obj_get_style_text_opa(readout, LV_PART_MAIN);
+  dsc.align = LV_TEXT_ALIGN_CENTER;
+
+  for (int i = 0; i < state->cellCount; i++) {
+    if (state->cells[i] == BLANK) {
+      continue;
+    }
+    lv_area_t area;
+    cellArea(readout, state, i, &area);
+    dsc.text = glyphText[state->cells[i]];
+    lv_draw_label(layer, &dsc, &area);
+  }
+
+  if (state->suffix[0] != '\0') {
+    lv_area_t area;
+    lv_obj_get_coords(readout, &area);
+    area.x1 += state->cellCount * state->cellWidth;
+    dsc.align = LV_TEXT_ALIGN_LEFT;
+    dsc.text = state->suffix;
+    lv_draw_label(layer, &dsc, &area);
+  }
+}
+
+void onDelete(lv_event_t *e) {
+  lv_obj_t *readout = lv_event_get_target_obj(e);
+  State *state = getState(readout);
+  if (state) {
+    lv_free(state);
+    lv_obj_set_user_data(readout, nullptr);
+  }
+}
+
+} // namespace
+
+lv_obj_t *create(lv_obj_t *parent, const lv_font_t *font, int cells,
+                 const char *suffix) {
+  if (!font) {
+    return nullptr;
+  }
+  if (cells < 1)
+    cells = 1;
+  if (cells > MAX_CELLS)
+    cells = MAX_CELLS;
+  buildGlyphs();
+
+  lv_obj_t *readout = lv_obj_create(parent);
+  if (!readout) {
+    return nullptr;
+  }
+  State *state = static_cast<State *>(lv_malloc_zeroed(sizeof(State)));
+  if (!state) {
+    lv_obj_delete(readout);
+    return nullptr;
+  }
+
+  state->font = font;
+  state->cellCount = static_cast<uint8_t>(cells);
+  state->height = lv_font_get_line_height(font);
+  // Cell width is the widest glyph of the strip, so digits never shift.
+  for (int i = 0; i < CHARSET_LEN; i++) {
+    lv_coord_t w = static_cast<lv_coord_t>(
+        lv_font_get_glyph_width(font, static_cast<uint32_t>(CHARSET[i]), 0));
+    if (w > state->cellWidth) {
+      state->cellWidth = w;
+    }
+  }
+  memset(state->cells, BLANK, sizeof(state->cells));
+  if (suffix) {
+    strncpy(state->suffix, suffix, sizeof(state->suffix) - 1);
+  }
+
+  lv_coord_t suffixWidth = 0;
+  if (state->suffix[0] != '\0') {
+    suffixWidth = lv_text_get_width(state->suffix, strlen(state->suffix), font,
+                                    0);
+  }
+
+  // Inherit text colour from the parent; no background or padding.
+  lv_obj_remove_style_all(readout);
+  lv_obj_set_size(readout, cells * state->cellWidth + suffixWidth,
+                  state->height);
+  lv_obj_remove_flag(readout, LV_OBJ_FLAG_CLICKABLE |
+                                  LV_OBJ_FLAG_CLICK_FOCUSABLE |
+                                  LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_user_data(readout, state);
+  lv_obj_add_event_cb(readout, onDraw, LV_EVENT_DRAW_MAIN, nullptr);
+  lv_obj_add_event_cb(readout, onDelete, LV_EVENT_DELETE, nullptr);
+  return readout;
+}
+
+void setText(lv_obj_t *readout, const char *text) {
+  State *state = getState(readout);
+  if (!state || !text) {
+    return;
+  }
+
+  // Right-align into the cells; overlong text keeps its rightmost part.
+  int len = static_cast<int>(strlen(text));
+  int pad = state->cellCount - len;
+
+  int runStart = -1;
+  for (int i = 0; i <= state->cellCount; i++) {
+    bool changed = false;
+    if (i < state->cellCount) {
+      uint8_t next = (i < pad) ? BLANK : stripIndex(text[i - pad]);
+      changed = next != state->cells[i];
+      state->cells[i] = next;
+    }
+    // Invalidate each run of adjacent changed cells as one area.
+    if (changed && runStart < 0) {
+      runStart = i;
+    } else if (!changed && runStart >= 0) {
+      lv_area_t first;
+      lv_area_t last;
+      cellArea(readout, state, runStart, &first);
+      cellArea(readout, state, i - 1, &last);
+      first.x2 = last.x2;
+      lv_obj_invalidate_area(readout, &first);
+      runStart = -1;
+    }
+  }
+}
+
+void setValue(lv_obj_t *readout, float value, int decimals) {
+  char text[MAX_CELLS + 8];
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  setText(readout, text);
+}
+
+} // namespace NumericReadout
@@ -0,0 +1,26 @@
+#ifndef NUMERIC_READOUT_H
+#define NUMERIC_READOUT_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Fixed-width numeric readout. Text is right-aligned into a row of equal
+// cells sized from the font's digit strip, and each update invalidates only
+// the cells whose character changed. A static suffix (e.g. " C") is drawn
+// after the cells and never invalidated.
+namespace NumericReadout {
+
+constexpr int MAX_CELLS = 12;
+
+// Characters a cell can show; anything else renders as a blank cell.
+constexpr const char *CHARSET = "0123456789.-+ ";
+
+lv_obj_t *create(lv_obj_t *parent, const lv_font_t *font, int cells,
+                 const char *suffix = nullptr);
+
+void setText(lv_obj_t *readout, const char *text);
+void setValue(lv_obj_t *readout, float value, int decimals);
+
+} // namespace NumericReadout
+
+#endif // NUMERIC_READOUT_H
@@ -0,0 +1,115 @@
+#include "obj_handle.h"
+
+#include <Arduino.h>
+
+namespace ObjHandle {
+
+namespace {
+
+struct Slot {
+  lv_obj_t *obj;
+  uint16_t generation;
+};
+
+Slot slots[MAX_SLOTS];
+uint32_t checks = 0;
+
+// The delete callback carries index and generation, so a callback left on
+// an object after its slot was reused can never clear the new owner.
+void *encode(Handle handle) {
+  return reinterpret_cast<void *>(
+      static_cast<uintptr_t>(handle.index) |
+      (static_cast<uintptr_t>(handle.generation) << 16));
+}
+
+Handle decode(void *userData) {
+  uintptr_t raw = reinterpret_cast<uintptr_t>(userData);
+  Handle handle;
+  handle.index = static_cast<uint16_t>(raw & 0xffff);
+  handle.generation = static_cast<uint16_t>((raw >> 16) & 0xffff);
+  return handle;
+}
+
+Slot *liveSlot(Handle handle) {
+  if (handle.generation == 0 || handle.index >= MAX_SLOTS) {
+    return nullptr;
+  }
+  Slot &slot = slots[handle.index];
+  if (!slot.obj || slot.generation != handle.generation) {
+    return nullptr;
+  }
+  return &slot;
+}
+
+void onDelete(lv_event_t *e) {
+  Slot *slot = liveSlot(decode(lv_event_get_user_data(e)));
+  if (slot) {
+    slot->obj = nullptr;
+  }
+}
+
+} // namespace
+
+Handle track(lv_obj_t *obj) {
+  Handle handle;
+  if (!obj) {
+    return handle;
+  }
+  for (int i = 0; i < MAX_SLOTS; i++) {
+    Slot &slot = slots[i];
+    if (slot.obj) {
+      continue;
+    }
+    slot.generation++;
+    if (slot.generation == 0) {
+      slot.generation = 1;
+    }
+    slot.obj = obj;
+    handle.index = static_cast<uint16_t>(i);
+    handle.generation = slot.generation;
+    lv_obj_add_event_cb(obj, onDelete, LV_EVENT_DELETE, encode(handle));
+    return handle;
+  }
+  Serial.println("OBJ_HANDLE: registry full, handle not tracked");
+  return handle;
+}
+
+void release(Handle handle) {
+  Slot *slot = liveSlot(handle);
+  if (!slot) {
+    return;
+  }
+  // Still live, so the object exists and its callback can be removed.
+  lv_obj_remove_event_cb_with_user_data(slot->obj, onDelete, encode(handle));
+  slot->obj = nullptr;
+}
+
+lv_obj_t *get(Handle handle) {
+  Slot *slot = liveSlot(handle);
+  return slot ? slot->obj : nullptr;
+}
+
+bool isLive(Handle handle) {
+  if (handle.generation != 0) {
+    checks++;
+  }
+  return liveSlot(handle) != nullptr;
+}
+
+int liveCount() {
+  int count = 0;
+  for (const Slot &slot : slots) {
+    if (slot.obj) {
+      count++;
+    }
+  }
+  return count;
+}
+
+uint32_t checkCount() { return checks; }
+
+void *toUserData(Handle handle) { return encode(handle); }
+
+Handle fromUserData(void *userData) { return decode(userData); }
+
+} // namespace ObjHandle
@@ -0,0 +1,67 @@
+#ifndef OBJ_HANDLE_H
+#define OBJ_HANDLE_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Registry of weak widget handles. A handle is a slot index plus the slot's
+// generation; the slot is cleared from the object's LV_EVENT_DELETE callback,
+// so checking a handle is an array lookup instead of lv_obj_is_valid(),
+// which walks every display, screen and child looking for the pointer.
+namespace ObjHandle {
+
+constexpr int MAX_SLOTS = 64;
+
+struct Handle {
+  uint16_t index = 0;
+  uint16_t generation = 0; // 0 never matches a live slot
+};
+
+// Returns an empty handle if obj is null or the registry is full.
+Handle track(lv_obj_t *obj);
+void release(Handle handle);
+
+// The object, or nullptr once it has been deleted or released.
+lv_obj_t *get(Handle handle);
+
+// Validity check standing in for lv_obj_is_valid(); counted in checkCount()
+// unless the handle is empty.
+bool isLive(Handle handle);
+
+int liveCount();
+
+// Number of isLive() calls on non-empty handles, i.e. tree walks
+// lv_obj_is_valid() would otherwise have done. An empty handle stands for a
+// null pointer, which never needed a walk. Monotonic, wraps at 2^32.
+uint32_t checkCount();
+
+// A handle packed into callback user data, e.g. for lv_async_call().
+void *toUserData(Handle handle);
+Handle fromUserData(void *userData);
+
+} // namespace ObjHandle
+
+// Owning wrapper for a UiState field. Reads like an lv_obj_t * and becomes
+// nullptr by itself when LVGL deletes the object.
+class ObjRef {
+public:
+  ObjRef() = default;
+  ObjRef(const ObjRef &) = delete;
+  ~ObjRef() { ObjHandle::release(handle); }
+
+  ObjRef &operator=(lv_obj_t *obj) {
+    ObjHandle::release(handle);
+    handle = ObjHandle::track(obj);
+    return *this;
+  }
+  ObjRef &operator=(const ObjRef &other) { return *this = other.get(); }
+
+  lv_obj_t *get() const { return ObjHandle::get(handle); }
+  bool isReady() const { return ObjHandle::isLive(handle); }
+  operator lv_obj_t *() const { return get(); }
+
+private:
+  ObjHandle::Handle handle;
+};
+
+#endif // OBJ_HANDLE_H
@@ -0,0 +1,110 @@
+#include "panel_pool.h"
+
+namespace PanelPool {
+
+namespace {
+
+struct Entry {
+  bool warm;
+  uint32_t costBytes;
+  uint32_t lastCostBytes;
+  uint32_t lastUsedMs;
+};
+
+Entry entries[MAX_PANELS];
+
+Entry *entryFor(int panel) {
+  if (panel < 0 || panel >= MAX_PANELS) {
+    return nullptr;
+  }
+  return &entries[panel];
+}
+
+} // namespace
+
+void markBuilt(int panel, uint32_t costBytes, uint32_t nowMs) {
+  Entry *entry = entryFor(panel);
+  if (!entry) {
+    return;
+  }
+  entry->warm = true;
+  entry->costBytes = costBytes;
+  entry->lastCostBytes = costBytes;
+  entry->lastUsedMs = nowMs;
+}
+
+void markUsed(int panel, uint32_t nowMs) {
+  Entry *entry = entryFor(panel);
+  if (entry && entry->warm) {
+    entry->lastUsedMs = nowMs;
+  }
+}
+
+void markEvicted(int panel) {
+  Entry *entry = entryFor(panel);
+  if (!entry) {
+    return;
+  }
+  entry->warm = false;
+  entry->costBytes = 0;
+}
+
+void addCost(int panel, int32_t deltaBytes) {
+  Entry *entry = entryFor(panel);
+  if (!entry || !entry->warm) {
+    return;
+  }
+  if (deltaBytes < 0 && static_cast<uint32_t>(-deltaBytes) > entry->costBytes) {
+    entry->costBytes = 0;
+  } else {
+    entry->costBytes += deltaBytes;
+  }
+  entry->lastCostBytes = entry->costBytes;
+}
+
+bool isWarm(int panel) {
+  Entry *entry = entryFor(panel);
+  return entry && entry->warm;
+}
+
+uint32_t lastCost(int panel) {
+  Entry *entry = entryFor(panel);
+  return entry ? entry->lastCostBytes : 0;
+}
+
+uint32_t warmBytes(int excludePanel) {
+  uint32_t total = 0;
+  for (int i = 0; i < MAX_PANELS; i++) {
+    if (i != excludePanel && entries[i].warm) {
+      total += entries[i].costBytes;
+    }
+  }
+  return total;
+}
+
+int oldestWarm(int keep) {
+  int victim = NONE;
+  for (int i = 0; i < MAX_PANELS; i++) {
+    if (i == keep || !entries[i].warm) {
+      continue;
+    }
+    // Signed difference keeps the comparison right across millis() wrap.
+    if (victim == NONE ||
+        static_cast<int32_t>(entries[i].lastUsedMs -
+                             entries[victim].lastUsedMs) < 0) {
+      victim = i;
+    }
+  }
+  return victim;
+}
+
+int pickVictim(int keep, uint32_t freeHeap) {
+  bool overBudget = warmBytes(keep) > PANEL_POOL_BUDGET_BYTES;
+  bool lowHeap = freeHeap < PANEL_POOL_MIN_FREE_HEAP;
+  if (!overBudget && !lowHeap) {
+    return NONE;
+  }
+  return oldestWarm(keep);
+}
+
+} // namespace PanelPool
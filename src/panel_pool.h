@@ -0,0 +1,49 @@
+#ifndef PANEL_POOL_H
+#define PANEL_POOL_H
+
+#include <cstdint>
+
+// Heap the warm (built but not on screen) panels may hold together.
+#ifndef PANEL_POOL_BUDGET_BYTES
+#define PANEL_POOL_BUDGET_BYTES (64 * 1024)
+#endif
+
+// Free heap to keep in reserve; below it warm panels are evicted even when
+// they fit the budget.
+#ifndef PANEL_POOL_MIN_FREE_HEAP
+#define PANEL_POOL_MIN_FREE_HEAP (40 * 1024)
+#endif
+
+// Bookkeeping for right-hand panels that stay built after their screen is
+// left. The pool only tracks cost and recency; the owner builds and deletes
+// the widgets and asks pickVictim() which panel to give up under pressure.
+namespace PanelPool {
+
+constexpr int MAX_PANELS = 4;
+constexpr int NONE = -1;
+
+void markBuilt(int panel, uint32_t costBytes, uint32_t nowMs);
+void markUsed(int panel, uint32_t nowMs);
+void markEvicted(int panel);
+
+// Heap taken or returned by parts of a panel built after the panel itself.
+void addCost(int panel, int32_t deltaBytes);
+
+bool isWarm(int panel);
+
+// Cost measured at the last build, kept after eviction to predict a rebuild.
+uint32_t lastCost(int panel);
+
+// Total cost of warm panels, optionally leaving one out.
+uint32_t warmBytes(int excludePanel = NONE);
+
+// Least recently used warm panel other than `keep`, or NONE.
+int oldestWarm(int keep);
+
+// Least recently used warm panel other than `keep` that has to go to respect
+// the budget and the free-heap floor, or NONE.
+int pickVictim(int keep, uint32_t freeHeap);
+
+} // namespace PanelPool
+
+#endif // PANEL_POOL_H
@@ -0,0 +1,224 @@
+#include "plunger_widget.h"
+
+namespace PlungerWidget {
+
+namespace {
+
+constexpr lv_coord_t BARREL_WIDTH = 120;
+constexpr lv_coord_t INTERIOR_X = 10;
+constexpr lv_coord_t INTERIOR_WIDTH = 100;
+constexpr lv_coord_t INTERIOR_HEIGHT = 793;
+constexpr lv_coord_t BLOCK_X = 20;
+constexpr lv_coord_t BLOCK_WIDTH = 80;
+constexpr lv_coord_t ROD_X = 20;
+constexpr lv_coord_t ROD_WIDTH = 80;
+constexpr lv_coord_t TIP_X = 0;
+constexpr lv_coord_t TIP_WIDTH = 90;
+constexpr lv_coord_t HOLE_X = 15;
+constexpr lv_coord_t HOLE_Y = 107;
+constexpr lv_coord_t HOLE_WIDTH = 90;
+constexpr lv_coord_t HOLE_HEIGHT = 96;
+constexpr lv_coord_t SHADOW_WIDTH = 20;
+constexpr lv_coord_t SHADOW_OFFSET_X = 10;
+
+struct State {
+  Block blocks[MAX_BLOCKS];
+  uint8_t blockCount;
+  lv_coord_t tipY;
+};
+
+State *getState(lv_obj_t *widget) {
+  if (!widget) {
+    return nullptr;
+  }
+  return static_cast<State *>(lv_obj_get_user_data(widget));
+}
+
+lv_coord_t rodTop(lv_coord_t tipY) {
+  lv_coord_t top = tipY - TIP_ANCHOR_Y;
+  return top < 0 ? 0 : top;
+}
+
+// Invalidate the horizontal strip [y1, y2) in widget coordinates.
+void invalidateRows(lv_obj_t *widget, lv_coord_t y1, lv_coord_t y2) {
+  if (y1 < 0)
+    y1 = 0;
+  if (y2 > HEIGHT)
+    y2 = HEIGHT;
+  if (y2 <= y1) {
+    return;
+  }
+  lv_area_t area;
+  lv_obj_get_coords(widget, &area);
+  area.y2 = area.y1 + y2 - 1;
+  area.y1 = area.y1 + y1;
+  lv_obj_invalidate_area(widget, &area);
+}
+
+void fillRect(lv_layer_t *layer, const lv_area_t &origin, lv_coord_t x,
+              lv_coord_t y, lv_coord_t w, lv_coord_t h, lv_color_t color,
+              lv_opa_t opa = LV_OPA_COVER) {
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  lv_draw_rect_dsc_t dsc;
+  lv_draw_rect_dsc_init(&dsc);
+  dsc.bg_color = color;
+  dsc.bg_opa = opa;
+  dsc.radius = 0;
+
+  lv_area_t area = {origin.x1 + x, origin.y1 + y, origin.x1 + x + w - 1,
+                    origin.y1 + y + h - 1};
+  lv_draw_rect(layer, &dsc, &area);
+}
+
+void onDraw(lv_event_t *e) {
+  lv_obj_t *widget = lv_event_get_target_obj(e);
+  State *state = getState(widget);
+  lv_layer_t *layer = lv_event_get_layer(e);
+  if (!state || !layer) {
+    return;
+  }
+
+  lv_area_t origin;
+  lv_obj_get_coords(widget, &origin);
+
+  // Barrel with its blue side shadow
+  lv_draw_rect_dsc_t barrel;
+  lv_draw_rect_dsc_init(&barrel);
+  barrel.bg_color = lv_color_hex(0xffffff);
+  barrel.radius = 0;
+  barrel.shadow_width = SHADOW_WIDTH;
+  barrel.shadow_offset_x = SHADOW_OFFSET_X;
+  barrel.shadow_color = lv_color_hex(0x2669e3);
+  barrel.shadow_opa = LV_OPA_COVER;
+  lv_area_t barrelArea = {origin.x1, origin.y1, origin.x1 + BARREL_WIDTH - 1,
+                          origin.y1 + HEIGHT - 1};
+  lv_draw_rect(layer, &barrel, &barrelArea);
+
+  fillRect(layer, origin, INTERIOR_X, 0, INTERIOR_WIDTH, INTERIOR_HEIGHT,
+           lv_color_hex(0x92979f));
+
+  // Refill stack, oldest block at the bottom
+  lv_coord_t y = BARREL_BOTTOM_Y;
+  for (int i = 0; i < state->blockCount; i++) {
+    const Block &block = state->blocks[i];
+    y -= block.heightPx;
+    fillRect(layer, origin, BLOCK_X, y, BLOCK_WIDTH, block.heightPx,
+             block.color);
+  }
+
+  // Rod down to the tip, then the tip itself
+  lv_coord_t top = rodTop(state->tipY);
+  fillRect(layer, origin, ROD_X, top, ROD_WIDTH, state->tipY - top,
+           lv_color_hex(0x5a5b5e));
+  fillRect(layer, origin, TIP_X, state->tipY, TIP_WIDTH, TIP_HEIGHT,
+           lv_color_hex(0x6a4303));
+
+  fillRect(layer, origin, HOLE_X, HOLE_Y, HOLE_WIDTH, HOLE_HEIGHT,
+           lv_color_hex(0xffffff), 200);
+}
+
+// The barrel shadow spills past the widget's bounds; without this it would
+// be clipped and leave stale pixels behind when the widget moves. Same
+// extent LVGL computes for a styled shadow.
+void onExtDrawSize(lv_event_t *e) {
+  lv_event_set_ext_draw_size(e, SHADOW_WIDTH / 2 + SHADOW_OFFSET_X);
+}
+
+void onDelete(lv_event_t *e) {
+  lv_obj_t *widget = lv_event_get_target_obj(e);
+  State *state = getState(widget);
+  if (state) {
+    lv_free(state);
+    lv_obj_set_user_data(widget, nullptr);
+  }
+}
+
+} // namespace
+
+lv_obj_t *create(lv_obj_t *parent) {
+  lv_obj_t *widget = lv_obj_create(parent);
+  if (!widget) {
+    return nullptr;
+  }
+
+  State *state = static_cast<State *>(lv_malloc_zeroed(sizeof(State)));
+  if (!state) {
+    lv_obj_delete(widget);
+    return nullptr;
+  }
+  state->tipY = TIP_ANCHOR_Y;
+
+  // No theme styles: everything is painted in onDraw.
+  lv_obj_remove_style_all(widget);
+  lv_obj_set_pos(widget, 0, 0);
+  lv_obj_set_size(widget, WIDTH, HEIGHT);
+  lv_obj_remove_flag(widget, LV_OBJ_FLAG_CLICKABLE |
+                                 LV_OBJ_FLAG_CLICK_FOCUSABLE |
+                                 LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_user_data(widget, state);
+  lv_obj_add_event_cb(widget, onDraw, LV_EVENT_DRAW_MAIN, nullptr);
+  lv_obj_add_event_cb(widget, onExtDrawSize, LV_EVENT_REFR_EXT_DRAW_SIZE,
+                      nullptr);
+  lv_obj_refresh_ext_draw_size(widget);
+  lv_obj_add_event_cb(widget, onDelete, LV_EVENT_DELETE, nullptr);
+  return widget;
+}
+
+void setBlocks(lv_obj_t *widget, const Block *blocks, int count) {
+  State *state = getState(widget);
+  if (!state) {
+    return;
+  }
+  if (!blocks || count < 0)
+    count = 0;
+  if (count > MAX_BLOCKS)
+    count = MAX_BLOCKS;
+
+  // Walk old and new stacks bottom-up in parallel. A block whose top edge,
+  // height or colour moved dirties the union of its old and new rows.
+  lv_coord_t oldTop = BARREL_BOTTOM_Y;
+  lv_coord_t newTop = BARREL_BOTTOM_Y;
+  int span = count > state->blockCount ? count : state->blockCount;
+  for (int i = 0; i < span; i++) {
+    bool hadOld = i < state->blockCount;
+    bool hasNew = i < count;
+    lv_coord_t oldH = hadOld ? state->blocks[i].heightPx : 0;
+    lv_coord_t newH = hasNew ? blocks[i].heightPx : 0;
+
+    bool unchanged = hadOld && hasNew && oldTop == newTop && oldH == newH &&
+                     lv_color_eq(state->blocks[i].color, blocks[i].color);
+    if (!unchanged) {
+      lv_coord_t y1 = LV_MIN(oldTop - oldH, newTop - newH);
+      lv_coord_t y2 = LV_MAX(oldTop, newTop);
+      invalidateRows(widget, y1, y2);
+    }
+
+    oldTop -= oldH;
+    newTop -= newH;
+    if (hasNew) {
+      state->blocks[i] = blocks[i];
+    }
+  }
+  state->blockCount = static_cast<uint8_t>(count);
+}
+
+void setTipY(lv_obj_t *widget, lv_coord_t tipY) {
+  State *state = getState(widget);
+  if (!state || state->tipY == tipY) {
+    return;
+  }
+
+  lv_coord_t oldY = state->tipY;
+  state->tipY = tipY;
+
+  // Only the rod's top edge and the tip band move; the rod body in between is
+  // identical before and after.
+  lv_coord_t oldTop = rodTop(oldY);
+  lv_coord_t newTop = rodTop(tipY);
+  invalidateRows(widget, LV_MIN(oldTop, newTop), LV_MAX(oldTop, newTop));
+  invalidateRows(widget, LV_MIN(oldY, tipY), LV_MAX(oldY, tipY) + TIP_HEIGHT);
+}
+
+} // namespace PlungerWidget
@@ -0,0 +1,48 @@
+#ifndef PLUNGER_WIDGET_H
+#define PLUNGER_WIDGET_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Custom-drawn barrel/plunger graphic for the left column.
+// Replaces the EEZ `plunger_and_tip` user widget (barrel, interior, 16 refill
+// bands, rod, tip and refill hole objects) with a single lv_obj that paints
+// everything from a compact block array in one draw callback.
+namespace PlungerWidget {
+
+constexpr int MAX_BLOCKS = 16;
+constexpr lv_coord_t WIDTH = 130;
+constexpr lv_coord_t HEIGHT = 800;
+
+// Bottom of the refill stack / lowest tip position, in widget pixels.
+constexpr lv_coord_t BARREL_BOTTOM_Y = 791;
+constexpr lv_coord_t TIP_HEIGHT = 80;
+// The legacy rod object was 793px tall with the tip anchored 700px below its
+// top edge, so the rod top trails the tip by this amount.
+constexpr lv_coord_t TIP_ANCHOR_Y = 700;
+
+// Encoder turns with the tip top at Y=0 and with the tip resting on the
+// barrel bottom. The tip travels BARREL_BOTTOM_Y - TIP_HEIGHT = 711px between
+// them, about 2.1037px per turn; refill blocks use the same scale.
+constexpr float TIP_TOP_TURNS = 22.53f;
+constexpr float MAX_TURNS = 360.5f;
+constexpr float PX_PER_TURN =
+    (BARREL_BOTTOM_Y - TIP_HEIGHT) / (MAX_TURNS - TIP_TOP_TURNS);
+
+struct Block {
+  uint16_t heightPx;
+  lv_color_t color;
+};
+
+lv_obj_t *create(lv_obj_t *parent);
+
+// Blocks are ordered bottom (index 0, oldest) to top. Only rows whose block
+// geometry or colour changed are invalidated.
+void setBlocks(lv_obj_t *widget, const Block *blocks, int count);
+
+// Top edge of the plunger tip, in widget pixels.
+void setTipY(lv_obj_t *widget, lv_coord_t tipY);
+
+} // namespace PlungerWidget
+
+#endif // PLUNGER_WIDGET_H
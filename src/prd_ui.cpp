@@ -1,11 +1,34 @@
 #include "prd_ui.h"
 
+#include "boot_profile.h"
 #include "display_comms.h"
+#include "motion_smoother.h"
+#include "mould_library.h"
+#include "mould_search.h"
+#include "mould_transfer.h"
+#include "numeric_keypad.h"
+#include "numeric_readout.h"
+#include "obj_handle.h"
+#include "panel_pool.h"
+#include "property_grid.h"
+#include "plunger_widget.h"
+#include "refill_colour.h"
+#include "refill_engine.h"
+#include "refill_stack.h"
+#include "sd_card.h"
+#include "shot_stats.h"
 #include "storage.h"
+#include "storage_worker.h"
+#include "style_cache.h"
+#include "ui_model.h"
+#include "ui_styles.h"
+#include "virtual_list.h"
+#include "warm_start.h"
 #include "ui/eez-flow.h"
 #include "ui/screens.h"
 
 #include <Arduino.h>
+#include <LittleFS.h>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -20,127 +43,203 @@ constexpr lv_coord_t RIGHT_X = 130;
 constexpr lv_coord_t RIGHT_WIDTH = 350;
 constexpr lv_coord_t SCREEN_WIDTH = 480;
 constexpr lv_coord_t SCREEN_HEIGHT = 800;
-constexpr int MAX_MOULD_PROFILES = 16;
 constexpr uint32_t DOUBLE_TAP_MS = 420;
-
-const char *COMMON_FIELD_NAMES[] = {
-    "Trap Accel",          "Compress Torque",  "Micro Interval (ms)",
-    "Micro Duration (ms)", "Purge Up",         "Purge Down",
-    "Purge Current",       "Antidrip Vel",     "Antidrip Current",
-    "Release Dist",        "Release Trap Vel", "Release Current",
-    "Contactor Cycles",    "Contactor Limit",
+// Per tick, so a library transfer doesn't stall the UI.
+constexpr uint32_t TRANSFER_BUDGET_MS = 10;
+portMUX_TYPE transferLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Mould list rows: 46 px buttons on a 54 px pitch. The 478 px list shows at
+// most 9 full rows plus a partial one.
+constexpr lv_coord_t MOULD_ROW_PITCH = 54;
+constexpr int MOULD_ROW_POOL = 12;
+
+// Right-hand panels, as PanelPool ids.
+enum PanelId { PANEL_MAIN = 0, PANEL_MOULD, PANEL_COMMON };
+const char *PANEL_NAMES[] = {"Main", "Mould", "Common"};
+
+// Numeric bounds of 0, 0 leave the value unbounded.
+const PropertyGrid::Field COMMON_FIELDS[] = {
+    {"Trap Accel", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 1},
+    {"Compress Torque", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 0.1},
+    {"Micro Interval (ms)", PropertyGrid::INTEGER, 20, nullptr, 0, 60000, 10},
+    {"Micro Duration (ms)", PropertyGrid::INTEGER, 20, nullptr, 0, 60000, 10},
+    {"Purge Up", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 1},
+    {"Purge Down", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 1},
+    {"Purge Current", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 0.1},
+    {"Antidrip Vel", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 1},
+    {"Antidrip Current", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 0.1},
+    {"Release Dist", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 0.1},
+    {"Release Trap Vel", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 1},
+    {"Release Current", PropertyGrid::DECIMAL, 20, nullptr, 0, 0, 0.1},
+    {"Contactor Cycles", PropertyGrid::INTEGER, 20, nullptr, 0, 1000000, 1},
+    {"Contactor Limit", PropertyGrid::INTEGER, 20, nullptr, 0, 1000000, 1},
 };
 
-const bool COMMON_FIELD_IS_INTEGER[] = {false, false, true,  true,  false,
-                                        false, false, false, false, false,
-                                        false, false, true,  true};
-
 constexpr int COMMON_FIELD_COUNT =
-    sizeof(COMMON_FIELD_NAMES) / sizeof(COMMON_FIELD_NAMES[0]);
-
-const char *MOULD_FIELD_NAMES[] = {
-    "Name",         "Fill Volume",  "Fill Speed",    "Fill Pressure",
-    "Pack Volume",  "Pack Speed",   "Pack Pressure", "Pack Time",
-    "Cooling Time", "Fill Accel",   "Fill Decel",    "Pack Accel",
-    "Pack Decel",   "Mode (2D/3D)", "Inject Torque",
+    sizeof(COMMON_FIELDS) / sizeof(COMMON_FIELDS[0]);
+
+constexpr int MOULD_FIELD_NAME = 0;
+constexpr int MOULD_FIELD_MODE = 13;
+
+const PropertyGrid::Field MOULD_FIELDS[] = {
+    {"Name", PropertyGrid::TEXT, 20, nullptr},
+    {"Fill Volume", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 1},
+    {"Fill Speed", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 1},
+    {"Fill Pressure", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 1},
+    {"Pack Volume", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 1},
+    {"Pack Speed", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 1},
+    {"Pack Pressure", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 1},
+    {"Pack Time", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 0.5},
+    {"Cooling Time", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 0.5},
+    {"Fill Accel", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 10},
+    {"Fill Decel", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 10},
+    {"Pack Accel", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 10},
+    {"Pack Decel", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 10},
+    {"Mode (2D/3D)", PropertyGrid::CHOICE, 0, "2D\n3D"},
+    {"Inject Torque", PropertyGrid::DECIMAL, 10, nullptr, 0, 9999, 0.1},
 };
 
-// 0=String, 1=Float, 2=Integer (none currently)
-constexpr int MOULD_FIELD_TYPE[] = {0, 1, 1, 1, 1, 1, 1, 1,
-                                    1, 1, 1, 1, 1, 0, 1};
-
 constexpr int MOULD_FIELD_COUNT =
-    sizeof(MOULD_FIELD_NAMES) / sizeof(MOULD_FIELD_NAMES[0]);
-
-struct RefillBlock {
-  float volume; // cm3
-  uint32_t addedMs;
-  bool active;
-
-  RefillBlock() : volume(0), addedMs(0), active(false) {}
-  RefillBlock(float v, uint32_t a, bool act)
-      : volume(v), addedMs(a), active(act) {}
-};
+    sizeof(MOULD_FIELDS) / sizeof(MOULD_FIELDS[0]);
 
 struct UiState {
   bool initialized = false;
 
-  lv_obj_t *rightPanelMain = nullptr;
-  lv_obj_t *rightPanelMould = nullptr;
-  lv_obj_t *rightPanelCommon = nullptr;
+  ObjRef rightPanelMain;
+  ObjRef rightPanelMould;
+  ObjRef rightPanelCommon;
 
-  lv_obj_t *posLabelMain = nullptr;
-  lv_obj_t *tempLabelMain = nullptr;
-  lv_obj_t *posLabelMould = nullptr;
-  lv_obj_t *tempLabelMould = nullptr;
-  lv_obj_t *posLabelCommon = nullptr;
-  lv_obj_t *tempLabelCommon = nullptr;
+  // Left column: one persistent instance, re-parented onto whichever screen
+  // is being loaded.
+  lv_obj_t *plunger = nullptr;
+  lv_obj_t *posReadout = nullptr;
+  lv_obj_t *tempReadout = nullptr;
 
   lv_obj_t *stateValue = nullptr;
   lv_obj_t *stateAction1 = nullptr;
   lv_obj_t *stateAction2 = nullptr;
   lv_obj_t *mainErrorLabel = nullptr;
 
-  lv_obj_t *mouldList = nullptr;
+  ObjRef mouldList;
+  lv_obj_t *mouldSearch = nullptr;
   lv_obj_t *mouldNotice = nullptr;
 
-  lv_obj_t *mouldButtonBack = nullptr;
+  ObjRef mouldButtonBack;
   lv_obj_t *mouldButtonSend = nullptr;
   lv_obj_t *mouldButtonEdit = nullptr;
-  lv_obj_t *mouldButtonSave = nullptr;
+  ObjRef mouldButtonSave;
   lv_obj_t *mouldButtonNew = nullptr;
   lv_obj_t *mouldButtonDelete = nullptr;
-  lv_obj_t *mouldDeleteOverlay = nullptr;
-  lv_obj_t *mouldProfileButtons[MAX_MOULD_PROFILES] = {};
-  DisplayComms::MouldParams mouldProfiles[MAX_MOULD_PROFILES] = {};
-  int mouldProfileCount = 0;
+  ObjRef mouldDeleteOverlay;
   int selectedMould = -1;
   int lastTappedMould = -1;
   uint32_t lastTapMs = 0;
 
-  lv_obj_t *commonScroll = nullptr;
+  lv_obj_t *commonGrid = nullptr;
   lv_obj_t *commonNotice = nullptr;
-  lv_obj_t *commonButtonBack = nullptr;
+  ObjRef commonButtonBack;
   lv_obj_t *commonButtonSend = nullptr;
-  lv_obj_t *commonInputs[COMMON_FIELD_COUNT] = {};
   lv_obj_t *commonDiscardOverlay = nullptr;
   bool commonDirty = false;
-  bool suppressCommonEvents = false;
 
-  lv_obj_t *sharedKeyboard = nullptr;
+  ObjRef sharedKeyboard;
+  ObjRef numericKeypad;
   char lastMouldName[32] = {0};
   lv_obj_t *lastMainScreen = nullptr;
   lv_obj_t *lastMouldScreen = nullptr;
   lv_obj_t *lastCommonScreen = nullptr;
   lv_obj_t *lastActiveScreen = nullptr;
-  lv_obj_t *activeScrollContainer = nullptr;
+  ObjRef activeScrollContainer;
 
-  lv_obj_t *rightPanelMouldEdit = nullptr;
-  lv_obj_t *mouldEditScroll = nullptr;
-  lv_obj_t *mouldEditInputs[MOULD_FIELD_COUNT] = {};
+  ObjRef rightPanelMouldEdit;
+  lv_obj_t *mouldEditGrid = nullptr;
   bool mouldEditDirty = false;
+  uint32_t mouldEditCost = 0; // heap charged to PANEL_MOULD for the editor
   bool inMouldEditPopulation = false;
 
-  RefillBlock refillBlocks[16];
+  // Copy of the block list DisplayComms' refill engine publishes; only the
+  // colour levels are the UI's own.
+  RefillBlock blocks[RefillStack::CAPACITY];
   int blockCount = 0;
-  char lastState[24] = "";
-  float startRefillPos = 0;
-  float lastFramePos = 0;
-  bool isRefilling = false;
-  bool refillSequenceActive =
-      false; // New flag for strictly tracking REFILL -> ... -> READY sequence
-
-  bool mockEnabled = false;
-  float mockPos = 0;
-  char mockState[24] = "";
+  int overdosedBlocks = 0;
+  uint32_t refillRevision = 0;
+  bool plungerBlocksDirty = true; // published as UiModel::refill
+
+  // Copy of DisplayComms' shot statistics, published as UiModel::shots.
+  ShotSummary shots = {};
+  uint32_t shotRevision = 0;
+
+  // Plunger motion between sparse ENC samples, advanced once per frame.
+  MotionSmoother plungerMotion;
+  lv_timer_t *plungerFrameTimer = nullptr;
+  uint32_t lastEncoderSample = UINT32_MAX;
+  char motionState[24] = "";
+
+  bool mockEnabled = false; // MOCK lines injected; no snapshots saved
+
+  // ObjRef validity checks per second, i.e. lv_obj_is_valid() tree walks
+  // avoided, and the walks still done for raw pointers. Sampled from
+  // ObjHandle::checkCount() and treeWalks once a second.
+  uint32_t handleCheckBase = 0;
+  uint32_t handleRateMs = 0;
+  uint32_t handleChecksPerSec = 0;
+  uint32_t treeWalks = 0;
+  uint32_t treeWalkBase = 0;
+  uint32_t treeWalksPerSec = 0;
+
+  // Timing of the screen change in progress, reported once its panel is up.
+  bool navPending = false;
+  uint32_t navStartMs = 0;
+  uint32_t navHeapBefore = 0;
+
+  // Mould library write the mould notice is waiting on, as a StorageWorker
+  // ticket, and the notice to show once it lands.
+  uint32_t storageTicket = 0;
+  const char *storageDoneText = nullptr;
+
+  // MOULDS|n from the console, for tick() to print; -1 when none. The
+  // library belongs to the GUI task, so loop() doesn't walk it itself.
+  volatile int mouldPageRequest = -1;
+
+  // EXPORT|path or IMPORT|path from the console, for tick() to start; the
+  // transfer runs on the GUI task with the library. Guarded by
+  // transferLock.
+  bool transferPending = false;
+  bool transferImport = false;
+  char transferPath[64] = "";
+
+  // Boot report not printed yet; in a fast boot, deferred setup not run.
+  bool bootPending = true;
+  bool libraryLoaded = false;
+
+  // Warm-start snapshot, and the DisplayComms::Received parts of it still
+  // standing in for data the controller hasn't sent since boot.
+  WarmStart::Snapshot warm = {};
+  uint32_t staleParts = 0;
+  uint32_t lastWarmOfferMs = 0;
 };
 
 UiState ui;
 
-// Forward declaration
+// Forward declarations
 void createMouldEditPanel();
+void syncMouldSendEditEnablement();
+void updateStateWidgets(const DisplayComms::Status &status);
+void updateMouldListFromComms(const DisplayComms::MouldParams &mould);
+
+// Generated EEZ objects and other untracked pointers; each call walks the
+// object tree.
+inline bool isObjReady(lv_obj_t *obj) {
+  if (!obj) {
+    return false;
+  }
+  ui.treeWalks++;
+  return lv_obj_is_valid(obj);
+}
 
-inline bool isObjReady(lv_obj_t *obj) { return obj && lv_obj_is_valid(obj); }
+// Panels and other widgets PrdUi deletes and recreates are held as ObjRefs;
+// checking them is a registry lookup rather than a walk of the object tree.
+inline bool isObjReady(const ObjRef &ref) { return ref.isReady(); }
 
 inline void uiYield() { delay(0); }
 
@@ -150,10 +249,21 @@ inline void hideIfPresent(lv_obj_t *obj) {
   }
 }
 
-static void async_scroll_to_view(void *target) {
-  if (isObjReady((lv_obj_t *)target)) {
+// The textarea may be deleted before the call runs, so it travels as a
+// handle.
+static void async_scroll_to_view(void *userData) {
+  ObjHandle::Handle handle = ObjHandle::fromUserData(userData);
+  if (ObjHandle::isLive(handle)) {
     Serial.println("PRD_UI: ASYNC Scrolling to view.");
-    lv_obj_scroll_to_view((lv_obj_t *)target, LV_ANIM_OFF);
+    lv_obj_scroll_to_view(ObjHandle::get(handle), LV_ANIM_OFF);
+  }
+  ObjHandle::release(handle);
+}
+
+static void scrollToViewLater(lv_obj_t *target) {
+  ObjHandle::Handle handle = ObjHandle::track(target);
+  if (handle.generation != 0) {
+    lv_async_call(async_scroll_to_view, ObjHandle::toUserData(handle));
   }
 }
 
@@ -191,22 +301,15 @@ void setLabelTextIfChanged(lv_obj_t *label, const char *text) {
   }
 }
 
-void setTextareaTextIfChanged(lv_obj_t *textarea, const char *text) {
-  if (!textarea || !text) {
-    return;
-  }
-  const char *current = lv_textarea_get_text(textarea);
-  if (!current || strcmp(current, text) != 0) {
-    lv_textarea_set_text(textarea, text);
-  }
-}
-
-void setNotice(lv_obj_t *label, const char *text,
-               lv_color_t color = lv_color_hex(0xffd6d6d6)) {
+// `tone` is one of the UiStyles::NOTICE_* states, or 0 for plain text.
+void setNotice(lv_obj_t *label, const char *text, lv_state_t tone = 0) {
   if (!label) {
     return;
   }
-  lv_obj_set_style_text_color(label, color, LV_PART_MAIN | LV_STATE_DEFAULT);
+  for (lv_state_t state : {UiStyles::NOTICE_OK, UiStyles::NOTICE_WARN,
+                           UiStyles::NOTICE_ALERT}) {
+    StyleCache::setState(label, state, state == tone);
+  }
   setLabelTextIfChanged(label, text ? text : "");
 }
 
@@ -224,23 +327,14 @@ lv_obj_t *createButton(lv_obj_t *parent, const char *text, lv_coord_t x,
 
   lv_obj_set_pos(button, x, y);
   lv_obj_set_size(button, w, h);
-  lv_obj_set_style_radius(button, 8, LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_bg_color(button, lv_color_hex(0x1f5ea8),
-                            LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_bg_opa(button, LV_OPA_COVER,
-                          LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_width(button, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_text_color(button, lv_color_hex(0xffffff),
-                              LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(button, UiStyles::BUTTON);
   if (cb) {
     lv_obj_add_event_cb(button, cb, LV_EVENT_CLICKED, userData);
   }
 
   lv_obj_t *label = lv_label_create(button);
   if (label) {
-    lv_label_set_text(label, text);
-    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_label_set_text(label, text); // alignment inherited from the button
     lv_obj_center(label);
   }
   return button;
@@ -269,6 +363,71 @@ void hideLegacyWidgets() {
   hideIfPresent(objects.obj5__obj0);
 }
 
+// The EEZ plunger_and_tip graphics each generated plunger owns, by name:
+// barrel, interior, 16 refill bands, rod, tip and refill hole.
+constexpr int LEGACY_PLUNGER_PARTS = 21;
+#define LEGACY_PLUNGER_PARTS_OF(p)                                           \
+  {                                                                          \
+    &objects.p##__background_barrel,                                         \
+        &objects.p##__background_barrel_interior,                            \
+        &objects.p##__refill_band_0, &objects.p##__refill_band_1,            \
+        &objects.p##__refill_band_2, &objects.p##__refill_band_3,            \
+        &objects.p##__refill_band_4, &objects.p##__refill_band_5,            \
+        &objects.p##__refill_band_6, &objects.p##__refill_band_7,            \
+        &objects.p##__refill_band_8, &objects.p##__refill_band_9,            \
+        &objects.p##__refill_band_10, &objects.p##__refill_band_11,          \
+        &objects.p##__refill_band_12, &objects.p##__refill_band_13,          \
+        &objects.p##__refill_band_14, &objects.p##__refill_band_15,          \
+        &objects.p##__plunger, &objects.p##__plunger_tip,                    \
+        &objects.p##__refill_hole                                            \
+  }
+
+// Drop the EEZ plunger_and_tip graphics. The value label survives because
+// tick_user_widget_plunger_and_tip still writes to it every EEZ tick.
+void releaseLegacyPlunger(lv_obj_t *container,
+                          lv_obj_t **const (&parts)[LEGACY_PLUNGER_PARTS],
+                          lv_obj_t *valueLabel) {
+  if (!isObjReady(container)) {
+    return;
+  }
+  lv_obj_add_flag(container, LV_OBJ_FLAG_HIDDEN);
+  for (int32_t i = static_cast<int32_t>(lv_obj_get_child_count(container)) - 1;
+       i >= 0; i--) {
+    lv_obj_t *child = lv_obj_get_child(container, i);
+    if (child && child != valueLabel) {
+      lv_obj_delete(child);
+    }
+  }
+  for (lv_obj_t **part : parts) {
+    *part = nullptr;
+  }
+}
+
+void releaseLegacyPlungers() {
+  lv_obj_t **const tipParts[] = LEGACY_PLUNGER_PARTS_OF(plunger_tip);
+  lv_obj_t **const obj0Parts[] = LEGACY_PLUNGER_PARTS_OF(obj0);
+  lv_obj_t **const obj2Parts[] = LEGACY_PLUNGER_PARTS_OF(obj2);
+  lv_obj_t **const obj5Parts[] = LEGACY_PLUNGER_PARTS_OF(obj5);
+  releaseLegacyPlunger(objects.plunger_tip, tipParts,
+                       objects.plunger_tip__obj0);
+  releaseLegacyPlunger(objects.obj0, obj0Parts, objects.obj0__obj0);
+  releaseLegacyPlunger(objects.obj2, obj2Parts, objects.obj2__obj0);
+  releaseLegacyPlunger(objects.obj5, obj5Parts, objects.obj5__obj0);
+}
+
+#undef LEGACY_PLUNGER_PARTS_OF
+
+bool hasMachineError(const DisplayComms::Status &status) {
+  return (status.errorCode != 0) || (status.errorMsg[0] != '\0');
+}
+
+// Bound to each right panel; draws the red frame while an error is set.
+void onErrorFrameChanged(lv_observer_t *observer, lv_subject_t *) {
+  StyleCache::setState(lv_observer_get_target_obj(observer),
+                       UiStyles::PANEL_ERROR,
+                       hasMachineError(UiModel::lastStatus()));
+}
+
 lv_obj_t *createRightPanel(lv_obj_t *screen) {
   if (!isObjReady(screen)) {
     Serial.println("PRD_UI: createRightPanel skipped (invalid screen)");
@@ -282,36 +441,43 @@ lv_obj_t *createRightPanel(lv_obj_t *screen) {
   }
   lv_obj_set_pos(panel, RIGHT_X, 0);
   lv_obj_set_size(panel, RIGHT_WIDTH, SCREEN_HEIGHT);
-  lv_obj_set_style_bg_color(panel, lv_color_hex(0x11151a),
-                            LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_bg_opa(panel, LV_OPA_COVER, LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_width(panel, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_pad_all(panel, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_radius(panel, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(panel, UiStyles::PANEL);
   lv_obj_clear_flag(panel, LV_OBJ_FLAG_SCROLLABLE);
+  lv_subject_add_observer_obj(&UiModel::error, onErrorFrameChanged, panel,
+                              nullptr);
   return panel;
 }
 
 void hideKeyboard() {
-  if (isObjReady(ui.sharedKeyboard)) {
+  PropertyGrid::closeEditor(ui.mouldEditGrid);
+  PropertyGrid::closeEditor(ui.commonGrid);
+  bool keypadReady = isObjReady(ui.numericKeypad);
+  if (keypadReady) {
+    NumericKeypad::close(ui.numericKeypad);
+  }
+  bool keyboardReady = isObjReady(ui.sharedKeyboard);
+  if (keyboardReady) {
     Serial.println("PRD_UI: hideKeyboard called.");
     lv_keyboard_set_textarea(ui.sharedKeyboard, nullptr);
     lv_obj_add_flag(ui.sharedKeyboard, LV_OBJ_FLAG_HIDDEN);
+  }
+  if (!keypadReady && !keyboardReady) {
+    return;
+  }
 
-    // Reset background scroll if we were tracking a container
-    if (isObjReady(ui.activeScrollContainer)) {
-      Serial.println("PRD_UI: Resetting scroll container.");
-      lv_obj_scroll_to_y(ui.activeScrollContainer, 0,
-                         LV_ANIM_OFF); // Off for snappier return
-      ui.activeScrollContainer = nullptr;
-    }
-
-    // Restore navigation responsiveness
-    if (isObjReady(ui.commonButtonBack))
-      lv_obj_move_foreground(ui.commonButtonBack);
-    if (isObjReady(ui.mouldButtonBack))
-      lv_obj_move_foreground(ui.mouldButtonBack);
+  // Reset background scroll if we were tracking a container
+  if (isObjReady(ui.activeScrollContainer)) {
+    Serial.println("PRD_UI: Resetting scroll container.");
+    lv_obj_scroll_to_y(ui.activeScrollContainer, 0,
+                       LV_ANIM_OFF); // Off for snappier return
+    ui.activeScrollContainer = nullptr;
   }
+
+  // Restore navigation responsiveness
+  if (isObjReady(ui.commonButtonBack))
+    lv_obj_move_foreground(ui.commonButtonBack);
+  if (isObjReady(ui.mouldButtonBack))
+    lv_obj_move_foreground(ui.mouldButtonBack);
 }
 
 void onKeyboardEvent(lv_event_t *e) {
@@ -338,13 +504,7 @@ lv_obj_t *getSharedKeyboard(lv_obj_t *parent) {
     lv_obj_add_event_cb(ui.sharedKeyboard, onKeyboardEvent, LV_EVENT_ALL,
                         nullptr);
 
-    // Clean style
-    lv_obj_set_style_border_color(ui.sharedKeyboard, lv_color_hex(0xffec18),
-                                  LV_PART_MAIN);
-    lv_obj_set_style_border_width(ui.sharedKeyboard, 2, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(ui.sharedKeyboard, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_bg_color(ui.sharedKeyboard, lv_color_hex(0x1a222b),
-                              LV_PART_MAIN);
+    UiStyles::apply(ui.sharedKeyboard, UiStyles::KEYBOARD);
   } else {
     // Ensure it stays on top layer if it was moved
     if (lv_obj_get_parent(ui.sharedKeyboard) != top) {
@@ -374,6 +534,9 @@ void showKeyboard(lv_obj_t *textarea, lv_obj_t *scrollContainer,
 
   Serial.print("PRD_UI: showKeyboard for textarea: ");
   Serial.println((uintptr_t)textarea, HEX);
+  if (isObjReady(ui.numericKeypad)) {
+    NumericKeypad::close(ui.numericKeypad);
+  }
 
   // Track this container for reset on hide
   ui.activeScrollContainer = scrollContainer;
@@ -403,13 +566,72 @@ void showKeyboard(lv_obj_t *textarea, lv_obj_t *scrollContainer,
 
   if (isObjReady(scrollContainer)) {
     Serial.println("PRD_UI: Scheduling ASYNC scroll.");
-    lv_async_call(async_scroll_to_view, textarea);
+    scrollToViewLater(textarea);
   }
   Serial.println("PRD_UI: showKeyboard DONE.");
 }
 
+// Built once on the top layer next to the shared keyboard; showing it only
+// moves it and swaps its target.
+lv_obj_t *getNumericKeypad() {
+  if (!isObjReady(ui.numericKeypad)) {
+    ui.numericKeypad = NumericKeypad::create(lv_layer_top());
+    if (!ui.numericKeypad) {
+      return nullptr;
+    }
+    lv_obj_add_event_cb(ui.numericKeypad, onKeyboardEvent, LV_EVENT_READY,
+                        nullptr);
+    UiStyles::apply(ui.numericKeypad, UiStyles::KEYBOARD);
+  }
+  return ui.numericKeypad;
+}
+
+void showKeypad(lv_obj_t *textarea, lv_obj_t *scrollContainer,
+                const PropertyGrid::Field &field) {
+  if (!textarea)
+    return;
+  lv_obj_t *keypad = getNumericKeypad();
+  if (!keypad) {
+    Serial.println("PRD_UI: FAILED to get numeric keypad");
+    return;
+  }
+  if (NumericKeypad::target(keypad) == textarea &&
+      !lv_obj_has_flag(keypad, LV_OBJ_FLAG_HIDDEN)) {
+    return;
+  }
+  if (isObjReady(ui.sharedKeyboard)) {
+    lv_keyboard_set_textarea(ui.sharedKeyboard, nullptr);
+    lv_obj_add_flag(ui.sharedKeyboard, LV_OBJ_FLAG_HIDDEN);
+  }
+  ui.activeScrollContainer = scrollContainer;
+
+  // Same placement rule as showKeyboard, over the right-hand panel.
+  lv_area_t area;
+  lv_obj_get_coords(textarea, &area);
+  if (area.y1 < 350) {
+    lv_obj_align(keypad, LV_ALIGN_BOTTOM_RIGHT, -10, -20);
+  } else {
+    lv_obj_align(keypad, LV_ALIGN_TOP_RIGHT, -10, 50);
+  }
+  NumericKeypad::open(keypad, textarea, field);
+
+  if (isObjReady(scrollContainer)) {
+    scrollToViewLater(textarea);
+  }
+}
+
+void beginNavTiming() {
+  if (ui.navPending) {
+    return;
+  }
+  ui.navPending = true;
+  ui.navStartMs = millis();
+  ui.navHeapBefore = ESP.getFreeHeap();
+}
+
 void navigateTo(int screen_id) {
   Serial.printf("PRD_UI: navigateTo %d\n", screen_id);
+  beginNavTiming();
   hideKeyboard();
   eez_flow_set_screen(screen_id, LV_SCR_LOAD_ANIM_NONE, 0, 0);
 }
@@ -419,6 +641,9 @@ void purgeMouldPanels() {
   if (isObjReady(ui.sharedKeyboard)) {
     lv_obj_add_flag(ui.sharedKeyboard, LV_OBJ_FLAG_HIDDEN);
   }
+  if (isObjReady(ui.numericKeypad)) {
+    NumericKeypad::close(ui.numericKeypad);
+  }
 
   if (isObjReady(ui.rightPanelMould))
     lv_obj_delete_async(ui.rightPanelMould);
@@ -426,14 +651,11 @@ void purgeMouldPanels() {
     lv_obj_delete_async(ui.rightPanelMouldEdit);
   if (isObjReady(ui.mouldDeleteOverlay))
     lv_obj_delete_async(ui.mouldDeleteOverlay);
-  if (isObjReady(ui.posLabelMould))
-    lv_obj_delete_async(ui.posLabelMould);
-  if (isObjReady(ui.tempLabelMould))
-    lv_obj_delete_async(ui.tempLabelMould);
 
   ui.rightPanelMould = nullptr;
   ui.rightPanelMouldEdit = nullptr;
   ui.mouldList = nullptr;
+  ui.mouldSearch = nullptr;
   ui.mouldNotice = nullptr;
   ui.mouldButtonBack = nullptr;
   ui.mouldButtonSend = nullptr;
@@ -442,13 +664,7 @@ void purgeMouldPanels() {
   ui.mouldButtonNew = nullptr;
   ui.mouldButtonDelete = nullptr;
   ui.mouldDeleteOverlay = nullptr;
-  ui.posLabelMould = nullptr;
-  ui.tempLabelMould = nullptr;
-  ui.mouldEditScroll = nullptr;
-  for (int i = 0; i < MAX_MOULD_PROFILES; i++)
-    ui.mouldProfileButtons[i] = nullptr;
-  for (int i = 0; i < MOULD_FIELD_COUNT; i++)
-    ui.mouldEditInputs[i] = nullptr;
+  ui.mouldEditGrid = nullptr;
 }
 
 void purgeCommonPanel() {
@@ -456,90 +672,307 @@ void purgeCommonPanel() {
   if (isObjReady(ui.sharedKeyboard)) {
     lv_obj_add_flag(ui.sharedKeyboard, LV_OBJ_FLAG_HIDDEN);
   }
+  if (isObjReady(ui.numericKeypad)) {
+    NumericKeypad::close(ui.numericKeypad);
+  }
 
   if (isObjReady(ui.rightPanelCommon))
     lv_obj_delete_async(ui.rightPanelCommon);
-  if (isObjReady(ui.posLabelCommon))
-    lv_obj_delete_async(ui.posLabelCommon);
-  if (isObjReady(ui.tempLabelCommon))
-    lv_obj_delete_async(ui.tempLabelCommon);
 
   ui.rightPanelCommon = nullptr;
-  ui.commonScroll = nullptr;
+  ui.commonGrid = nullptr;
   ui.commonNotice = nullptr;
   ui.commonButtonBack = nullptr;
   ui.commonButtonSend = nullptr;
   ui.commonDiscardOverlay = nullptr;
-  ui.posLabelCommon = nullptr;
-  ui.tempLabelCommon = nullptr;
-  for (int i = 0; i < COMMON_FIELD_COUNT; i++)
-    ui.commonInputs[i] = nullptr;
 }
 
 void purgeMainPanel() {
   if (isObjReady(ui.rightPanelMain))
     lv_obj_delete_async(ui.rightPanelMain);
-  if (isObjReady(ui.posLabelMain))
-    lv_obj_delete_async(ui.posLabelMain);
-  if (isObjReady(ui.tempLabelMain))
-    lv_obj_delete_async(ui.tempLabelMain);
 
   ui.rightPanelMain = nullptr;
-  ui.posLabelMain = nullptr;
-  ui.tempLabelMain = nullptr;
   ui.stateValue = nullptr;
   ui.stateAction1 = nullptr;
   ui.stateAction2 = nullptr;
   ui.mainErrorLabel = nullptr;
 }
 
-void updateErrorFrames(const DisplayComms::Status &status) {
-  bool hasError = (status.errorCode != 0) || (status.errorMsg[0] != '\0');
-  lv_obj_t *panels[] = {ui.rightPanelMain, ui.rightPanelMould,
-                        ui.rightPanelCommon, ui.rightPanelMouldEdit};
+int panelForScreen(lv_obj_t *screen) {
+  if (!screen) {
+    return PanelPool::NONE;
+  }
+  if (screen == objects.main)
+    return PANEL_MAIN;
+  if (screen == objects.mould_settings)
+    return PANEL_MOULD;
+  if (screen == objects.common_settings)
+    return PANEL_COMMON;
+  return PanelPool::NONE;
+}
+
+lv_obj_t *panelRoot(int panel) {
+  switch (panel) {
+  case PANEL_MAIN:
+    return ui.rightPanelMain;
+  case PANEL_MOULD:
+    return ui.rightPanelMould;
+  case PANEL_COMMON:
+    return ui.rightPanelCommon;
+  }
+  return nullptr;
+}
+
+bool isPanelReady(int panel) {
+  switch (panel) {
+  case PANEL_MAIN:
+    return isObjReady(ui.rightPanelMain);
+  case PANEL_MOULD:
+    return isObjReady(ui.rightPanelMould);
+  case PANEL_COMMON:
+    return isObjReady(ui.rightPanelCommon);
+  }
+  return false;
+}
+
+int countObjects(lv_obj_t *obj) {
+  int n = 1;
+  uint32_t children = lv_obj_get_child_count(obj);
+  for (uint32_t i = 0; i < children; i++) {
+    n += countObjects(lv_obj_get_child(obj, i));
+  }
+  return n;
+}
 
-  for (lv_obj_t *panel : panels) {
-    if (!panel) {
-      continue;
+uint32_t heapUsedSince(uint32_t heapBefore) {
+  uint32_t heapNow = ESP.getFreeHeap();
+  return heapBefore > heapNow ? heapBefore - heapNow : 0;
+}
+
+void evictPanel(int panel) {
+  Serial.printf("PRD_UI: Evicting %s panel (%lu bytes)\n", PANEL_NAMES[panel],
+                static_cast<unsigned long>(PanelPool::lastCost(panel)));
+  switch (panel) {
+  case PANEL_MAIN:
+    purgeMainPanel();
+    break;
+  case PANEL_MOULD:
+    purgeMouldPanels();
+    ui.mouldEditCost = 0;
+    break;
+  case PANEL_COMMON:
+    purgeCommonPanel();
+    break;
+  }
+  PanelPool::markEvicted(panel);
+}
+
+// Deletes are async, so the heap they will return is credited up front
+// rather than evicting every warm panel while waiting for it.
+void trimPanelPool(int keep) {
+  uint32_t reclaimed = 0;
+  for (;;) {
+    int victim = PanelPool::pickVictim(keep, ESP.getFreeHeap() + reclaimed);
+    if (victim == PanelPool::NONE) {
+      return;
     }
-    lv_obj_set_style_border_width(panel, hasError ? 4 : 0,
-                                  LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_set_style_border_color(panel, lv_color_hex(0xffc62828),
-                                  LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
-
-  if (ui.mainErrorLabel) {
-    if (hasError) {
-      char text[120];
-      if (status.errorMsg[0] != '\0') {
-        snprintf(text, sizeof(text), "ERROR 0x%X: %s", status.errorCode,
-                 status.errorMsg);
-      } else {
-        snprintf(text, sizeof(text), "ERROR 0x%X", status.errorCode);
-      }
-      setLabelTextIfChanged(ui.mainErrorLabel, text);
-      lv_obj_clear_flag(ui.mainErrorLabel, LV_OBJ_FLAG_HIDDEN);
-    } else {
-      setLabelTextIfChanged(ui.mainErrorLabel, "");
-      lv_obj_add_flag(ui.mainErrorLabel, LV_OBJ_FLAG_HIDDEN);
+    reclaimed += PanelPool::lastCost(victim);
+    evictPanel(victim);
+  }
+}
+
+// Evicts warm panels until `panel` can be built above the free-heap floor.
+// Returns true if anything was evicted; the caller then waits a tick for the
+// async deletes to land before building.
+bool makeRoomFor(int panel) {
+  uint32_t need = PanelPool::lastCost(panel) + PANEL_POOL_MIN_FREE_HEAP;
+  uint32_t reclaimed = 0;
+  bool evicted = false;
+  while (ESP.getFreeHeap() + reclaimed < need) {
+    int victim = PanelPool::oldestWarm(panel);
+    if (victim == PanelPool::NONE) {
+      break;
+    }
+    reclaimed += PanelPool::lastCost(victim);
+    evictPanel(victim);
+    evicted = true;
+  }
+  return evicted;
+}
+
+void sampleHandleCheckRate() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - ui.handleRateMs;
+  if (elapsed < 1000) {
+    return;
+  }
+  uint32_t checks = ObjHandle::checkCount();
+  ui.handleChecksPerSec = (checks - ui.handleCheckBase) * 1000 / elapsed;
+  ui.handleCheckBase = checks;
+  ui.treeWalksPerSec = (ui.treeWalks - ui.treeWalkBase) * 1000 / elapsed;
+  ui.treeWalkBase = ui.treeWalks;
+  ui.handleRateMs = now;
+}
+
+void logHandleStats() {
+  Serial.printf("PRD_UI: Handles live=%d/%d, tree walks avoided=%lu/s, "
+                "done=%lu/s\n",
+                ObjHandle::liveCount(), ObjHandle::MAX_SLOTS,
+                static_cast<unsigned long>(ui.handleChecksPerSec),
+                static_cast<unsigned long>(ui.treeWalksPerSec));
+}
+
+void logStyleStats() {
+  Serial.printf("PRD_UI: Style writes=%lu, suppressed=%lu, objects=%d/%d\n",
+                static_cast<unsigned long>(StyleCache::writeCount()),
+                static_cast<unsigned long>(StyleCache::suppressedCount()),
+                StyleCache::trackedObjects(), StyleCache::MAX_OBJECTS);
+  Serial.printf("PRD_UI: Shared styles attached=%lu, new widgets use %s "
+                "styles\n",
+                static_cast<unsigned long>(UiStyles::attachCount()),
+                UiStyles::localMode() ? "local" : "shared");
+}
+
+// STYLES|LOCAL or STYLES|SHARED picks the mode for panels built from now
+// on, so the build reports can be compared.
+void handleStylesCommand(const char *mode) {
+  if (mode && strcmp(mode, "LOCAL") == 0) {
+    UiStyles::setLocalMode(true);
+  } else if (mode && strcmp(mode, "SHARED") == 0) {
+    UiStyles::setLocalMode(false);
+  }
+  logStyleStats();
+}
+
+void logModelStats() {
+  Serial.printf("PRD_UI: Model subjects set=%lu, unchanged=%lu\n",
+                static_cast<unsigned long>(UiModel::setCount()),
+                static_cast<unsigned long>(UiModel::skipCount()));
+  Serial.printf("PRD_UI: Warm start stale=0x%02lx, snapshots saved=%lu\n",
+                static_cast<unsigned long>(ui.staleParts),
+                static_cast<unsigned long>(WarmStart::saveCount()));
+}
+
+// MOCK|STATE|name and MOCK|POS|turns go through the protocol parser like
+// controller lines, so the refill engine sees them in order. MOCK|OFF|x only
+// re-enables snapshot saves; live lines were never blocked.
+void handleMockCommand(const char *kind, const char *value) {
+  char line[48];
+  if (strcmp(kind, "STATE") == 0) {
+    snprintf(line, sizeof(line), "STATE|%s", value);
+  } else if (strcmp(kind, "POS") == 0) {
+    snprintf(line, sizeof(line), "ENC|%s", value);
+  } else {
+    if (strcmp(kind, "OFF") == 0) {
+      ui.mockEnabled = false;
     }
+    return;
   }
+  ui.mockEnabled = true;
+  DisplayComms::inject(line);
 }
 
-void updateLeftReadouts(const DisplayComms::Status &status) {
-  char posText[40];
-  char tempText[40];
+// REFILLS|n prints the stack, bottom first, and the last n retired blocks.
+// Debug commands run in the comms context, so this reads the engine itself;
+// nothing is redrawn.
+void logRefillHistory(int last) {
+  const RefillStack &stack = DisplayComms::refillEngine().stack();
+  uint32_t now = millis();
+  Serial.printf("PRD_UI: Refill stack %d blocks, %.2f cm3\n", stack.count(),
+                stack.totalVolume());
+  for (int i = 0; i < stack.count(); i++) {
+    const RefillBlock &block = stack.at(i);
+    Serial.printf("  %2d %7.2f of %7.2f cm3, age %lu s, dose %lu C.s\n", i,
+                  block.volume, block.filledVolume,
+                  static_cast<unsigned long>((now - block.addedMs) / 1000),
+                  static_cast<unsigned long>(block.dose /
+                                             RefillEngine::DOSE_UNITS_PER_CS));
+  }
+  int shown = last < stack.historyCount() ? last : stack.historyCount();
+  Serial.printf("PRD_UI: Retired %lu blocks, last %d:\n",
+                static_cast<unsigned long>(stack.retiredTotal()), shown);
+  for (int i = 0; i < shown; i++) {
+    const RetiredBlock *block = stack.retired(i);
+    Serial.printf("  %7.2f cm3, filled at %lu s, used up after %lu s, "
+                  "dose %lu C.s\n",
+                  block->volume,
+                  static_cast<unsigned long>(block->filledMs / 1000),
+                  static_cast<unsigned long>(
+                      (block->exhaustedMs - block->filledMs) / 1000),
+                  static_cast<unsigned long>(block->dose /
+                                             RefillEngine::DOSE_UNITS_PER_CS));
+  }
+}
 
-  snprintf(posText, sizeof(posText), "%.2f", status.encoderTurns);
-  snprintf(tempText, sizeof(tempText), "%.1f C", status.tempC);
+// SHOTS prints the shot statistics, SHOTS|RESET forgets them. Debug
+// commands run in the comms context, so this reads the engine itself.
+void logShotStats(bool reset) {
+  if (reset) {
+    DisplayComms::resetShotStats();
+    Serial.println("PRD_UI: Shot statistics reset");
+    return;
+  }
+  ShotSummary summary;
+  DisplayComms::shotStats().summary(summary);
+  Serial.printf("PRD_UI: %lu shots, %lu out of control, last flags 0x%lx\n",
+                static_cast<unsigned long>(summary.shots),
+                static_cast<unsigned long>(summary.outOfControl),
+                static_cast<unsigned long>(summary.lastFlags));
+  for (int i = 0; i < SHOT_METRIC_COUNT; i++) {
+    const ShotSummary::Metric &metric = summary.metrics[i];
+    Serial.printf("  %-6s n=%lu last=%.3f mean=%.3f sd=%.3f p50=%.3f "
+                  "p95=%.3f\n",
+                  ShotStats::metricName(static_cast<ShotMetric>(i)),
+                  static_cast<unsigned long>(metric.count), metric.last,
+                  metric.mean, metric.stddev, metric.p50, metric.p95);
+  }
+}
 
-  setLabelTextIfChanged(ui.posLabelMain, posText);
-  setLabelTextIfChanged(ui.posLabelMould, posText);
-  setLabelTextIfChanged(ui.posLabelCommon, posText);
+// Prints one page of the mould library index; records stay in flash. GUI
+// task only: put(), remove() and touch() reorder the index under it.
+void logMouldPage(int first) {
+  constexpr int PAGE_SIZE = 20;
+  const MouldLibrary::Entry *page[PAGE_SIZE];
+  int n = MouldLibrary::page(first, page, PAGE_SIZE);
+  Serial.printf("PRD_UI: Moulds %d-%d of %d\n", first, first + n - 1,
+                MouldLibrary::count());
+  for (int i = 0; i < n; i++) {
+    Serial.printf("  %4d id=%lu used=%lu %s\n", first + i,
+                  static_cast<unsigned long>(page[i]->id),
+                  static_cast<unsigned long>(page[i]->lastUsed),
+                  page[i]->name);
+  }
+}
+
+void onMainErrorChanged(lv_observer_t *observer, lv_subject_t *) {
+  lv_obj_t *label = lv_observer_get_target_obj(observer);
+  const DisplayComms::Status &status = UiModel::lastStatus();
+  if (!hasMachineError(status)) {
+    setLabelTextIfChanged(label, "");
+    StyleCache::setHidden(label, true);
+    return;
+  }
+  char text[120];
+  if (status.errorMsg[0] != '\0') {
+    snprintf(text, sizeof(text), "ERROR 0x%X: %s", status.errorCode,
+             status.errorMsg);
+  } else {
+    snprintf(text, sizeof(text), "ERROR 0x%X", status.errorCode);
+  }
+  // Unhide first: hidden labels skip text updates.
+  StyleCache::setHidden(label, false);
+  setLabelTextIfChanged(label, text);
+}
 
-  setLabelTextIfChanged(ui.tempLabelMain, tempText);
-  setLabelTextIfChanged(ui.tempLabelMould, tempText);
-  setLabelTextIfChanged(ui.tempLabelCommon, tempText);
+// Left readouts bind to fixed-point subjects; user data is the number of
+// decimals, and the subject holds the value scaled by 10^decimals. Only the
+// digits that changed are redrawn.
+void onReadoutChanged(lv_observer_t *observer, lv_subject_t *subject) {
+  int decimals = static_cast<int>(
+      reinterpret_cast<intptr_t>(lv_observer_get_user_data(observer)));
+  float scale = decimals == 2 ? 100.0f : 10.0f;
+  NumericReadout::setValue(lv_observer_get_target_obj(observer),
+                           lv_subject_get_int(subject) / scale, decimals);
 }
 
 void onNavigate(lv_event_t *event) {
@@ -552,9 +985,9 @@ void onStateActionQueryState(lv_event_t *) { DisplayComms::sendQueryState(); }
 void onStateActionQueryError(lv_event_t *) { DisplayComms::sendQueryError(); }
 
 void onMouldProfileSelect(lv_event_t *event) {
-  int index = static_cast<int>(
-      reinterpret_cast<intptr_t>(lv_event_get_user_data(event)));
-  if (index < 0 || index >= ui.mouldProfileCount) {
+  int row = VirtualList::rowIndex(lv_event_get_current_target_obj(event));
+  int index = MouldSearch::result(row);
+  if (index < 0 || index >= MouldLibrary::count()) {
     return;
   }
 
@@ -565,22 +998,9 @@ void onMouldProfileSelect(lv_event_t *event) {
   ui.lastTapMs = now;
   ui.selectedMould = index;
 
-  for (int i = 0; i < ui.mouldProfileCount; i++) {
-    if (!ui.mouldProfileButtons[i]) {
-      continue;
-    }
-    if (i == ui.selectedMould) {
-      lv_obj_set_style_bg_color(ui.mouldProfileButtons[i],
-                                lv_color_hex(0x2d7dd2),
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-    } else {
-      // Index 0 has a distinct "Current" base color
-      lv_color_t baseColor =
-          (i == 0) ? lv_color_hex(0x2e4a3e) : lv_color_hex(0x26303a);
-      lv_obj_set_style_bg_color(ui.mouldProfileButtons[i], baseColor,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-    }
-  }
+  // Rows diff their colour, so only the old and new selection repaint.
+  VirtualList::refreshAll(ui.mouldList);
+  syncMouldSendEditEnablement();
 
   if (isDoubleTap) {
     setNotice(ui.mouldNotice, "Edit flow pending: use Send for now.");
@@ -589,7 +1009,7 @@ void onMouldProfileSelect(lv_event_t *event) {
 
 void syncMouldSendEditEnablement() {
   bool hasSelection =
-      ui.selectedMould >= 0 && ui.selectedMould < ui.mouldProfileCount;
+      ui.selectedMould >= 0 && ui.selectedMould < MouldLibrary::count();
   setButtonEnabled(ui.mouldButtonEdit, hasSelection);
   setButtonEnabled(ui.mouldButtonSend,
                    hasSelection && DisplayComms::isSafeForUpdate());
@@ -605,101 +1025,208 @@ void syncMouldEditSaveEnablement() {
   }
 }
 
+lv_obj_t *createMouldRow(lv_obj_t *list) {
+  lv_obj_t *button =
+      createButton(list, "", 8, 0, 286, 46, onMouldProfileSelect);
+  UiStyles::apply(button, UiStyles::ROW);
+  return button;
+}
+
+// `result` indexes the search view; `index` is its library position.
+void bindMouldRow(lv_obj_t *row, int result) {
+  int index = MouldSearch::result(result);
+  // Rows show index entries only; no parameter record is read.
+  const MouldLibrary::Entry *entry = MouldLibrary::entry(index);
+  if (!entry) {
+    return;
+  }
+  char nameBuf[48];
+  const char *name = entry->name[0] != '\0' ? entry->name : "Unnamed Mould";
+  if (index == 0) {
+    snprintf(nameBuf, sizeof(nameBuf), "(Current) %s", name);
+  } else {
+    snprintf(nameBuf, sizeof(nameBuf), "%s", name);
+  }
+  setLabelTextIfChanged(lv_obj_get_child(row, 0), nameBuf);
+
+  // Index 0 has a distinct "Current" base color; selection wins over it.
+  StyleCache::setState(row, UiStyles::ROW_CURRENT, index == 0);
+  StyleCache::setState(row, UiStyles::ROW_SELECTED,
+                       index == ui.selectedMould);
+}
+
+// The list is a fixed pool of recycled rows (see createMouldPanel) showing
+// the current search results. This re-binds the visible rows, and each bind
+// writes only what changed, so adding, renaming or deleting a profile
+// touches the affected rows only.
 void rebuildMouldList() {
   if (!ui.mouldList) {
     return;
   }
 
-  lv_obj_clean(ui.mouldList);
+  if (ui.selectedMould >= MouldLibrary::count()) {
+    ui.selectedMould = -1;
+  }
+  MouldSearch::refresh();
+  VirtualList::setCount(ui.mouldList, MouldSearch::resultCount());
+  VirtualList::refreshAll(ui.mouldList);
+  syncMouldSendEditEnablement();
+}
 
-  for (int i = 0; i < MAX_MOULD_PROFILES; i++) {
-    ui.mouldProfileButtons[i] = nullptr;
+// Library writes are queued; the notice says so until they reach flash.
+void awaitStorage(const char *pendingText, const char *doneText) {
+  if (!StorageWorker::running()) {
+    setNotice(ui.mouldNotice, doneText, UiStyles::NOTICE_OK);
+    return;
   }
+  ui.storageTicket = StorageWorker::lastTicket();
+  ui.storageDoneText = doneText;
+  setNotice(ui.mouldNotice, pendingText);
+}
 
-  int y = 8;
-  for (int i = 0; i < ui.mouldProfileCount; i++) {
-    char nameBuf[48];
-    const char *name = ui.mouldProfiles[i].name[0] != '\0'
-                           ? ui.mouldProfiles[i].name
-                           : "Unnamed Mould";
+void pollStorage() {
+  MouldLibrary::flush();
+  StorageWorker::Report report;
+  if (!StorageWorker::takeReport(report)) {
+    return;
+  }
+  Serial.printf("PRD_UI: Storage batch %s: %u requests -> %u writes in %lu "
+                "ms (stalls %lu)\n",
+                report.ok ? "ok" : "FAILED", report.requests, report.writes,
+                static_cast<unsigned long>(report.ms),
+                static_cast<unsigned long>(StorageWorker::stallCount()));
+  if (ui.storageTicket == 0 ||
+      static_cast<int32_t>(report.ticket - ui.storageTicket) < 0) {
+    return;
+  }
+  if (MouldLibrary::writesDeferred()) {
+    // Part of the save is still waiting for the table; it gets a later
+    // ticket once flush() queues it.
+    ui.storageTicket = StorageWorker::lastTicket();
+    return;
+  }
+  if (report.ok) {
+    setNotice(ui.mouldNotice, ui.storageDoneText, UiStyles::NOTICE_OK);
+  } else {
+    setNotice(ui.mouldNotice, "Failed to save profile.",
+              UiStyles::NOTICE_ALERT);
+  }
+  ui.storageTicket = 0;
+}
 
-    if (i == 0) {
-      snprintf(nameBuf, sizeof(nameBuf), "(Current) %s", name);
-    } else {
-      snprintf(nameBuf, sizeof(nameBuf), "%s", name);
-    }
+// EXPORT|path and IMPORT|path move the whole library to or from the SD
+// card, or LittleFS when there is no card. The extension picks the format.
+// Runs in loop(), so it only queues the command for tick().
+void handleTransferCommand(bool import, const char *path) {
+  if (!path) {
+    path = "/moulds.csv";
+  }
+  if (strlen(path) >= sizeof(ui.transferPath)) {
+    Serial.println("PRD_UI: Transfer path too long");
+    return;
+  }
+  bool queued = false;
+  portENTER_CRITICAL(&transferLock);
+  if (!ui.transferPending) {
+    strcpy(ui.transferPath, path);
+    ui.transferImport = import;
+    ui.transferPending = true;
+    queued = true;
+  }
+  portEXIT_CRITICAL(&transferLock);
+  if (!queued) {
+    Serial.println("PRD_UI: A transfer is already queued");
+  }
+}
 
-    lv_obj_t *button =
-        createButton(ui.mouldList, nameBuf, 8, y, 286, 46, onMouldProfileSelect,
-                     reinterpret_cast<void *>(static_cast<intptr_t>(i)));
-    if (button) {
-      lv_color_t baseColor =
-          (i == 0) ? lv_color_hex(0x2e4a3e) : lv_color_hex(0x26303a);
-      lv_obj_set_style_bg_color(button, baseColor,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-      lv_obj_set_style_border_width(button, 1, LV_PART_MAIN | LV_STATE_DEFAULT);
-      lv_obj_set_style_border_color(button, lv_color_hex(0x41505f),
-                                    LV_PART_MAIN | LV_STATE_DEFAULT);
-      ui.mouldProfileButtons[i] = button;
-    }
-    y += 54;
+void startQueuedTransfer() {
+  char path[sizeof(ui.transferPath)];
+  bool import = false;
+  portENTER_CRITICAL(&transferLock);
+  bool pending = ui.transferPending;
+  if (pending) {
+    memcpy(path, ui.transferPath, sizeof(path));
+    import = ui.transferImport;
+    ui.transferPending = false;
+  }
+  portEXIT_CRITICAL(&transferLock);
+  if (!pending) {
+    return;
+  }
+  if (!ui.libraryLoaded) {
+    Serial.println("PRD_UI: Mould library not loaded yet");
+    return;
+  }
+  fs::FS *fs = &LittleFS;
+  if (SdCard::begin()) {
+    fs = &SdCard::fs();
+  } else {
+    Serial.println("PRD_UI: No SD card, using flash");
   }
+  MouldTransfer::Format format = MouldTransfer::formatFor(path);
+  if (import) {
+    MouldTransfer::startImport(*fs, path, format);
+  } else {
+    MouldTransfer::startExport(*fs, path, format);
+  }
+}
 
-  if (ui.selectedMould >= ui.mouldProfileCount) {
-    ui.selectedMould = -1;
+void pollTransfer() {
+  startQueuedTransfer();
+  MouldTransfer::step(TRANSFER_BUDGET_MS);
+  MouldTransfer::Report report;
+  if (MouldTransfer::takeReport(report) && report.import &&
+      report.records) {
+    rebuildMouldList();
+  }
+}
+
+void onMouldSearchEvent(lv_event_t *event) {
+  lv_event_code_t code = lv_event_get_code(event);
+  lv_obj_t *target = lv_event_get_target_obj(event);
+  if (code == LV_EVENT_CLICKED) {
+    showKeyboard(target, nullptr, LV_KEYBOARD_MODE_TEXT_LOWER);
+  } else if (code == LV_EVENT_VALUE_CHANGED) {
+    MouldSearch::setQuery(lv_textarea_get_text(target));
+    rebuildMouldList();
+    lv_obj_scroll_to_y(ui.mouldList, 0, LV_ANIM_OFF);
   }
-  syncMouldSendEditEnablement();
 }
 
 void onMouldSend(lv_event_t *) {
-  if (ui.selectedMould < 0 || ui.selectedMould >= ui.mouldProfileCount) {
-    setNotice(ui.mouldNotice, "Select a mould first.", lv_color_hex(0xfff0a0));
+  if (ui.selectedMould < 0 || ui.selectedMould >= MouldLibrary::count()) {
+    setNotice(ui.mouldNotice, "Select a mould first.", UiStyles::NOTICE_WARN);
     return;
   }
   if (!DisplayComms::isSafeForUpdate()) {
     setNotice(ui.mouldNotice, "Unsafe machine state for MOULD send.",
-              lv_color_hex(0xffff7a));
+              UiStyles::NOTICE_ALERT);
     return;
   }
 
-  if (DisplayComms::sendMould(ui.mouldProfiles[ui.selectedMould])) {
-    setNotice(ui.mouldNotice, "MOULD command sent.", lv_color_hex(0xff9be7a5));
+  const DisplayComms::MouldParams *profile =
+      MouldLibrary::get(ui.selectedMould);
+  if (profile && DisplayComms::sendMould(*profile)) {
+    MouldLibrary::touch(ui.selectedMould);
+    rebuildMouldList();
+    setNotice(ui.mouldNotice, "MOULD command sent.", UiStyles::NOTICE_OK);
   } else {
     setNotice(ui.mouldNotice, "Failed to send MOULD command.",
-              lv_color_hex(0xffff7a));
+              UiStyles::NOTICE_ALERT);
   }
 }
 
 // ... Mould Edit Implementation ...
 
-void showMouldEditKeyboard(lv_obj_t *textarea) {
-  Serial.print("PRD_UI: showMouldEditKeyboard for ");
-  Serial.println((uintptr_t)textarea, HEX);
-  intptr_t index = reinterpret_cast<intptr_t>(lv_obj_get_user_data(textarea));
-  Serial.printf("PRD_UI: Mould Field index = %d\n", (int)index);
-
-  if (index < 0 || index >= MOULD_FIELD_COUNT) {
-    Serial.println("PRD_UI: ERROR - Mould field index out of bounds!");
-    return;
-  }
-
-  lv_keyboard_mode_t mode = (MOULD_FIELD_TYPE[index] == 0)
-                                ? LV_KEYBOARD_MODE_TEXT_LOWER
-                                : LV_KEYBOARD_MODE_NUMBER;
-  showKeyboard(textarea, ui.mouldEditScroll, mode);
-}
-
-void onMouldEditInputFocus(lv_event_t *event) {
-  lv_event_code_t code = lv_event_get_code(event);
-  lv_obj_t *target = lv_event_get_target_obj(event);
-  // Only trigger on CLICKED to avoid re-entry hangs from focus shifts
-  if (code == LV_EVENT_CLICKED) {
-    Serial.printf("PRD_UI: onMouldEditInputFocus CLICKED.\n");
-    showMouldEditKeyboard(target);
+void onMouldEditFieldEdit(lv_obj_t *grid, int row, lv_obj_t *editor) {
+  if (MOULD_FIELDS[row].type == PropertyGrid::TEXT) {
+    showKeyboard(editor, grid, LV_KEYBOARD_MODE_TEXT_LOWER);
+  } else {
+    showKeypad(editor, grid, MOULD_FIELDS[row]);
   }
 }
 
-void onMouldEditFieldChanged(lv_event_t *event) {
+void onMouldEditFieldChanged(lv_obj_t *, int) {
   if (ui.inMouldEditPopulation)
     return;
   ui.mouldEditDirty = true;
@@ -712,39 +1239,35 @@ void onMouldEditCancel(lv_event_t *) {
   if (isObjReady(ui.sharedKeyboard)) {
     lv_obj_set_parent(ui.sharedKeyboard, lv_layer_top());
   }
-  // Destroy panel to free memory
+  // The form is two objects; keep it for the next edit.
   if (ui.rightPanelMouldEdit) {
-    lv_obj_delete_async(ui.rightPanelMouldEdit);
-    ui.rightPanelMouldEdit = nullptr;
-    ui.mouldEditScroll = nullptr;
-    for (int i = 0; i < MOULD_FIELD_COUNT; i++)
-      ui.mouldEditInputs[i] = nullptr;
+    lv_obj_add_flag(ui.rightPanelMouldEdit, LV_OBJ_FLAG_HIDDEN);
   }
   lv_obj_clear_flag(ui.rightPanelMould, LV_OBJ_FLAG_HIDDEN);
-  Serial.printf("PRD_UI: MouldEditPanel Destroyed (Cancel). Heap: %d\n",
+  Serial.printf("PRD_UI: MouldEditPanel hidden (Cancel). Heap: %d\n",
                 ESP.getFreeHeap());
 }
 
 void onMouldEditSave(lv_event_t *) {
   hideKeyboard();
 
-  // Save inputs back to snapshot -> ui.mouldProfiles
-  DisplayComms::MouldParams &p = ui.mouldProfiles[ui.selectedMould];
+  // Save inputs into a copy of the stored record; it is written back only
+  // if it validates.
+  const DisplayComms::MouldParams *stored =
+      MouldLibrary::get(ui.selectedMould);
+  if (!stored) {
+    setNotice(ui.mouldNotice, "Profile could not be read.",
+              UiStyles::NOTICE_ALERT);
+    return;
+  }
+  DisplayComms::MouldParams p = *stored;
 
   for (int i = 0; i < MOULD_FIELD_COUNT; i++) {
-    lv_obj_t *input = ui.mouldEditInputs[i];
-    if (!input)
-      continue;
-
-    if (i == 13) {
-      int idx = lv_dropdown_get_selected(input);
-      strcpy(p.mode, (idx == 1) ? "3D" : "2D");
+    const char *txt = PropertyGrid::value(ui.mouldEditGrid, i);
+    if (i == MOULD_FIELD_MODE) {
+      strcpy(p.mode, strcmp(txt, "3D") == 0 ? "3D" : "2D");
     } else {
-      const char *txt = lv_textarea_get_text(input);
-      if (!txt)
-        continue;
-
-      if (i == 0) {
+      if (i == MOULD_FIELD_NAME) {
         strncpy(p.name, txt, sizeof(p.name) - 1);
         p.name[sizeof(p.name) - 1] = 0;
       } else {
@@ -810,33 +1333,28 @@ void onMouldEditSave(lv_event_t *) {
     setNotice(ui.mouldNotice,
               is3D ? "3D requires Inject Torque > 0"
                    : "2D requires Fill Volume/Speed > 0",
-              lv_color_hex(0xffff7a));
+              UiStyles::NOTICE_ALERT);
     return;
   }
 
-  Storage::saveMoulds(ui.mouldProfiles, ui.mouldProfileCount);
+  if (!MouldLibrary::put(ui.selectedMould, p)) {
+    setNotice(ui.mouldNotice, "Failed to save profile.",
+              UiStyles::NOTICE_ALERT);
+    return;
+  }
+  MouldLibrary::touch(ui.selectedMould);
   ui.mouldEditDirty = false;
   syncMouldEditSaveEnablement();
 
-  // Hide the panel first to show the underlying list immediately
   if (ui.rightPanelMouldEdit) {
     lv_obj_add_flag(ui.rightPanelMouldEdit, LV_OBJ_FLAG_HIDDEN);
   }
 
-  // Destroy panel async
-  if (ui.rightPanelMouldEdit) {
-    lv_obj_delete_async(ui.rightPanelMouldEdit);
-    ui.rightPanelMouldEdit = nullptr;
-    ui.mouldEditScroll = nullptr;
-    for (int i = 0; i < MOULD_FIELD_COUNT; i++)
-      ui.mouldEditInputs[i] = nullptr;
-  }
-
   // Refresh list and show it
   rebuildMouldList();
   lv_obj_clear_flag(ui.rightPanelMould, LV_OBJ_FLAG_HIDDEN);
-  setNotice(ui.mouldNotice, "Profile saved.", lv_color_hex(0xff9be7a5));
-  Serial.printf("PRD_UI: MouldEditPanel Destroyed. Heap: %d\n",
+  awaitStorage("Saving profile...", "Profile saved.");
+  Serial.printf("PRD_UI: MouldEditPanel hidden (Save). Heap: %d\n",
                 ESP.getFreeHeap());
 }
 
@@ -844,8 +1362,8 @@ void onMouldEdit(lv_event_t *) {
   if (ui.inMouldEditPopulation)
     return;
 
-  if (ui.selectedMould < 0 || ui.selectedMould >= ui.mouldProfileCount) {
-    setNotice(ui.mouldNotice, "Select a mould first.", lv_color_hex(0xfff0a0));
+  if (ui.selectedMould < 0 || ui.selectedMould >= MouldLibrary::count()) {
+    setNotice(ui.mouldNotice, "Select a mould first.", UiStyles::NOTICE_WARN);
     return;
   }
 
@@ -853,10 +1371,10 @@ void onMouldEdit(lv_event_t *) {
   if (!isObjReady(ui.rightPanelMouldEdit)) {
     Serial.printf("PRD_UI: onMouldEdit - Creating panel. Heap: %d\n",
                   ESP.getFreeHeap());
-    // Clear inputs array explicitly
-    for (int i = 0; i < MOULD_FIELD_COUNT; i++)
-      ui.mouldEditInputs[i] = nullptr;
+    uint32_t heapBefore = ESP.getFreeHeap();
     createMouldEditPanel();
+    ui.mouldEditCost = heapUsedSince(heapBefore);
+    PanelPool::addCost(PANEL_MOULD, static_cast<int32_t>(ui.mouldEditCost));
   }
 
   if (!isObjReady(ui.rightPanelMouldEdit)) {
@@ -866,25 +1384,27 @@ void onMouldEdit(lv_event_t *) {
 
   // Populate fields
   ui.inMouldEditPopulation = true;
-  DisplayComms::MouldParams &p = ui.mouldProfiles[ui.selectedMould];
+  const DisplayComms::MouldParams *stored =
+      MouldLibrary::get(ui.selectedMould);
+  if (!stored) {
+    ui.inMouldEditPopulation = false;
+    setNotice(ui.mouldNotice, "Profile could not be read.",
+              UiStyles::NOTICE_ALERT);
+    return;
+  }
+  const DisplayComms::MouldParams p = *stored;
   Serial.printf("PRD_UI: Populating fields for mould %d (%s)\n",
                 ui.selectedMould, p.name);
 
   for (int i = 0; i < MOULD_FIELD_COUNT; i++) {
-    lv_obj_t *input = ui.mouldEditInputs[i];
-    if (!isObjReady(input)) {
-      Serial.printf("PRD_UI: Population field %d - NOT READY\n", i);
-      continue;
-    }
-
-    if (i == 13) {
-      int dropdownIdx = (p.mode[0] == '3') ? 1 : 0;
-      lv_dropdown_set_selected(input, dropdownIdx);
+    if (i == MOULD_FIELD_MODE) {
+      PropertyGrid::setValue(ui.mouldEditGrid, i,
+                             p.mode[0] == '3' ? "3D" : "2D");
     } else {
-      char buf[32] = {0};
-      if (MOULD_FIELD_TYPE[i] == 0) { // String
-        snprintf(buf, sizeof(buf), "%s", (i == 0) ? p.name : "");
-      } else { // Float
+      char buf[PropertyGrid::VALUE_SIZE] = {0};
+      if (i == MOULD_FIELD_NAME) {
+        snprintf(buf, sizeof(buf), "%s", p.name);
+      } else {
         float val = 0.0f;
         switch (i) {
         case 1:
@@ -930,8 +1450,7 @@ void onMouldEdit(lv_event_t *) {
         snprintf(buf, sizeof(buf), "%.2f", val);
       }
 
-      Serial.printf("PRD_UI: Field %d (%p) -> '%s'\n", i, input, buf);
-      lv_textarea_set_text(input, buf);
+      PropertyGrid::setValue(ui.mouldEditGrid, i, buf);
     }
   }
 
@@ -946,14 +1465,14 @@ void onMouldEdit(lv_event_t *) {
 }
 
 void onMouldNew(lv_event_t *) {
-  if (ui.mouldProfileCount >= MAX_MOULD_PROFILES) {
-    setNotice(ui.mouldNotice, "Profile limit reached.", lv_color_hex(0xffff7a));
+  if (MouldLibrary::count() >= MouldLibrary::MAX_PROFILES) {
+    setNotice(ui.mouldNotice, "Profile limit reached.", UiStyles::NOTICE_ALERT);
     return;
   }
 
   DisplayComms::MouldParams newProfile = {};
   snprintf(newProfile.name, sizeof(newProfile.name), "Local %d",
-           ui.mouldProfileCount + 1);
+           MouldLibrary::count() + 1);
   newProfile.mode[0] = '2';
   newProfile.mode[1] = 'D';
   newProfile.mode[2] = '\0';
@@ -973,12 +1492,13 @@ void onMouldNew(lv_event_t *) {
   newProfile.packDecel = 100.0f;
   newProfile.injectTorque = 0.5f;
 
-  ui.mouldProfiles[ui.mouldProfileCount] = newProfile;
-  ui.mouldProfileCount++;
+  if (MouldLibrary::add(newProfile) < 0) {
+    setNotice(ui.mouldNotice, "Failed to save profile.",
+              UiStyles::NOTICE_ALERT);
+    return;
+  }
   rebuildMouldList();
-  Storage::saveMoulds(ui.mouldProfiles, ui.mouldProfileCount);
-  setNotice(ui.mouldNotice, "Created local mould profile.",
-            lv_color_hex(0xff9be7a5));
+  awaitStorage("Creating profile...", "Created local mould profile.");
 }
 
 void onMouldDeleteReal(lv_event_t *) {
@@ -986,17 +1506,12 @@ void onMouldDeleteReal(lv_event_t *) {
     lv_obj_add_flag(ui.mouldDeleteOverlay, LV_OBJ_FLAG_HIDDEN);
   }
 
-  if (ui.selectedMould < 0 || ui.selectedMould >= ui.mouldProfileCount) {
+  if (ui.selectedMould < 0 || ui.selectedMould >= MouldLibrary::count()) {
     return;
   }
 
   const int removeIndex = ui.selectedMould;
-  for (int i = removeIndex; i < ui.mouldProfileCount - 1; i++) {
-    ui.mouldProfiles[i] = ui.mouldProfiles[i + 1];
-  }
-  if (ui.mouldProfileCount > 0) {
-    ui.mouldProfileCount--;
-  }
+  MouldLibrary::remove(removeIndex);
 
   if (removeIndex == 0) {
     ui.lastMouldName[0] = '\0';
@@ -1005,8 +1520,7 @@ void onMouldDeleteReal(lv_event_t *) {
   ui.selectedMould = -1;
   ui.lastTappedMould = -1;
   rebuildMouldList();
-  Storage::saveMoulds(ui.mouldProfiles, ui.mouldProfileCount);
-  setNotice(ui.mouldNotice, "Profile deleted.", lv_color_hex(0xff9be7a5));
+  awaitStorage("Deleting profile...", "Profile deleted.");
 }
 
 void onMouldDeleteCancel(lv_event_t *) {
@@ -1016,8 +1530,8 @@ void onMouldDeleteCancel(lv_event_t *) {
 }
 
 void onMouldDelete(lv_event_t *) {
-  if (ui.selectedMould < 0 || ui.selectedMould >= ui.mouldProfileCount) {
-    setNotice(ui.mouldNotice, "Select a mould first.", lv_color_hex(0xfff0a0));
+  if (ui.selectedMould < 0 || ui.selectedMould >= MouldLibrary::count()) {
+    setNotice(ui.mouldNotice, "Select a mould first.", UiStyles::NOTICE_WARN);
     return;
   }
 
@@ -1043,7 +1557,7 @@ void onMouldDelete(lv_event_t *) {
     lv_obj_align(l, LV_ALIGN_TOP_MID, 0, 10);
 
     lv_obj_t *name = lv_label_create(box);
-    lv_label_set_text(name, ui.mouldProfiles[ui.selectedMould].name);
+    lv_label_set_text(name, MouldLibrary::entry(ui.selectedMould)->name);
     lv_obj_set_style_text_color(name, lv_color_hex(0xff9be7a5), 0);
     lv_obj_align(name, LV_ALIGN_TOP_MID, 0, 45);
 
@@ -1055,7 +1569,7 @@ void onMouldDelete(lv_event_t *) {
     // Update name label in case it changed
     lv_obj_t *box = lv_obj_get_child(ui.mouldDeleteOverlay, 0);
     lv_obj_t *name = lv_obj_get_child(box, 1);
-    lv_label_set_text(name, ui.mouldProfiles[ui.selectedMould].name);
+    lv_label_set_text(name, MouldLibrary::entry(ui.selectedMould)->name);
     lv_obj_clear_flag(ui.mouldDeleteOverlay, LV_OBJ_FLAG_HIDDEN);
   }
 }
@@ -1101,7 +1615,7 @@ void assignCommonField(DisplayComms::CommonParams &common, int fieldIndex,
   if (!text) {
     return;
   }
-  if (COMMON_FIELD_IS_INTEGER[fieldIndex]) {
+  if (COMMON_FIELDS[fieldIndex].type == PropertyGrid::INTEGER) {
     uint32_t value = static_cast<uint32_t>(strtoul(text, nullptr, 10));
     switch (fieldIndex) {
     case 2:
@@ -1160,21 +1674,16 @@ void assignCommonField(DisplayComms::CommonParams &common, int fieldIndex,
 }
 
 void syncCommonInputsFromModel(const DisplayComms::CommonParams &common) {
-  ui.suppressCommonEvents = true;
   for (int i = 0; i < COMMON_FIELD_COUNT; i++) {
-    if (!ui.commonInputs[i]) {
-      continue;
-    }
-    char buffer[32];
-    if (COMMON_FIELD_IS_INTEGER[i]) {
+    char buffer[PropertyGrid::VALUE_SIZE];
+    if (COMMON_FIELDS[i].type == PropertyGrid::INTEGER) {
       snprintf(buffer, sizeof(buffer), "%lu",
                static_cast<unsigned long>(commonFieldValue(common, i)));
     } else {
       snprintf(buffer, sizeof(buffer), "%.3f", commonFieldValue(common, i));
     }
-    setTextareaTextIfChanged(ui.commonInputs[i], buffer);
+    PropertyGrid::setValue(ui.commonGrid, i, buffer);
   }
-  ui.suppressCommonEvents = false;
 }
 
 void syncCommonSendEnablement() {
@@ -1186,52 +1695,40 @@ void syncCommonSendEnablement() {
   setButtonEnabled(ui.commonButtonSend, ui.commonDirty);
 }
 
-void onCommonInputFocus(lv_event_t *event) {
-  lv_event_code_t code = lv_event_get_code(event);
-  lv_obj_t *target = lv_event_get_target_obj(event);
-  // Only trigger on CLICKED to avoid re-entry hangs from focus shifts
-  if (code == LV_EVENT_CLICKED) {
-    Serial.printf("PRD_UI: onCommonInputFocus CLICKED.\n");
-    showKeyboard(target, ui.commonScroll, LV_KEYBOARD_MODE_NUMBER);
-  }
+void onCommonFieldEdit(lv_obj_t *grid, int row, lv_obj_t *editor) {
+  showKeypad(editor, grid, COMMON_FIELDS[row]);
 }
 
-void onCommonFieldChanged(lv_event_t *event) {
-  if (ui.suppressCommonEvents) {
-    return;
-  }
-  if (lv_event_get_code(event) == LV_EVENT_VALUE_CHANGED ||
-      lv_event_get_code(event) == LV_EVENT_READY) {
-    ui.commonDirty = true;
-    syncCommonSendEnablement();
-  }
+void onCommonFieldChanged(lv_obj_t *, int) {
+  ui.commonDirty = true;
+  syncCommonSendEnablement();
 }
 
 bool sendCommonFromInputs() {
   if (!DisplayComms::isSafeForUpdate()) {
     setNotice(ui.commonNotice, "Unsafe machine state for COMMON send.",
-              lv_color_hex(0xffff7a));
+              UiStyles::NOTICE_ALERT);
     return false;
   }
 
+  if (!ui.commonGrid) {
+    return false;
+  }
   DisplayComms::CommonParams toSend = DisplayComms::getCommon();
   for (int i = 0; i < COMMON_FIELD_COUNT; i++) {
-    if (!ui.commonInputs[i]) {
-      continue;
-    }
-    assignCommonField(toSend, i, lv_textarea_get_text(ui.commonInputs[i]));
+    assignCommonField(toSend, i, PropertyGrid::value(ui.commonGrid, i));
   }
 
   if (DisplayComms::sendCommon(toSend)) {
     setNotice(ui.commonNotice, "COMMON command sent.",
-              lv_color_hex(0xff9be7a5));
+              UiStyles::NOTICE_OK);
     ui.commonDirty = false;
     syncCommonSendEnablement();
     return true;
   }
 
   setNotice(ui.commonNotice, "Failed to send COMMON command.",
-            lv_color_hex(0xffff7a));
+            UiStyles::NOTICE_ALERT);
   return false;
 }
 
@@ -1273,25 +1770,127 @@ void onCommonDiscardCancel(lv_event_t *) {
   navigateTo(SCREEN_ID_MAIN);
 }
 
-void createLeftReadouts(lv_obj_t *screen, lv_obj_t **posLabel,
-                        lv_obj_t **tempLabel) {
-  *posLabel = lv_label_create(screen);
-  lv_obj_set_pos(*posLabel, LEFT_X, 10);
-  lv_obj_set_size(*posLabel, LEFT_WIDTH, LV_SIZE_CONTENT);
-  lv_obj_set_style_text_align(*posLabel, LV_TEXT_ALIGN_CENTER,
-                              LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_text_font(*posLabel, &lv_font_montserrat_16,
-                             LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_label_set_text(*posLabel, "-- cm3");
+// Panel observers below are bound with lv_subject_add_observer_obj(), so
+// they run once when bound (syncing a freshly built panel) and are removed
+// with the widget when its panel is evicted.
+void onStateChanged(lv_observer_t *, lv_subject_t *) {
+  updateStateWidgets(UiModel::lastStatus());
+}
 
-  *tempLabel = lv_label_create(screen);
-  lv_obj_set_pos(*tempLabel, LEFT_X, 770);
-  lv_obj_set_size(*tempLabel, LEFT_WIDTH, LV_SIZE_CONTENT);
-  lv_obj_set_style_text_align(*tempLabel, LV_TEXT_ALIGN_CENTER,
-                              LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_text_font(*tempLabel, &lv_font_montserrat_16,
-                             LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_label_set_text(*tempLabel, "--.- C");
+// User data is the DisplayComms::Received bit the target widget shows.
+void onStaleChanged(lv_observer_t *observer, lv_subject_t *subject) {
+  uint32_t part = static_cast<uint32_t>(
+      reinterpret_cast<uintptr_t>(lv_observer_get_user_data(observer)));
+  uint32_t stale = static_cast<uint32_t>(lv_subject_get_int(subject));
+  StyleCache::setState(lv_observer_get_target_obj(observer), UiStyles::STALE,
+                       (stale & part) != 0);
+}
+
+// Only the parts the Main panel shows; stored profiles read the same.
+void onStaleNoticeChanged(lv_observer_t *observer, lv_subject_t *subject) {
+  uint32_t shown = DisplayComms::RX_ENC | DisplayComms::RX_TEMP |
+                   DisplayComms::RX_STATE;
+  uint32_t stale = static_cast<uint32_t>(lv_subject_get_int(subject));
+  StyleCache::setHidden(lv_observer_get_target_obj(observer),
+                        (stale & shown) == 0);
+}
+
+// Mean, spread and 95th percentile per metric; the tone turns to warning
+// while the last shot is out of control.
+void onShotsChanged(lv_observer_t *observer, lv_subject_t *) {
+  const ShotSummary &shots = ui.shots;
+  lv_obj_t *label = lv_observer_get_target_obj(observer);
+  if (shots.shots == 0) {
+    setNotice(label, "No shots yet.");
+    return;
+  }
+  const ShotSummary::Metric &cycle = shots.metrics[SHOT_CYCLE];
+  const ShotSummary::Metric &fill = shots.metrics[SHOT_FILL];
+  const ShotSummary::Metric &volume = shots.metrics[SHOT_VOLUME];
+  char text[224];
+  int n = snprintf(text, sizeof(text),
+                   "Shots %lu, %lu out of control\n"
+                   "Cycle %.1f s  sd %.2f  p95 %.1f\n"
+                   "Fill %.2f s  sd %.2f  p95 %.2f\n"
+                   "Volume %.2f cm3  sd %.2f  p95 %.2f",
+                   static_cast<unsigned long>(shots.shots),
+                   static_cast<unsigned long>(shots.outOfControl),
+                   cycle.mean, cycle.stddev, cycle.p95, fill.mean,
+                   fill.stddev, fill.p95, volume.mean, volume.stddev,
+                   volume.p95);
+  if (shots.lastFlags && n > 0 && n < static_cast<int>(sizeof(text))) {
+    snprintf(text + n, sizeof(text) - n, "\nLast shot out of control:%s%s%s",
+             (shots.lastFlags & (1u << SHOT_CYCLE)) ? " cycle" : "",
+             (shots.lastFlags & (1u << SHOT_FILL)) ? " fill" : "",
+             (shots.lastFlags & (1u << SHOT_VOLUME)) ? " volume" : "");
+  }
+  setNotice(label, text, shots.lastFlags ? UiStyles::NOTICE_WARN : 0);
+}
+
+// Shown while any block in the barrel is over RefillEngine::DOSE_LIMIT.
+void onDoseNoticeChanged(lv_observer_t *observer, lv_subject_t *) {
+  StyleCache::setHidden(lv_observer_get_target_obj(observer),
+                        ui.overdosedBlocks == 0);
+}
+
+void observeStale(lv_obj_t *obj, uint32_t part) {
+  UiStyles::apply(obj, UiStyles::READOUT);
+  lv_subject_add_observer_obj(&UiModel::stale, onStaleChanged, obj,
+                              reinterpret_cast<void *>(part));
+}
+
+void onMouldModelChanged(lv_observer_t *, lv_subject_t *) {
+  updateMouldListFromComms(UiModel::lastMould());
+}
+
+void onSafeStateChanged(lv_observer_t *, lv_subject_t *) {
+  syncMouldSendEditEnablement();
+}
+
+void onCommonModelChanged(lv_observer_t *, lv_subject_t *) {
+  if (!ui.commonDirty) {
+    syncCommonInputsFromModel(UiModel::lastCommon());
+  }
+}
+
+void placeLeftReadout(lv_obj_t *readout, lv_coord_t y) {
+  if (!readout) {
+    return;
+  }
+  lv_obj_update_layout(readout);
+  StyleCache::setPos(readout,
+                     LEFT_X + (LEFT_WIDTH - lv_obj_get_width(readout)) / 2, y);
+}
+
+void createLeftReadouts(lv_obj_t *screen, lv_obj_t **posReadout,
+                        lv_obj_t **tempReadout) {
+  // "-360.00" and "1234.5 C" fit without truncation.
+  *posReadout = NumericReadout::create(screen, &lv_font_montserrat_16, 7);
+  placeLeftReadout(*posReadout, 10);
+  NumericReadout::setText(*posReadout, "--");
+
+  *tempReadout =
+      NumericReadout::create(screen, &lv_font_montserrat_16, 6, " C");
+  placeLeftReadout(*tempReadout, 770);
+  NumericReadout::setText(*tempReadout, "--.-");
+}
+
+// Move the shared left column onto `screen`. The plunger goes first so the
+// readouts stay on top of it.
+void attachLeftColumn(lv_obj_t *screen) {
+  if (!screen) {
+    return;
+  }
+  lv_obj_t *column[] = {ui.plunger, ui.posReadout, ui.tempReadout};
+  for (lv_obj_t *obj : column) {
+    if (obj && lv_obj_get_parent(obj) != screen) {
+      lv_obj_set_parent(obj, screen);
+    }
+  }
+}
+
+void onScreenLoadStart(lv_event_t *event) {
+  attachLeftColumn(lv_event_get_target_obj(event));
 }
 
 void createMainPanel() {
@@ -1301,8 +1900,7 @@ void createMainPanel() {
   }
   lv_obj_t *title = lv_label_create(ui.rightPanelMain);
   lv_obj_set_pos(title, 18, 12);
-  lv_obj_set_style_text_font(title, &lv_font_montserrat_24,
-                             LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(title, UiStyles::TITLE);
   lv_obj_set_style_text_color(title, lv_color_hex(0xffffffff),
                               LV_PART_MAIN | LV_STATE_DEFAULT);
   lv_label_set_text(title, "Main");
@@ -1327,6 +1925,37 @@ void createMainPanel() {
                                  150, 52, onStateActionQueryState);
   ui.stateAction2 = createButton(ui.rightPanelMain, "Refresh Error", 182, 235,
                                  150, 52, onStateActionQueryError);
+  lv_subject_add_observer_obj(&UiModel::state, onStateChanged, ui.stateValue,
+                              nullptr);
+  observeStale(ui.stateValue, DisplayComms::RX_STATE);
+
+  lv_obj_t *staleNotice = lv_label_create(ui.rightPanelMain);
+  lv_obj_set_pos(staleNotice, 18, 305);
+  lv_obj_set_width(staleNotice, RIGHT_WIDTH - 36);
+  lv_label_set_long_mode(staleNotice, LV_LABEL_LONG_WRAP);
+  UiStyles::apply(staleNotice, UiStyles::NOTICE);
+  setNotice(staleNotice, "Showing last known values, waiting for controller.",
+            UiStyles::NOTICE_WARN);
+  lv_subject_add_observer_obj(&UiModel::stale, onStaleNoticeChanged,
+                              staleNotice, nullptr);
+
+  lv_obj_t *doseNotice = lv_label_create(ui.rightPanelMain);
+  lv_obj_set_pos(doseNotice, 18, 360);
+  lv_obj_set_width(doseNotice, RIGHT_WIDTH - 36);
+  lv_label_set_long_mode(doseNotice, LV_LABEL_LONG_WRAP);
+  UiStyles::apply(doseNotice, UiStyles::NOTICE);
+  setNotice(doseNotice, "Material over thermal dose limit, purge before use.",
+            UiStyles::NOTICE_ALERT);
+  lv_subject_add_observer_obj(&UiModel::refill, onDoseNoticeChanged,
+                              doseNotice, nullptr);
+
+  lv_obj_t *shotSummary = lv_label_create(ui.rightPanelMain);
+  lv_obj_set_pos(shotSummary, 18, 420);
+  lv_obj_set_width(shotSummary, RIGHT_WIDTH - 36);
+  lv_label_set_long_mode(shotSummary, LV_LABEL_LONG_WRAP);
+  UiStyles::apply(shotSummary, UiStyles::NOTICE);
+  lv_subject_add_observer_obj(&UiModel::shots, onShotsChanged, shotSummary,
+                              nullptr);
 
   createButton(ui.rightPanelMain, "Mould Settings", 18, 720, 150, 58,
                onNavigate,
@@ -1347,6 +1976,8 @@ void createMainPanel() {
                               LV_PART_MAIN | LV_STATE_DEFAULT);
   lv_label_set_text(ui.mainErrorLabel, "");
   lv_obj_add_flag(ui.mainErrorLabel, LV_OBJ_FLAG_HIDDEN);
+  lv_subject_add_observer_obj(&UiModel::error, onMainErrorChanged,
+                              ui.mainErrorLabel, nullptr);
 }
 
 void createMouldPanel() {
@@ -1357,28 +1988,42 @@ void createMouldPanel() {
 
   lv_obj_t *title = lv_label_create(ui.rightPanelMould);
   lv_obj_set_pos(title, 18, 12);
-  lv_obj_set_style_text_font(title, &lv_font_montserrat_24,
-                             LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(title, UiStyles::TITLE);
   lv_label_set_text(title, "Mould Selection");
 
+  ui.mouldSearch = lv_textarea_create(ui.rightPanelMould);
+  lv_obj_set_pos(ui.mouldSearch, 18, 54);
+  lv_obj_set_size(ui.mouldSearch, RIGHT_WIDTH - 36, 44);
+  lv_textarea_set_one_line(ui.mouldSearch, true);
+  lv_textarea_set_max_length(ui.mouldSearch, MouldSearch::MAX_QUERY);
+  lv_textarea_set_placeholder_text(ui.mouldSearch, "Search moulds");
+  lv_textarea_set_text(ui.mouldSearch, MouldSearch::query());
+  lv_obj_add_event_cb(ui.mouldSearch, onMouldSearchEvent, LV_EVENT_CLICKED,
+                      nullptr);
+  lv_obj_add_event_cb(ui.mouldSearch, onMouldSearchEvent,
+                      LV_EVENT_VALUE_CHANGED, nullptr);
+
   ui.mouldList = lv_obj_create(ui.rightPanelMould);
-  lv_obj_set_pos(ui.mouldList, 18, 54);
-  lv_obj_set_size(ui.mouldList, RIGHT_WIDTH - 36, 530);
-  lv_obj_set_style_bg_color(ui.mouldList, lv_color_hex(0x1a222b),
-                            LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_color(ui.mouldList, lv_color_hex(0x3a4a5a),
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_width(ui.mouldList, 1,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_pad_all(ui.mouldList, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_pos(ui.mouldList, 18, 106);
+  lv_obj_set_size(ui.mouldList, RIGHT_WIDTH - 36, 478);
+  UiStyles::apply(ui.mouldList, UiStyles::LIST);
   lv_obj_set_scrollbar_mode(ui.mouldList, LV_SCROLLBAR_MODE_ACTIVE);
 
+  VirtualList::Config rows;
+  rows.rowPitch = MOULD_ROW_PITCH;
+  rows.topMargin = 8;
+  rows.poolSize = MOULD_ROW_POOL;
+  rows.createRow = createMouldRow;
+  rows.bindRow = bindMouldRow;
+  if (!VirtualList::attach(ui.mouldList, rows)) {
+    Serial.println("PRD_UI: Mould list row pool FAILED");
+  }
+
   ui.mouldNotice = lv_label_create(ui.rightPanelMould);
   lv_obj_set_pos(ui.mouldNotice, 18, 592);
   lv_obj_set_width(ui.mouldNotice, RIGHT_WIDTH - 36);
   lv_label_set_long_mode(ui.mouldNotice, LV_LABEL_LONG_WRAP);
-  lv_obj_set_style_text_color(ui.mouldNotice, lv_color_hex(0xffd6d6d6),
-                              LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(ui.mouldNotice, UiStyles::NOTICE);
   lv_label_set_text(ui.mouldNotice, "Select a profile.");
 
   ui.mouldButtonBack = createButton(
@@ -1392,6 +2037,11 @@ void createMouldPanel() {
       createButton(ui.rightPanelMould, "New", 70, 712, 96, 52, onMouldNew);
   ui.mouldButtonDelete = createButton(ui.rightPanelMould, "Delete", 184, 712,
                                       96, 52, onMouldDelete);
+
+  lv_subject_add_observer_obj(&UiModel::mould, onMouldModelChanged,
+                              ui.mouldList, nullptr);
+  lv_subject_add_observer_obj(&UiModel::safe, onSafeStateChanged,
+                              ui.mouldButtonSend, nullptr);
 }
 
 void createMouldEditPanel() {
@@ -1402,95 +2052,25 @@ void createMouldEditPanel() {
 
   lv_obj_t *title = lv_label_create(ui.rightPanelMouldEdit);
   lv_obj_set_pos(title, 18, 12);
-  lv_obj_set_style_text_font(title, &lv_font_montserrat_24,
-                             LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(title, UiStyles::TITLE);
   lv_label_set_text(title, "Edit Mould");
 
-  ui.mouldEditScroll = lv_obj_create(ui.rightPanelMouldEdit);
-  if (!ui.mouldEditScroll) {
-    Serial.println("PRD_UI: FAILED to create mouldEditScroll");
+  ui.mouldEditGrid = lv_obj_create(ui.rightPanelMouldEdit);
+  if (!ui.mouldEditGrid) {
+    Serial.println("PRD_UI: FAILED to create mouldEditGrid");
     return;
   }
-  lv_obj_set_pos(ui.mouldEditScroll, 18, 54);
-  lv_obj_set_size(ui.mouldEditScroll, RIGHT_WIDTH - 36, 598);
-  lv_obj_set_style_bg_color(ui.mouldEditScroll, lv_color_hex(0x1a222b),
-                            LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_color(ui.mouldEditScroll, lv_color_hex(0x3a4a5a),
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_width(ui.mouldEditScroll, 1,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_pad_all(ui.mouldEditScroll, 6,
-                           LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_scrollbar_mode(ui.mouldEditScroll, LV_SCROLLBAR_MODE_ACTIVE);
-
-  int y = 6;
-  for (int i = 0; i < MOULD_FIELD_COUNT; i++) {
-    lv_obj_t *label = lv_label_create(ui.mouldEditScroll);
-    if (!label) {
-      Serial.printf("PRD_UI: FAILED to create label for mould field %d\n", i);
-      y += 42;
-      continue;
-    }
-    lv_obj_set_pos(label, 4, y + 8);
-    lv_obj_set_size(label, 160, LV_SIZE_CONTENT);
-    lv_label_set_text(label, MOULD_FIELD_NAMES[i]);
-
-    lv_obj_t *input = nullptr;
-    bool isDropdown = (i == 13);
-
-    if (isDropdown) {
-      input = lv_dropdown_create(ui.mouldEditScroll);
-      if (input) {
-        lv_dropdown_set_options(input, "2D\n3D");
-        lv_obj_set_size(input, 130, 42);
-      }
-    } else {
-      input = lv_textarea_create(ui.mouldEditScroll);
-      if (input) {
-        lv_textarea_set_one_line(input, true);
-        lv_textarea_set_max_length(input, (i == 0) ? 20 : 10);
-        const char *accepted =
-            (MOULD_FIELD_TYPE[i] == 0) ? nullptr : "0123456789.-";
-        if (accepted)
-          lv_textarea_set_accepted_chars(input, accepted);
-        lv_textarea_set_text(input, (MOULD_FIELD_TYPE[i] == 0) ? "" : "0");
-        lv_obj_set_style_text_align(input, LV_TEXT_ALIGN_RIGHT,
-                                    LV_PART_MAIN | LV_STATE_DEFAULT);
-        lv_obj_set_size(input, 130, 34);
-      }
-    }
-
-    if (!input) {
-      Serial.printf("PRD_UI: FAILED to create input for field %d\n", i);
-      y += 42;
-      continue;
-    }
-    lv_obj_set_pos(input, 168, y);
-
-    lv_obj_set_user_data(input,
-                         reinterpret_cast<void *>(static_cast<intptr_t>(i)));
-
-    // Only textareas should trigger the on-screen keyboard
-    if (!isDropdown) {
-      lv_obj_add_event_cb(input, onMouldEditInputFocus, LV_EVENT_CLICKED,
-                          nullptr);
-    }
-
-    lv_obj_add_event_cb(input, onMouldEditFieldChanged, LV_EVENT_VALUE_CHANGED,
-                        nullptr);
-
-    if (!isDropdown) {
-      lv_obj_add_event_cb(input, onMouldEditFieldChanged, LV_EVENT_READY,
-                          nullptr);
-      lv_obj_add_event_cb(input, onMouldEditFieldChanged, LV_EVENT_CANCEL,
-                          nullptr);
-    }
-
-    ui.mouldEditInputs[i] = input;
-    Serial.printf("PRD_UI: createMouldEditPanel stored input %d at %p\n", i,
-                  input);
-    y += 42;
+  lv_obj_set_pos(ui.mouldEditGrid, 18, 54);
+  lv_obj_set_size(ui.mouldEditGrid, RIGHT_WIDTH - 36, 598);
+  UiStyles::apply(ui.mouldEditGrid, UiStyles::FORM);
+  lv_obj_set_scrollbar_mode(ui.mouldEditGrid, LV_SCROLLBAR_MODE_ACTIVE);
+  PropertyGrid::Config grid = {MOULD_FIELDS, MOULD_FIELD_COUNT,
+                               onMouldEditFieldEdit, onMouldEditFieldChanged};
+  if (!PropertyGrid::attach(ui.mouldEditGrid, grid)) {
+    Serial.println("PRD_UI: FAILED to attach mould edit grid");
+    return;
   }
+  UiStyles::apply(PropertyGrid::editor(ui.mouldEditGrid), UiStyles::FIELD);
 
   ui.mouldButtonSave = createButton(ui.rightPanelMouldEdit, "Save", 18, 720,
                                     150, 58, onMouldEditSave);
@@ -1509,59 +2089,26 @@ void createCommonPanel() {
 
   lv_obj_t *title = lv_label_create(ui.rightPanelCommon);
   lv_obj_set_pos(title, 18, 12);
-  lv_obj_set_style_text_font(title, &lv_font_montserrat_24,
-                             LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(title, UiStyles::TITLE);
   lv_label_set_text(title, "Common Settings");
 
-  ui.commonScroll = lv_obj_create(ui.rightPanelCommon);
-  lv_obj_set_pos(ui.commonScroll, 18, 54);
-  lv_obj_set_size(ui.commonScroll, RIGHT_WIDTH - 36, 598);
-  lv_obj_set_style_bg_color(ui.commonScroll, lv_color_hex(0x1a222b),
-                            LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_color(ui.commonScroll, lv_color_hex(0x3a4a5a),
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_border_width(ui.commonScroll, 1,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_style_pad_all(ui.commonScroll, 6, LV_PART_MAIN | LV_STATE_DEFAULT);
-  lv_obj_set_scrollbar_mode(ui.commonScroll, LV_SCROLLBAR_MODE_ACTIVE);
-
-  int y = 6;
-  for (int i = 0; i < COMMON_FIELD_COUNT; i++) {
-    lv_obj_t *label = lv_label_create(ui.commonScroll);
-    lv_obj_set_pos(label, 4, y + 8);
-    lv_obj_set_size(label, 160, LV_SIZE_CONTENT);
-    lv_label_set_text(label, COMMON_FIELD_NAMES[i]);
-
-    lv_obj_t *input = lv_textarea_create(ui.commonScroll);
-    lv_obj_set_pos(input, 168, y);
-    lv_obj_set_size(input, 130, 34);
-    lv_textarea_set_one_line(input, true);
-    lv_textarea_set_max_length(input, 20);
-    lv_textarea_set_accepted_chars(
-        input, COMMON_FIELD_IS_INTEGER[i] ? "0123456789" : "0123456789.-");
-    lv_textarea_set_text(input, "0");
-    lv_obj_set_style_text_align(input, LV_TEXT_ALIGN_RIGHT,
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_add_event_cb(input, onCommonInputFocus, LV_EVENT_CLICKED, nullptr);
-    lv_obj_add_event_cb(input, onCommonInputFocus, LV_EVENT_FOCUSED, nullptr);
-    lv_obj_add_event_cb(input, onCommonInputFocus, LV_EVENT_DEFOCUSED, nullptr);
-    lv_obj_add_event_cb(input, onCommonInputFocus, LV_EVENT_READY, nullptr);
-    lv_obj_add_event_cb(input, onCommonInputFocus, LV_EVENT_CANCEL, nullptr);
-    lv_obj_add_event_cb(input, onCommonFieldChanged, LV_EVENT_VALUE_CHANGED,
-                        reinterpret_cast<void *>(static_cast<intptr_t>(i)));
-    lv_obj_add_event_cb(input, onCommonFieldChanged, LV_EVENT_READY,
-                        reinterpret_cast<void *>(static_cast<intptr_t>(i)));
-
-    ui.commonInputs[i] = input;
-    y += 42;
+  ui.commonGrid = lv_obj_create(ui.rightPanelCommon);
+  lv_obj_set_pos(ui.commonGrid, 18, 54);
+  lv_obj_set_size(ui.commonGrid, RIGHT_WIDTH - 36, 598);
+  UiStyles::apply(ui.commonGrid, UiStyles::FORM);
+  lv_obj_set_scrollbar_mode(ui.commonGrid, LV_SCROLLBAR_MODE_ACTIVE);
+  PropertyGrid::Config grid = {COMMON_FIELDS, COMMON_FIELD_COUNT,
+                               onCommonFieldEdit, onCommonFieldChanged};
+  if (!PropertyGrid::attach(ui.commonGrid, grid)) {
+    Serial.println("PRD_UI: createCommonPanel failed to attach grid");
   }
+  UiStyles::apply(PropertyGrid::editor(ui.commonGrid), UiStyles::FIELD);
 
   ui.commonNotice = lv_label_create(ui.rightPanelCommon);
   lv_obj_set_pos(ui.commonNotice, 18, 660);
   lv_obj_set_width(ui.commonNotice, RIGHT_WIDTH - 36);
   lv_label_set_long_mode(ui.commonNotice, LV_LABEL_LONG_WRAP);
-  lv_obj_set_style_text_color(ui.commonNotice, lv_color_hex(0xffd6d6d6),
-                              LV_PART_MAIN | LV_STATE_DEFAULT);
+  UiStyles::apply(ui.commonNotice, UiStyles::NOTICE);
   lv_label_set_text(ui.commonNotice, "Edit and press Send.");
 
   ui.commonButtonBack =
@@ -1571,6 +2118,9 @@ void createCommonPanel() {
 
   ui.commonDiscardOverlay = nullptr; // Feature still disabled
   showCommonDiscardOverlay(false);
+  syncCommonSendEnablement();
+  lv_subject_add_observer_obj(&UiModel::common, onCommonModelChanged,
+                              ui.rightPanelCommon, nullptr);
   Serial.println("PRD_UI: createCommonPanel end");
 } // namespace
 
@@ -1579,21 +2129,8 @@ void updateStateWidgets(const DisplayComms::Status &status) {
   setLabelTextIfChanged(ui.stateValue, stateText);
 
   bool hasState = status.state[0] != '\0';
-  if (hasState) {
-    if (ui.stateAction1) {
-      lv_obj_clear_flag(ui.stateAction1, LV_OBJ_FLAG_HIDDEN);
-    }
-    if (ui.stateAction2) {
-      lv_obj_clear_flag(ui.stateAction2, LV_OBJ_FLAG_HIDDEN);
-    }
-  } else {
-    if (ui.stateAction1) {
-      lv_obj_add_flag(ui.stateAction1, LV_OBJ_FLAG_HIDDEN);
-    }
-    if (ui.stateAction2) {
-      lv_obj_add_flag(ui.stateAction2, LV_OBJ_FLAG_HIDDEN);
-    }
-  }
+  StyleCache::setHidden(ui.stateAction1, !hasState);
+  StyleCache::setHidden(ui.stateAction2, !hasState);
 }
 
 void updateMouldListFromComms(const DisplayComms::MouldParams &mould) {
@@ -1601,9 +2138,8 @@ void updateMouldListFromComms(const DisplayComms::MouldParams &mould) {
     return;
   }
 
-  if (ui.mouldProfileCount == 0) {
-    ui.mouldProfileCount = 1;
-    ui.mouldProfiles[0] = mould;
+  if (MouldLibrary::count() == 0) {
+    MouldLibrary::add(mould);
     strncpy(ui.lastMouldName, mould.name, sizeof(ui.lastMouldName) - 1);
     ui.lastMouldName[sizeof(ui.lastMouldName) - 1] = '\0';
     rebuildMouldList();
@@ -1611,21 +2147,217 @@ void updateMouldListFromComms(const DisplayComms::MouldParams &mould) {
   }
 
   if (strcmp(ui.lastMouldName, mould.name) != 0) {
-    ui.mouldProfiles[0] = mould;
+    MouldLibrary::put(0, mould);
     strncpy(ui.lastMouldName, mould.name, sizeof(ui.lastMouldName) - 1);
     ui.lastMouldName[sizeof(ui.lastMouldName) - 1] = '\0';
     rebuildMouldList();
     return;
   }
 
-  // Keep active profile data fresh even when the name doesn't change.
-  ui.mouldProfiles[0] = mould;
+  // Keep active profile data fresh even when the name doesn't change; put()
+  // writes flash only when the parameters actually differ.
+  MouldLibrary::put(0, mould);
+}
+
+// One refill notification per batch of block changes, however many blocks
+// moved.
+void publishPlungerBlocks() {
+  if (ui.plungerBlocksDirty) {
+    UiModel::bump(&UiModel::refill);
+  }
+}
+
+void buildPanel(int panel) {
+  Serial.printf("PRD_UI: Building %s Panel on demand.\n", PANEL_NAMES[panel]);
+  uint32_t heapBefore = ESP.getFreeHeap();
+  uint32_t startUs = micros();
+  switch (panel) {
+  case PANEL_MAIN:
+    createMainPanel();
+    ui.lastMainScreen = objects.main;
+    break;
+  case PANEL_MOULD:
+    createMouldPanel();
+    rebuildMouldList();
+    ui.lastMouldScreen = objects.mould_settings;
+    break;
+  case PANEL_COMMON:
+    createCommonPanel();
+    ui.lastCommonScreen = objects.common_settings;
+    break;
+  }
+  if (isPanelReady(panel)) {
+    uint32_t cost = heapUsedSince(heapBefore);
+    int objects = countObjects(panelRoot(panel));
+    PanelPool::markBuilt(panel, cost, millis());
+    // Build once with STYLES|LOCAL and once with STYLES|SHARED to compare.
+    Serial.printf("PRD_UI: %s built in %lu us, %lu bytes, %d objects "
+                  "(%lu B/object, %s styles)\n",
+                  PANEL_NAMES[panel],
+                  static_cast<unsigned long>(micros() - startUs),
+                  static_cast<unsigned long>(cost), objects,
+                  static_cast<unsigned long>(cost / objects),
+                  UiStyles::localMode() ? "local" : "shared");
+  }
+}
+
+void finishNavTiming(int panel, bool warm) {
+  if (!ui.navPending) {
+    return;
+  }
+  ui.navPending = false;
+  Serial.printf("PRD_UI: Nav to %s (%s) %lu ms, heap %lu -> %lu, warm %lu\n",
+                PANEL_NAMES[panel], warm ? "warm" : "built",
+                static_cast<unsigned long>(millis() - ui.navStartMs),
+                static_cast<unsigned long>(ui.navHeapBefore),
+                static_cast<unsigned long>(ESP.getFreeHeap()),
+                static_cast<unsigned long>(PanelPool::warmBytes()));
+}
+
+void loadMouldLibrary() {
+  if (ui.libraryLoaded) {
+    return;
+  }
+  ui.libraryLoaded = true;
+  Storage::init();
+  MouldLibrary::begin();
+  // Started after the library so a legacy migration is written in place.
+  StorageWorker::begin();
+
+  if (MouldLibrary::count() == 0) {
+    DisplayComms::MouldParams placeholder = {};
+    strncpy(placeholder.name, "Awaiting QUERY_MOULD",
+            sizeof(placeholder.name) - 1);
+    MouldLibrary::add(placeholder);
+  }
+  BootProfile::mark("mould library");
+}
+
+// Parts a snapshot can stand in for. Errors are only shown alongside the
+// state they were reported in.
+constexpr uint32_t WARM_PARTS =
+    DisplayComms::RX_ENC | DisplayComms::RX_TEMP | DisplayComms::RX_STATE |
+    DisplayComms::RX_MOULD | DisplayComms::RX_COMMON;
+
+// Puts the last saved state back before the first frame: the stored values
+// are published from tick() until the controller replaces them, and the
+// refill stack resumes from the saved blocks.
+void restoreWarmStart() {
+  if (!Storage::init() || !WarmStart::load(ui.warm)) {
+    return;
+  }
+  ui.staleParts = ui.warm.parts & WARM_PARTS;
+  uint32_t now = millis();
+  RefillBlock blocks[WarmStart::MAX_BLOCKS];
+  for (int i = 0; i < ui.warm.blockCount; i++) {
+    const WarmStart::Block &saved = ui.warm.blocks[i];
+    // Time spent powered off is unknown, so ages resume from the save.
+    blocks[i] = RefillBlock(saved.volume, now - saved.ageMs, true);
+    blocks[i].dose = saved.dose;
+  }
+  // init() may run on guiTask; DisplayComms hands this to its engine in
+  // the comms context.
+  DisplayComms::restoreRefill(ui.warm.status.encoderTurns,
+                              ui.warm.status.state, blocks,
+                              ui.warm.blockCount);
+  Serial.printf("PRD_UI: Warm start from snapshot, parts 0x%02lx, %d blocks\n",
+                static_cast<unsigned long>(ui.staleParts),
+                ui.warm.blockCount);
+}
+
+// Live parts replace snapshot parts as each message kind first arrives.
+void reconcileWarmStart(DisplayComms::Status &status,
+                        const DisplayComms::MouldParams *&mould,
+                        const DisplayComms::CommonParams *&common) {
+  uint32_t stale = ui.staleParts & ~DisplayComms::receivedMask();
+  if (stale != ui.staleParts) {
+    ui.staleParts = stale;
+    if (stale == 0) {
+      Serial.printf("PRD_UI: Warm start reconciled at %lu ms\n",
+                    static_cast<unsigned long>(millis()));
+    }
+  }
+  if (lv_subject_get_int(&UiModel::stale) != static_cast<int32_t>(stale)) {
+    lv_subject_set_int(&UiModel::stale, static_cast<int32_t>(stale));
+  }
+  if (stale == 0) {
+    return;
+  }
+  const DisplayComms::Status &saved = ui.warm.status;
+  if (stale & DisplayComms::RX_ENC) {
+    status.encoderTurns = saved.encoderTurns;
+  }
+  if (stale & DisplayComms::RX_TEMP) {
+    status.tempC = saved.tempC;
+  }
+  if (stale & DisplayComms::RX_STATE) {
+    memcpy(status.state, saved.state, sizeof(status.state));
+    status.errorCode = saved.errorCode;
+    memcpy(status.errorMsg, saved.errorMsg, sizeof(status.errorMsg));
+  }
+  if (stale & DisplayComms::RX_MOULD) {
+    mould = &ui.warm.mould;
+  }
+  if (stale & DisplayComms::RX_COMMON) {
+    common = &ui.warm.common;
+  }
+}
+
+static_assert(RefillStack::CAPACITY <= WarmStart::MAX_BLOCKS,
+              "warm-start snapshot can't hold the refill stack");
+
+// Hands the displayed state to WarmStart once a second; it decides whether
+// that is worth a flash write.
+void offerWarmStart() {
+  uint32_t now = millis();
+  if (ui.mockEnabled || now - ui.lastWarmOfferMs < 1000) {
+    return;
+  }
+  ui.lastWarmOfferMs = now;
+  uint32_t parts =
+      (DisplayComms::receivedMask() | ui.staleParts) & WARM_PARTS;
+  if (parts == 0) {
+    return;
+  }
+  WarmStart::Snapshot snapshot = {};
+  snapshot.parts = parts;
+  snapshot.status = UiModel::lastStatus();
+  snapshot.status.encoderSampleMs = 0;
+  snapshot.status.encoderSampleCount = 0;
+  snapshot.mould = UiModel::lastMould();
+  snapshot.common = UiModel::lastCommon();
+  snapshot.blockCount = static_cast<uint8_t>(ui.blockCount);
+  for (int i = 0; i < ui.blockCount; i++) {
+    const RefillBlock &block = ui.blocks[i];
+    snapshot.blocks[i] = {block.volume, now - block.addedMs, block.dose};
+  }
+  WarmStart::offer(snapshot, now);
+}
+
+// Runs on the tick after the first screen and its panel reach the display.
+void finishBoot() {
+  ui.bootPending = false;
+#if FAST_BOOT
+  loadMouldLibrary();
+  if (isPanelReady(PANEL_MOULD)) {
+    rebuildMouldList();
+  }
+  // Built now so the first tap on a field doesn't pay for them.
+  getSharedKeyboard(nullptr);
+  getNumericKeypad();
+  BootProfile::mark("keyboards");
+#endif
+  BootProfile::report();
 }
 
 } // namespace
 
 namespace PrdUi {
 
+void onPlungerFrame(lv_timer_t *timer);
+void onMotionChanged(lv_observer_t *observer, lv_subject_t *subject);
+void onRefillChanged(lv_observer_t *observer, lv_subject_t *subject);
+
 void init() {
   if (ui.initialized) {
     return;
@@ -1640,13 +2372,16 @@ void init() {
     return;
   }
 
+  UiStyles::init();
+
+#if !FAST_BOOT
   // Load persisted moulds
-  Storage::init();
-  Storage::loadMoulds(ui.mouldProfiles, ui.mouldProfileCount,
-                      MAX_MOULD_PROFILES);
+  loadMouldLibrary();
 
   // Pre-initialize shared keyboard on top layer
   getSharedKeyboard(nullptr);
+  BootProfile::mark("keyboard");
+#endif
 
   // Disable screen-level scrolling to prevent left-side plunger from jumping
   lv_obj_remove_flag(objects.main, LV_OBJ_FLAG_SCROLLABLE);
@@ -1655,106 +2390,98 @@ void init() {
 
   Serial.println("PRD_UI: init hideLegacyWidgets");
   hideLegacyWidgets();
-
-  // Panels and readouts are now created ON DEMAND in tick()
-
-  if (ui.mouldProfileCount == 0) {
-    ui.mouldProfileCount = 1;
-    strncpy(ui.mouldProfiles[0].name, "Awaiting QUERY_MOULD",
-            sizeof(ui.mouldProfiles[0].name) - 1);
-    ui.mouldProfiles[0].name[sizeof(ui.mouldProfiles[0].name) - 1] = '\0';
+  releaseLegacyPlungers();
+
+  // Single left column shared by all screens. It follows the active screen
+  // via LV_EVENT_SCREEN_LOAD_START, which fires before the new screen is
+  // drawn, so there is never a frame without it.
+  UiModel::init();
+  lv_obj_t *startScreen = lv_screen_active();
+  ui.plunger = PlungerWidget::create(startScreen);
+  createLeftReadouts(startScreen, &ui.posReadout, &ui.tempReadout);
+  observeStale(ui.posReadout, DisplayComms::RX_ENC);
+  observeStale(ui.tempReadout, DisplayComms::RX_TEMP);
+  lv_obj_t *screens[] = {objects.main, objects.mould_settings,
+                         objects.common_settings};
+  for (lv_obj_t *screen : screens) {
+    lv_obj_add_event_cb(screen, onScreenLoadStart, LV_EVENT_SCREEN_LOAD_START,
+                        nullptr);
   }
 
-  ui.initialized = true;
-  Serial.println("PRD_UI: init basic state complete");
-}
+  // Refill block colours follow thermal dose, which only moves on TEMP
+  // samples; the level for a dose is a table lookup.
+  RefillColour::init();
 
-void updateRefillBlocks(const DisplayComms::Status &status) {
-  float currentPos = status.encoderTurns;
-  const char *state = status.state;
+  // Plunger position is redrawn at frame rate from the motion smoother, and
+  // only while it is actually moving.
+  ui.plungerMotion.setLimits(0.0f, 360.5f);
+  ui.plungerFrameTimer =
+      lv_timer_create(onPlungerFrame, LV_DEF_REFR_PERIOD, nullptr);
+  lv_timer_pause(ui.plungerFrameTimer);
 
-  // 1. Start Sequence: Entering REFILL
-  if (strcmp(state, "REFILL") == 0) {
-    if (!ui.refillSequenceActive) {
-      ui.refillSequenceActive = true;
-      // Capture start position. During Refill, plunger moves UP (turns
-      // decrease).
-      ui.startRefillPos = currentPos;
-      Serial.printf("PRD_UI: Refill Sequence Started at %.2f\n", currentPos);
-    }
-    ui.isRefilling = true;
-  } else {
-    ui.isRefilling = false;
-  }
+  // The left column follows the model for the life of the UI.
+  lv_subject_add_observer_obj(&UiModel::position, onReadoutChanged,
+                              ui.posReadout, reinterpret_cast<void *>(2));
+  lv_subject_add_observer_obj(&UiModel::temperature, onReadoutChanged,
+                              ui.tempReadout, reinterpret_cast<void *>(1));
+  lv_subject_add_observer(&UiModel::motion, onMotionChanged, nullptr);
+  lv_subject_add_observer(&UiModel::refill, onRefillChanged, nullptr);
 
-  // 2. End Sequence: Entering READY_TO_INJECT
-  if (strcmp(state, "READY_TO_INJECT") == 0 &&
-      strcmp(ui.lastState, "READY_TO_INJECT") != 0 && ui.refillSequenceActive) {
+  restoreWarmStart();
+  BootProfile::mark("warm start");
 
-    // Calculate total geometric space between Bottom (360.5) and Plunger
-    // (currentPos)
-    float spaceBelowPlunger = 360.5f - currentPos;
-    if (spaceBelowPlunger < 0)
-      spaceBelowPlunger = 0;
+  // Right panels are now created ON DEMAND in tick()
 
-    // Calculate how much volume is already occupied by existing blocks
-    float existingVolume = 0.0f;
-    for (int i = 0; i < ui.blockCount; i++) {
-      existingVolume += ui.refillBlocks[i].volume;
-    }
+  ui.initialized = true;
+  BootProfile::mark("prd_ui");
+  Serial.println("PRD_UI: init basic state complete");
+}
 
-    // New block fills whatever physical space remains
-    float delta = spaceBelowPlunger - existingVolume;
-
-    // Only add positive blocks (real refills)
-    if (delta > 0.5f) {
-      if (ui.blockCount < 16) {
-        ui.refillBlocks[ui.blockCount] = RefillBlock(delta, millis(), true);
-        ui.blockCount++;
-        Serial.printf("PRD_UI: Block added. Vol: %.2f. SpaceBelow: %.2f "
-                      "Existing: %.2f Cur: %.2f. "
-                      "Count: %d\n",
-                      delta, spaceBelowPlunger, existingVolume, currentPos,
-                      ui.blockCount);
-      } else {
-        Serial.println("PRD_UI: Block limit reached!");
-      }
-    } else {
-      Serial.printf("PRD_UI: Ignored invalid block. Vol: %.2f. SpaceBelow: "
-                    "%.2f Existing: %.2f "
-                    "Cur: %.2f\n",
-                    delta, spaceBelowPlunger, existingVolume, currentPos);
+// Picks up the refill engine's block list when it has changed. Most changes
+// are a TEMP sample adding dose, so the plungers are only redrawn when a
+// volume or a colour level actually moved.
+void syncRefillBlocks() {
+  uint32_t revision = DisplayComms::refillRevision();
+  if (revision == ui.refillRevision) {
+    return;
+  }
+  ui.refillRevision = revision;
+  RefillBlock next[RefillStack::CAPACITY];
+  int count = DisplayComms::copyRefillBlocks(next, RefillStack::CAPACITY);
+  bool changed = count != ui.blockCount;
+  int overdosed = 0;
+  for (int i = 0; i < count; i++) {
+    next[i].colourLevel = RefillColour::levelForDose(next[i].dose);
+    if (next[i].dose >= RefillEngine::DOSE_LIMIT) {
+      overdosed++;
     }
-    ui.refillSequenceActive = false; // Sequence complete
-  }
-
-  // 3. Consumption Logic (Injection)
-  // Injection moves Plunger DOWN, so turns INCREASE.
-  if (currentPos > ui.lastFramePos) {
-    float consumedCm3 = currentPos - ui.lastFramePos;
-
-    // Ignore small jitters or massive jumps (e.g. wrapping)
-    if (consumedCm3 > 0.001f && consumedCm3 < 100.0f) {
-      while (consumedCm3 > 0.001f && ui.blockCount > 0) {
-        if (ui.refillBlocks[0].volume > consumedCm3) {
-          ui.refillBlocks[0].volume -= consumedCm3;
-          consumedCm3 = 0;
-        } else {
-          consumedCm3 -= ui.refillBlocks[0].volume;
-          // Shift blocks
-          for (int i = 0; i < ui.blockCount - 1; i++) {
-            ui.refillBlocks[i] = ui.refillBlocks[i + 1];
-          }
-          ui.blockCount--;
-          ui.refillBlocks[ui.blockCount] = RefillBlock();
-        }
-      }
+    if (!changed && (next[i].volume != ui.blocks[i].volume ||
+                     next[i].colourLevel != ui.blocks[i].colourLevel)) {
+      changed = true;
     }
+    ui.blocks[i] = next[i];
   }
+  ui.blockCount = count;
+  if (overdosed != ui.overdosedBlocks) {
+    ui.overdosedBlocks = overdosed;
+    changed = true;
+  }
+  if (changed) {
+    ui.plungerBlocksDirty = true;
+    publishPlungerBlocks();
+  }
+}
 
-  ui.lastFramePos = currentPos;
-  strncpy(ui.lastState, state, sizeof(ui.lastState) - 1);
+void syncShotStats() {
+  uint32_t revision = DisplayComms::shotRevision();
+  if (revision == ui.shotRevision) {
+    return;
+  }
+  ui.shotRevision = revision;
+  DisplayComms::copyShotSummary(ui.shots);
+  UiModel::bump(&UiModel::shots);
 }
+
 void updatePlungerPosition(float turns) {
   // Plunger/Rod Movement Logic
   // The plunger object (rod) sits on top of the barrel interior.
@@ -1771,12 +2498,11 @@ void updatePlungerPosition(float turns) {
   // 360.5 turns = Tip Bottom at Y=791 (Lifted 2px off UI edge).
   // 22.53 turns = Tip Top exactly at Y=0 (Edge of the gray square).
   // Total Tip Travel: 711 - 0 = 711px. (Since Tip Bottom 791 - Tip 80 = 711 Tip
-  // Top). Scale factor: 711px / (360.5 - 22.53) turns = 2.1037 px/turn
-  static const float MAX_TURNS = 360.5f;
-  static const float PX_PER_TURN = 711.0f / (360.5f - 22.53f); // ~2.1037f
-
-  // The plunger tip is fixed at Y=700 inside the plunger container.
-  static const int TIP_ANCHOR_Y = 700;
+  // Top). Scale factor: PlungerWidget::PX_PER_TURN.
+  using PlungerWidget::MAX_TURNS;
+  using PlungerWidget::PX_PER_TURN;
+  using PlungerWidget::TIP_ANCHOR_Y;
+  using PlungerWidget::TIP_TOP_TURNS;
 
   float clampedTurns = turns;
   if (clampedTurns < 0.0f)
@@ -1785,7 +2511,7 @@ void updatePlungerPosition(float turns) {
     clampedTurns = MAX_TURNS;
 
   // Formula: TipY = (turns - 22.53) * scale. Plunger Y = TipY - Anchor.
-  float targetTipY = (clampedTurns - 22.53f) * PX_PER_TURN;
+  float targetTipY = (clampedTurns - TIP_TOP_TURNS) * PX_PER_TURN;
   int yOffset = static_cast<int>(targetTipY) - TIP_ANCHOR_Y;
 
   // Safety Clamping
@@ -1794,87 +2520,83 @@ void updatePlungerPosition(float turns) {
   if (yOffset > 13)
     yOffset = 13;
 
-  // Apply to all plunger objects
-  if (isObjReady(objects.plunger_tip__plunger))
-    lv_obj_set_y(objects.plunger_tip__plunger, yOffset);
-  if (isObjReady(objects.obj0__plunger))
-    lv_obj_set_y(objects.obj0__plunger, yOffset);
-  if (isObjReady(objects.obj2__plunger))
-    lv_obj_set_y(objects.obj2__plunger, yOffset);
-  if (isObjReady(objects.obj5__plunger))
-    lv_obj_set_y(objects.obj5__plunger, yOffset);
+  PlungerWidget::setTipY(ui.plunger,
+                         static_cast<lv_coord_t>(yOffset + TIP_ANCHOR_Y));
 }
 
-void renderRefillBlocksForBands(lv_obj_t **bands) {
-  if (!bands)
+void onPlungerFrame(lv_timer_t *timer) {
+  uint32_t now = millis();
+  // setTipY is a no-op when the pixel row is unchanged, so a crawl slower
+  // than a pixel per frame costs no redraw either.
+  updatePlungerPosition(ui.plungerMotion.estimate(now));
+  if (ui.plungerMotion.isSettled(now)) {
+    lv_timer_pause(timer);
+  }
+}
+
+// Feed new ENC samples to the smoother. A machine state change snaps to the
+// reported position instead of extrapolating across the transition.
+void feedPlungerMotion(const DisplayComms::Status &status) {
+  bool stateChanged = strcmp(status.state, ui.motionState) != 0;
+  bool newSample = status.encoderSampleCount != ui.lastEncoderSample;
+  if (!stateChanged && !newSample) {
     return;
+  }
 
-  // Using 2.1037f to perfectly match Plunger's pixels-per-turn mapping.
-  static const float PX_PER_TURN = 711.0f / (360.5f - 22.53f);
+  if (stateChanged) {
+    strncpy(ui.motionState, status.state, sizeof(ui.motionState) - 1);
+    ui.motionState[sizeof(ui.motionState) - 1] = '\0';
+    ui.plungerMotion.reset(status.encoderTurns, millis());
+  } else {
+    ui.plungerMotion.addSample(status.encoderTurns, status.encoderSampleMs);
+  }
+  ui.lastEncoderSample = status.encoderSampleCount;
 
-  if (ui.blockCount > 0) {
-    Serial.printf("PRD_UI: Render Blocks count=%d. PX_PER_TURN=%.2f\n",
-                  ui.blockCount, PX_PER_TURN);
+  if (ui.plungerFrameTimer) {
+    lv_timer_resume(ui.plungerFrameTimer);
+    lv_timer_ready(ui.plungerFrameTimer);
   }
+}
 
-  int y = 791; // Bottom of barrel is 791px (lifted from edge).
-  uint32_t now = millis();
+int buildPlungerBlocks(PlungerWidget::Block *out) {
+  // Same scale as the tip, so the stack top meets it.
+  using PlungerWidget::PX_PER_TURN;
 
-  for (int i = 0; i < 16; i++) {
-    lv_obj_t *band = bands[i];
-    if (!isObjReady(band))
-      continue;
-
-    if (i < ui.blockCount) {
-      int h = static_cast<int>(ui.refillBlocks[i].volume * PX_PER_TURN);
-      if (h < 1)
-        h = 1;
-      y -= h;
-
-      // Serial.printf("PRD_UI: Band %d. Vol=%.2f H=%d Y=%d\n", i,
-      // ui.refillBlocks[i].volume, h, y);
-
-      lv_obj_set_size(band, 80, h);
-      // Shift left by setting X to -8 relative to container
-      // Container X=10. X=-8 -> Abs X=2. Plunger Abs X=20...?
-      // User requested total 8px left shift relative to original.
-      lv_obj_set_pos(band, -8, y);
-      lv_obj_remove_flag(band, LV_OBJ_FLAG_HIDDEN);
-
-      // Color based on age (millis)
-      // 0-10s: Blue, 10-30s: Orange, 30s+: Red
-      uint32_t age = now - ui.refillBlocks[i].addedMs;
-      lv_color_t color;
-      if (age < 10000)
-        color = lv_color_hex(0x3498db); // Blue
-      else if (age < 30000)
-        color = lv_color_hex(0xe67e22); // Orange
-      else
-        color = lv_color_hex(0xe74c3c); // Red
-      lv_obj_set_style_bg_color(band, color, LV_PART_MAIN | LV_STATE_DEFAULT);
-    } else {
-      lv_obj_add_flag(band, LV_OBJ_FLAG_HIDDEN);
-    }
+  int count = ui.blockCount;
+  if (count > PlungerWidget::MAX_BLOCKS)
+    count = PlungerWidget::MAX_BLOCKS;
+
+  for (int i = 0; i < count; i++) {
+    const RefillBlock &block = ui.blocks[i];
+    int h = static_cast<int>(block.volume * PX_PER_TURN);
+    if (h < 1)
+      h = 1;
+    out[i].heightPx = static_cast<uint16_t>(h);
+    // Level is set from the dose when the block list is synced.
+    out[i].color = RefillColour::color(block.colourLevel);
   }
+  return count;
 }
 
 void renderAllPlungers() {
-  // We need to gather the bands for each screen.
-  // The objects struct has them in groups of 16.
-  // indices based on screens.c:
-  // Main/plunger_tip: 4 + 2 = 6
-  // Main/obj0: 27 + 2 = 29
-  // Mould/obj2: 56 + 2 = 58
-  // Common/obj5: 102 + 2 = 104
+  ui.plungerBlocksDirty = false;
+
+  PlungerWidget::Block blocks[PlungerWidget::MAX_BLOCKS];
+  int count = buildPlungerBlocks(blocks);
 
-  lv_obj_t **allObjects = (lv_obj_t **)&objects;
+  // The widget diffs against what it last drew, so unchanged stacks cost no
+  // invalidation.
+  PlungerWidget::setBlocks(ui.plunger, blocks, count);
+}
 
-  renderRefillBlocksForBands(&allObjects[6]);
-  renderRefillBlocksForBands(&allObjects[29]);
-  renderRefillBlocksForBands(&allObjects[58]);
-  renderRefillBlocksForBands(&allObjects[104]);
+// A new ENC sample or machine state drives the plunger motion; it doesn't
+// run while the machine is quiet. The refill stack is DisplayComms' own.
+void onMotionChanged(lv_observer_t *, lv_subject_t *) {
+  feedPlungerMotion(UiModel::lastStatus());
 }
 
+void onRefillChanged(lv_observer_t *, lv_subject_t *) { renderAllPlungers(); }
+
 void handleDebugCommand(const char *cmd) {
   if (!cmd)
     return;
@@ -1886,21 +2608,47 @@ void handleDebugCommand(const char *cmd) {
   buf[sizeof(buf) - 1] = '\0';
 
   char *part1 = strtok(buf, "|");
+  if (part1 && strcmp(part1, "HANDLES") == 0) {
+    logHandleStats();
+    return;
+  }
+  if (part1 && strcmp(part1, "MODEL") == 0) {
+    logModelStats();
+    return;
+  }
+  if (part1 && strcmp(part1, "BOOT") == 0) {
+    BootProfile::report();
+    return;
+  }
+  if (part1 && strcmp(part1, "STYLES") == 0) {
+    handleStylesCommand(strtok(nullptr, "|"));
+    return;
+  }
+  if (part1 && (strcmp(part1, "EXPORT") == 0 || strcmp(part1, "IMPORT") == 0)) {
+    handleTransferCommand(part1[0] == 'I', strtok(nullptr, "|"));
+    return;
+  }
+  if (part1 && strcmp(part1, "REFILLS") == 0) {
+    char *last = strtok(nullptr, "|");
+    logRefillHistory(last ? atoi(last) : 10);
+    return;
+  }
+  if (part1 && strcmp(part1, "SHOTS") == 0) {
+    char *action = strtok(nullptr, "|");
+    logShotStats(action && strcmp(action, "RESET") == 0);
+    return;
+  }
+  if (part1 && strcmp(part1, "MOULDS") == 0) {
+    char *first = strtok(nullptr, "|");
+    int page = first ? atoi(first) : 0;
+    ui.mouldPageRequest = page > 0 ? page : 0;
+    return;
+  }
   if (part1 && strcmp(part1, "MOCK") == 0) {
     char *part2 = strtok(nullptr, "|");
     char *part3 = strtok(nullptr, "|");
     if (part2 && part3) {
-      DisplayComms::Status mockStatus = DisplayComms::getStatus();
-      if (strcmp(part2, "STATE") == 0) {
-        ui.mockEnabled = true;
-        strncpy(ui.mockState, part3, sizeof(ui.mockState) - 1);
-        ui.mockState[sizeof(ui.mockState) - 1] = '\0';
-      } else if (strcmp(part2, "POS") == 0) {
-        ui.mockEnabled = true;
-        ui.mockPos = atof(part3);
-      } else if (strcmp(part2, "OFF") == 0) {
-        ui.mockEnabled = false;
-      }
+      handleMockCommand(part2, part3);
     }
   }
 }
@@ -1912,126 +2660,70 @@ void tick() {
 
   lv_obj_t *active = lv_screen_active();
 
-  // lifecycle Management: Purge panels when LEAVING a screen to save RAM
-  // Move this to the TOP to free memory before we try to build the next
-  // screen
-  if (ui.lastActiveScreen && active != ui.lastActiveScreen) {
-    if (ui.lastActiveScreen == objects.mould_settings)
-      purgeMouldPanels();
-    else if (ui.lastActiveScreen == objects.common_settings)
-      purgeCommonPanel();
-    else if (ui.lastActiveScreen == objects.main)
-      purgeMainPanel();
-    uiYield(); // Give some time for LVGL to process the async deletes
+  // Leaving a screen keeps its panel warm on that screen. The pool evicts
+  // least recently used panels only when over budget or short on heap.
+  if (active != ui.lastActiveScreen) {
+    if (ui.lastActiveScreen) {
+      hideKeyboard();
+      PanelPool::markUsed(panelForScreen(ui.lastActiveScreen), millis());
+      beginNavTiming();
+    }
     ui.lastActiveScreen = active;
-    return; // Wait for next tick to build the new screen (memory safety)
   }
-  ui.lastActiveScreen = active;
 
-  // Lifecycle Management: Construct panels ONLY when visible
-  if (active == objects.main) {
-    if (!isObjReady(ui.rightPanelMain)) {
-      Serial.println("PRD_UI: Building Main Panel on demand.");
-      createLeftReadouts(objects.main, &ui.posLabelMain, &ui.tempLabelMain);
-      createMainPanel();
-      ui.lastMainScreen = objects.main;
-    }
-  } else if (active == objects.mould_settings) {
-    if (!isObjReady(ui.rightPanelMould)) {
-      Serial.println("PRD_UI: Building Mould Panel on demand.");
-      createLeftReadouts(objects.mould_settings, &ui.posLabelMould,
-                         &ui.tempLabelMould);
-      createMouldPanel();
-      rebuildMouldList();
-      ui.lastMouldScreen = objects.mould_settings;
+  int activePanel = panelForScreen(active);
+  if (activePanel != PanelPool::NONE) {
+    bool warm = isPanelReady(activePanel);
+    if (!warm) {
+      if (makeRoomFor(activePanel)) {
+        uiYield();
+        return; // Build next tick, once the async deletes have freed memory
+      }
+      buildPanel(activePanel);
       uiYield();
     }
-  } else if (active == objects.common_settings) {
-    if (!isObjReady(ui.rightPanelCommon)) {
-      Serial.println("PRD_UI: Building Common Panel on demand.");
-      createLeftReadouts(objects.common_settings, &ui.posLabelCommon,
-                         &ui.tempLabelCommon);
-      createCommonPanel();
-      ui.lastCommonScreen = objects.common_settings;
-      uiYield();
+    if (ui.navPending && isPanelReady(activePanel)) {
+      PanelPool::markUsed(activePanel, millis());
+      trimPanelPool(activePanel);
+      finishNavTiming(activePanel, warm);
     }
   }
-  ui.lastActiveScreen = active;
 
-  // Handle pointer invalidation (extra safety)
-  if (!isObjReady(ui.rightPanelMould)) {
-    ui.rightPanelMould = nullptr;
-    ui.mouldList = nullptr;
-  }
-  if (!isObjReady(ui.rightPanelCommon)) {
-    ui.rightPanelCommon = nullptr;
-  }
-  if (!isObjReady(ui.rightPanelMain)) {
-    ui.rightPanelMain = nullptr;
+  // Boot ends once the first screen has been drawn with its panel.
+  if (ui.bootPending) {
+    if (BootProfile::firstFrameShown()) {
+      finishBoot();
+    } else if (activePanel != PanelPool::NONE && isPanelReady(activePanel)) {
+      BootProfile::expectFrame();
+    }
   }
 
-  const DisplayComms::Status &realStatus = DisplayComms::getStatus();
-  DisplayComms::Status status = realStatus;
-  if (ui.mockEnabled) {
-    status.encoderTurns = ui.mockPos;
-    strncpy(status.state, ui.mockState, sizeof(status.state) - 1);
-    status.state[sizeof(status.state) - 1] = '\0';
+  // Panel refs clear themselves from LV_EVENT_DELETE, so no pointer
+  // invalidation pass is needed here.
+  sampleHandleCheckRate();
+  if (ui.mouldPageRequest >= 0) {
+    int first = ui.mouldPageRequest;
+    ui.mouldPageRequest = -1;
+    logMouldPage(first);
   }
+  pollStorage();
+  pollTransfer();
 
-  const DisplayComms::MouldParams &mould = DisplayComms::getMould();
-  const DisplayComms::CommonParams &common = DisplayComms::getCommon();
+  DisplayComms::Status status = DisplayComms::getStatus();
+  const DisplayComms::MouldParams *mould = &DisplayComms::getMould();
+  const DisplayComms::CommonParams *common = &DisplayComms::getCommon();
+  reconcileWarmStart(status, mould, common);
+  syncRefillBlocks();
+  syncShotStats();
 
-  updateLeftReadouts(status);
-  updateRefillBlocks(status);
-  updatePlungerPosition(status.encoderTurns);
-  updateStateWidgets(status);
-  updateErrorFrames(status);
-  renderAllPlungers();
-  if (isObjReady(ui.mouldList) &&
-      !lv_obj_has_flag(ui.mouldList, LV_OBJ_FLAG_HIDDEN)) {
-    updateMouldListFromComms(mould);
-  }
-  syncMouldSendEditEnablement();
-
-  if (isObjReady(ui.rightPanelCommon) &&
-      !lv_obj_has_flag(ui.rightPanelCommon, LV_OBJ_FLAG_HIDDEN)) {
-    if (!ui.commonDirty) {
-      syncCommonInputsFromModel(common);
-    }
-    // Only sync button enablement when panel is actually visible to save CPU
-    syncCommonSendEnablement();
-  }
+  // One diff at the thread boundary; bound widgets hear only what moved.
+  UiModel::publish(status, *mould, *common, DisplayComms::isSafeForUpdate());
+  offerWarmStart();
 }
 
 bool isInitialized() { return ui.initialized; }
 
 } // namespace PrdUi
 
-void handleDebugCommand(const char *cmd) {
-  if (!cmd)
-    return;
-  Serial.printf("PRD_UI: Debug Command received: %s\n", cmd);
-
-  // Simple MOCK parser: MOCK|STATE|Name or MOCK|POS|Value
-  char buf[64];
-  strncpy(buf, cmd, sizeof(buf) - 1);
-  buf[sizeof(buf) - 1] = '\0';
-
-  char *part1 = strtok(buf, "|");
-  if (part1 && strcmp(part1, "MOCK") == 0) {
-    char *part2 = strtok(nullptr, "|");
-    char *part3 = strtok(nullptr, "|");
-    if (part2 && part3) {
-      if (strcmp(part2, "STATE") == 0) {
-        ui.mockEnabled = true;
-        strncpy(ui.mockState, part3, sizeof(ui.mockState) - 1);
-        ui.mockState[sizeof(ui.mockState) - 1] = '\0';
-      } else if (strcmp(part2, "POS") == 0) {
-        ui.mockEnabled = true;
-        ui.mockPos = atof(part3);
-      } else if (strcmp(part2, "OFF") == 0) {
-        ui.mockEnabled = false;
-      }
-    }
-  }
-}
+// main.cpp's serial console hook; the commands live in PrdUi.
+void handleDebugCommand(const char *cmd) { PrdUi::handleDebugCommand(cmd); }
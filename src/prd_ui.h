@@ -7,6 +7,10 @@ void init();
 void tick();
 bool isInitialized();
 
+// Serial console commands (HANDLES, MODEL, REFILLS, MOCK|..., etc.); called
+// from loop().
+void handleDebugCommand(const char *cmd);
+
 } // namespace PrdUi
 
 #endif // PRD_UI_H
@@ -0,0 +1,321 @@
+#include "property_grid.h"
+
+#include <cstring>
+
+namespace PropertyGrid {
+
+namespace {
+
+struct State {
+  Config config;
+  char values[MAX_FIELDS][VALUE_SIZE];
+  lv_obj_t *editor;
+  int editRow;
+  bool suppress; // editor text is being set by the grid, not the user
+};
+
+State *getState(lv_obj_t *grid) {
+  if (!grid) {
+    return nullptr;
+  }
+  return static_cast<State *>(lv_obj_get_user_data(grid));
+}
+
+bool validRow(const State *state, int row) {
+  return state && row >= 0 && row < state->config.count;
+}
+
+// Screen position of the content origin; children share it.
+lv_point_t contentOrigin(lv_obj_t *grid) {
+  lv_area_t coords;
+  lv_obj_get_coords(grid, &coords);
+  int32_t border = lv_obj_get_style_border_width(grid, LV_PART_MAIN);
+  lv_point_t origin;
+  origin.x = coords.x1 + border +
+             lv_obj_get_style_pad_left(grid, LV_PART_MAIN) -
+             lv_obj_get_scroll_x(grid);
+  origin.y = coords.y1 + border + lv_obj_get_style_pad_top(grid, LV_PART_MAIN) -
+             lv_obj_get_scroll_y(grid);
+  return origin;
+}
+
+lv_coord_t rowTop(int row) { return TOP_MARGIN + row * ROW_PITCH; }
+
+void invalidateRow(lv_obj_t *grid, int row) {
+  lv_point_t origin = contentOrigin(grid);
+  lv_area_t area;
+  area.x1 = origin.x + NAME_X;
+  area.x2 = origin.x + VALUE_X + VALUE_WIDTH - 1;
+  area.y1 = origin.y + rowTop(row);
+  area.y2 = area.y1 + VALUE_HEIGHT - 1;
+  lv_obj_invalidate_area(grid, &area);
+}
+
+void drawText(lv_layer_t *layer, lv_draw_label_dsc_t &dsc, const char *text,
+              int32_t x, int32_t y, int32_t w) {
+  int32_t lineHeight = lv_font_get_line_height(dsc.font);
+  lv_area_t area;
+  area.x1 = x;
+  area.x2 = x + w - 1;
+  area.y1 = y + (VALUE_HEIGHT - lineHeight) / 2;
+  area.y2 = area.y1 + lineHeight - 1;
+  dsc.text = text;
+  lv_draw_label(layer, &dsc, &area);
+}
+
+void onDraw(lv_event_t *e) {
+  lv_obj_t *grid = lv_event_get_target_obj(e);
+  State *state = getState(grid);
+  lv_layer_t *layer = lv_event_get_layer(e);
+  if (!state || !layer) {
+    return;
+  }
+
+  lv_point_t origin = contentOrigin(grid);
+  int32_t scrolled = lv_obj_get_scroll_y(grid) - TOP_MARGIN;
+  int first = scrolled > 0 ? scrolled / ROW_PITCH : 0;
+  int last = first + lv_obj_get_height(grid) / ROW_PITCH + 1;
+  if (last >= state->config.count) {
+    last = state->config.count - 1;
+  }
+
+  lv_draw_label_dsc_t label;
+  lv_draw_label_dsc_init(&label);
+  lv_obj_init_draw_label_dsc(grid, LV_PART_MAIN, &label);
+
+  lv_draw_rect_dsc_t box;
+  lv_draw_rect_dsc_init(&box);
+  box.bg_color = lv_color_hex(0x282b30);
+  box.border_color = lv_color_hex(0x3a4a5a);
+  box.border_width = 2;
+  box.radius = 4;
+
+  for (int row = first; row <= last; row++) {
+    int32_t y = origin.y + rowTop(row);
+    label.align = LV_TEXT_ALIGN_LEFT;
+    drawText(layer, label, state->config.fields[row].name, origin.x + NAME_X,
+             y, NAME_WIDTH);
+
+    // The editor covers its own row.
+    if (row == state->editRow) {
+      continue;
+    }
+    lv_area_t area = {origin.x + VALUE_X, y,
+                      origin.x + VALUE_X + VALUE_WIDTH - 1,
+                      y + VALUE_HEIGHT - 1};
+    lv_draw_rect(layer, &box, &area);
+    label.align = LV_TEXT_ALIGN_RIGHT;
+    drawText(layer, label, state->values[row], area.x1 + 8, y,
+             VALUE_WIDTH - 16);
+  }
+}
+
+void onSelfSize(lv_event_t *e) {
+  State *state = getState(lv_event_get_target_obj(e));
+  lv_point_t *size = lv_event_get_self_size_info(e);
+  if (state && size) {
+    size->y = LV_MAX(size->y, rowTop(state->config.count));
+  }
+}
+
+int rowAt(lv_obj_t *grid, const State *state, const lv_point_t &point) {
+  int32_t y = point.y - contentOrigin(grid).y - TOP_MARGIN;
+  if (y < 0 || y % ROW_PITCH >= VALUE_HEIGHT) {
+    return NO_ROW;
+  }
+  int row = y / ROW_PITCH;
+  return validRow(state, row) ? row : NO_ROW;
+}
+
+void setRowValue(State *state, int row, const char *text) {
+  strncpy(state->values[row], text, VALUE_SIZE - 1);
+  state->values[row][VALUE_SIZE - 1] = '\0';
+}
+
+// Advances a choice field to its next option, wrapping at the end.
+void cycleChoice(lv_obj_t *grid, State *state, int row) {
+  const char *choices = state->config.fields[row].choices;
+  if (!choices || !*choices) {
+    return;
+  }
+  const char *current = state->values[row];
+  size_t len = strlen(current);
+  const char *next = choices; // unknown values restart at the first option
+  for (const char *option = choices; *option;) {
+    const char *end = strchr(option, '\n');
+    size_t optionLen = end ? static_cast<size_t>(end - option) : strlen(option);
+    if (optionLen == len && strncmp(option, current, len) == 0) {
+      next = end ? end + 1 : choices;
+      break;
+    }
+    if (!end) {
+      break;
+    }
+    option = end + 1;
+  }
+  const char *end = strchr(next, '\n');
+  size_t nextLen = end ? static_cast<size_t>(end - next) : strlen(next);
+  if (nextLen >= VALUE_SIZE) {
+    nextLen = VALUE_SIZE - 1;
+  }
+  memcpy(state->values[row], next, nextLen);
+  state->values[row][nextLen] = '\0';
+  invalidateRow(grid, row);
+  if (state->config.onChange) {
+    state->config.onChange(grid, row);
+  }
+}
+
+void openEditor(lv_obj_t *grid, State *state, int row) {
+  const Field &field = state->config.fields[row];
+  if (state->editRow != row) {
+    closeEditor(grid);
+    lv_textarea_set_max_length(state->editor, field.maxLength);
+    lv_textarea_set_accepted_chars(
+        state->editor, field.type == INTEGER   ? "0123456789"
+                       : field.type == DECIMAL ? "0123456789.-"
+                                               : nullptr);
+    state->suppress = true;
+    lv_textarea_set_text(state->editor, state->values[row]);
+    state->suppress = false;
+    lv_obj_set_pos(state->editor, VALUE_X, rowTop(row));
+    lv_obj_remove_flag(state->editor, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_update_layout(state->editor); // onEdit may read its coordinates
+    state->editRow = row;
+  }
+  if (state->config.onEdit) {
+    state->config.onEdit(grid, row, state->editor);
+  }
+}
+
+void onClick(lv_event_t *e) {
+  lv_obj_t *grid = lv_event_get_target_obj(e);
+  State *state = getState(grid);
+  lv_indev_t *indev = lv_indev_active();
+  if (!state || !indev) {
+    return;
+  }
+  lv_point_t point;
+  lv_indev_get_point(indev, &point);
+  int row = rowAt(grid, state, point);
+  if (row == NO_ROW) {
+    return;
+  }
+  if (state->config.fields[row].type == CHOICE) {
+    closeEditor(grid);
+    cycleChoice(grid, state, row);
+  } else {
+    openEditor(grid, state, row);
+  }
+}
+
+void onEditorEvent(lv_event_t *e) {
+  lv_obj_t *grid = static_cast<lv_obj_t *>(lv_event_get_user_data(e));
+  State *state = getState(grid);
+  if (!state || !validRow(state, state->editRow)) {
+    return;
+  }
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_VALUE_CHANGED) {
+    if (state->suppress) {
+      return;
+    }
+    setRowValue(state, state->editRow,
+                lv_textarea_get_text(state->editor));
+    if (state->config.onChange) {
+      state->config.onChange(grid, state->editRow);
+    }
+  } else if (code == LV_EVENT_READY || code == LV_EVENT_CANCEL) {
+    closeEditor(grid);
+  }
+}
+
+void onDelete(lv_event_t *e) {
+  lv_obj_t *grid = lv_event_get_target_obj(e);
+  State *state = getState(grid);
+  if (state) {
+    lv_free(state);
+    lv_obj_set_user_data(grid, nullptr);
+  }
+}
+
+} // namespace
+
+bool attach(lv_obj_t *grid, const Config &config) {
+  if (!grid || getState(grid) || !config.fields || config.count < 1 ||
+      config.count > MAX_FIELDS) {
+    return false;
+  }
+  State *state = static_cast<State *>(lv_malloc_zeroed(sizeof(State)));
+  if (!state) {
+    return false;
+  }
+  state->config = config;
+  state->editRow = NO_ROW;
+
+  state->editor = lv_textarea_create(grid);
+  if (!state->editor) {
+    lv_free(state);
+    return false;
+  }
+  lv_textarea_set_one_line(state->editor, true);
+  lv_obj_set_size(state->editor, VALUE_WIDTH, VALUE_HEIGHT);
+  lv_obj_add_flag(state->editor, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_add_event_cb(state->editor, onEditorEvent, LV_EVENT_VALUE_CHANGED,
+                      grid);
+  lv_obj_add_event_cb(state->editor, onEditorEvent, LV_EVENT_READY, grid);
+  lv_obj_add_event_cb(state->editor, onEditorEvent, LV_EVENT_CANCEL, grid);
+
+  lv_obj_set_user_data(grid, state);
+  lv_obj_add_event_cb(grid, onDraw, LV_EVENT_DRAW_MAIN, nullptr);
+  lv_obj_add_event_cb(grid, onSelfSize, LV_EVENT_GET_SELF_SIZE, nullptr);
+  lv_obj_add_event_cb(grid, onClick, LV_EVENT_CLICKED, nullptr);
+  lv_obj_add_event_cb(grid, onDelete, LV_EVENT_DELETE, nullptr);
+  lv_obj_refresh_self_size(grid);
+  lv_obj_invalidate(grid);
+  return true;
+}
+
+void setValue(lv_obj_t *grid, int row, const char *text) {
+  State *state = getState(grid);
+  if (!validRow(state, row) || !text ||
+      strncmp(state->values[row], text, VALUE_SIZE - 1) == 0) {
+    return;
+  }
+  setRowValue(state, row, text);
+  if (row == state->editRow) {
+    state->suppress = true;
+    lv_textarea_set_text(state->editor, state->values[row]);
+    state->suppress = false;
+  } else {
+    invalidateRow(grid, row);
+  }
+}
+
+const char *value(lv_obj_t *grid, int row) {
+  State *state = getState(grid);
+  return validRow(state, row) ? state->values[row] : "";
+}
+
+void closeEditor(lv_obj_t *grid) {
+  State *state = getState(grid);
+  if (!state || state->editRow == NO_ROW) {
+    return;
+  }
+  int row = state->editRow;
+  state->editRow = NO_ROW;
+  lv_obj_add_flag(state->editor, LV_OBJ_FLAG_HIDDEN);
+  invalidateRow(grid, row);
+}
+
+int editingRow(lv_obj_t *grid) {
+  State *state = getState(grid);
+  return state ? state->editRow : NO_ROW;
+}
+
+lv_obj_t *editor(lv_obj_t *grid) {
+  State *state = getState(grid);
+  return state ? state->editor : nullptr;
+}
+
+} // namespace PropertyGrid
@@ -0,0 +1,68 @@
+#ifndef PROPERTY_GRID_H
+#define PROPERTY_GRID_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Name/value form drawn by a single scrollable container. Rows are painted
+// from a field descriptor array in one draw callback; tapping a row moves
+// the grid's one text area onto it for editing, so a form costs two LVGL
+// objects however many fields it has. Choice fields cycle their options on
+// tap and need no editor at all.
+namespace PropertyGrid {
+
+constexpr int MAX_FIELDS = 24;
+constexpr int VALUE_SIZE = 32; // including the terminator
+constexpr int NO_ROW = -1;
+
+constexpr lv_coord_t ROW_PITCH = 42;
+constexpr lv_coord_t TOP_MARGIN = 6;
+constexpr lv_coord_t NAME_X = 4;
+constexpr lv_coord_t NAME_WIDTH = 160;
+constexpr lv_coord_t VALUE_X = 168;
+constexpr lv_coord_t VALUE_WIDTH = 130;
+constexpr lv_coord_t VALUE_HEIGHT = 34;
+
+enum FieldType { TEXT, DECIMAL, INTEGER, CHOICE };
+
+struct Field {
+  const char *name;
+  FieldType type;
+  uint8_t maxLength;   // editor limit; ignored for CHOICE
+  const char *choices; // CHOICE only: options separated by '\n'
+  // DECIMAL / INTEGER only, for the numeric keypad. Equal bounds mean the
+  // value is unbounded.
+  float minValue;
+  float maxValue;
+  float step;
+};
+
+// The editor was opened on `row`; the caller shows its keyboard for it.
+typedef void (*EditFn)(lv_obj_t *grid, int row, lv_obj_t *editor);
+// The user changed the value of `row`. Not called for setValue().
+typedef void (*ChangeFn)(lv_obj_t *grid, int row);
+
+struct Config {
+  const Field *fields; // must outlive the grid
+  int count;
+  EditFn onEdit;
+  ChangeFn onChange;
+};
+
+// Turns an existing scrollable container into a property grid.
+bool attach(lv_obj_t *grid, const Config &config);
+
+// Sets a value without notifying; redraws the row only if it changed.
+void setValue(lv_obj_t *grid, int row, const char *text);
+const char *value(lv_obj_t *grid, int row);
+
+// Hides the editor; its text was already copied into the row.
+void closeEditor(lv_obj_t *grid);
+int editingRow(lv_obj_t *grid);
+
+// The grid's text area, for styling.
+lv_obj_t *editor(lv_obj_t *grid);
+
+} // namespace PropertyGrid
+
+#endif // PROPERTY_GRID_H
@@ -0,0 +1,83 @@
+#include "refill_colour.h"
+
+#include "refill_engine.h"
+
+namespace RefillColour {
+
+namespace {
+
+constexpr uint32_t MELTED_AT = RefillEngine::DOSE_LIMIT;
+constexpr uint32_t ORANGE_AT = MELTED_AT / 3;
+static_assert(ORANGE_AT > 0, "THERMAL_DOSE_LIMIT_CS too small for the ramp");
+
+#if REFILL_SMOOTH_RAMP
+constexpr int LEVELS = 31;
+#else
+constexpr int LEVELS = 3;
+#endif
+
+uint32_t levelStart[LEVELS];
+lv_color_t levelColor[LEVELS];
+bool built = false;
+
+// Keyframes of the ramp, interpolated for the smooth variant.
+lv_color_t colorAt(uint32_t dose) {
+  const lv_color_t blue = lv_color_hex(0x3498db);
+  const lv_color_t orange = lv_color_hex(0xe67e22);
+  const lv_color_t red = lv_color_hex(0xe74c3c);
+
+  if (dose >= MELTED_AT) {
+    return red;
+  }
+  if (dose >= ORANGE_AT) {
+    uint32_t mix = static_cast<uint64_t>(dose - ORANGE_AT) * LV_OPA_COVER /
+                   (MELTED_AT - ORANGE_AT);
+    // lv_color_mix weights the first colour by `mix`
+    return lv_color_mix(red, orange, static_cast<uint8_t>(mix));
+  }
+  uint32_t mix = static_cast<uint64_t>(dose) * LV_OPA_COVER / ORANGE_AT;
+  return lv_color_mix(orange, blue, static_cast<uint8_t>(mix));
+}
+
+} // namespace
+
+void init() {
+  if (built) {
+    return;
+  }
+#if REFILL_SMOOTH_RAMP
+  for (int i = 0; i < LEVELS; i++) {
+    levelStart[i] = static_cast<uint64_t>(MELTED_AT) * i / (LEVELS - 1);
+    levelColor[i] = colorAt(levelStart[i]);
+  }
+#else
+  const uint32_t starts[LEVELS] = {0, ORANGE_AT, MELTED_AT};
+  for (int i = 0; i < LEVELS; i++) {
+    levelStart[i] = starts[i];
+  }
+  levelColor[0] = lv_color_hex(0x3498db); // Blue
+  levelColor[1] = lv_color_hex(0xe67e22); // Orange
+  levelColor[2] = lv_color_hex(0xe74c3c); // Red
+#endif
+  built = true;
+}
+
+uint8_t levelCount() { return LEVELS; }
+
+uint8_t levelForDose(uint32_t dose) {
+  for (int i = LEVELS - 1; i > 0; i--) {
+    if (dose >= levelStart[i]) {
+      return static_cast<uint8_t>(i);
+    }
+  }
+  return 0;
+}
+
+lv_color_t color(uint8_t level) {
+  if (level >= LEVELS) {
+    level = LEVELS - 1;
+  }
+  return levelColor[level];
+}
+
+} // namespace RefillColour
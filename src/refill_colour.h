@@ -0,0 +1,27 @@
+#ifndef REFILL_COLOUR_H
+#define REFILL_COLOUR_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// 1 = smooth blue -> orange -> red "melting" ramp, 0 = the original three
+// hard steps, at a third of the dose limit and at the limit.
+#ifndef REFILL_SMOOTH_RAMP
+#define REFILL_SMOOTH_RAMP 1
+#endif
+
+// Precomputed colour ramp for refill blocks. Colour is a pure function of a
+// block's ramp level, and the level of its thermal dose (see RefillEngine),
+// so a block only needs repainting when a TEMP sample moves it up a level.
+namespace RefillColour {
+
+void init();
+
+uint8_t levelCount();
+uint8_t levelForDose(uint32_t dose);
+
+lv_color_t color(uint8_t level);
+
+} // namespace RefillColour
+
+#endif // REFILL_COLOUR_H
@@ -0,0 +1,134 @@
+#include "refill_engine.h"
+
+#include <Arduino.h>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Leftovers smaller than this are rounding, not travel.
+constexpr float MIN_STEP = 0.001f;
+
+// Readings outside this range are line noise; they are clamped so the
+// integer products below can't overflow.
+constexpr int32_t MAX_TEMP_TENTHS = 6000;
+
+// Tenths of a degree times milliseconds per dose unit.
+constexpr uint32_t TENTHS_MS_PER_UNIT =
+    10 * 1000 / RefillEngine::DOSE_UNITS_PER_CS;
+
+} // namespace
+
+void RefillEngine::onState(const char *state, uint32_t ms) {
+  if (strcmp(state, "REFILL") == 0 && !refillActive) {
+    refillActive = true;
+    Serial.printf("RefillEngine: refill started at %.2f\n", position);
+  }
+
+  if (strcmp(state, "READY_TO_INJECT") == 0 &&
+      strcmp(lastState, "READY_TO_INJECT") != 0 && refillActive) {
+    refillActive = false;
+    // The new block is whatever space under the plunger the stack doesn't
+    // already hold.
+    float spaceBelow = BARREL_TURNS - position;
+    if (spaceBelow < 0) {
+      spaceBelow = 0;
+    }
+    float existing = blocks.totalVolume();
+    float delta = spaceBelow - existing;
+    if (delta > MIN_BLOCK) {
+      if (!blocks.push(RefillBlock(delta, ms, true))) {
+        Serial.println("RefillEngine: stack full, merged into top block");
+      }
+      rev++;
+      Serial.printf("RefillEngine: block added, %.2f cm3 (space %.2f, "
+                    "existing %.2f, at %.2f), %d blocks\n",
+                    delta, spaceBelow, existing, position, blocks.count());
+    } else {
+      Serial.printf("RefillEngine: ignored refill of %.2f cm3 (space %.2f, "
+                    "existing %.2f, at %.2f)\n",
+                    delta, spaceBelow, existing, position);
+    }
+  }
+
+  strncpy(lastState, state, sizeof(lastState) - 1);
+  lastState[sizeof(lastState) - 1] = '\0';
+}
+
+void RefillEngine::onEncoder(float turns, uint32_t ms) {
+  // Injection moves the plunger down, so turns increase.
+  float step = turns - position;
+  if (havePosition && step > MIN_STEP && step < MAX_STEP &&
+      !blocks.empty()) {
+    blocks.consume(step, ms);
+    rev++;
+  }
+  position = turns;
+  havePosition = true;
+}
+
+void RefillEngine::onTemperature(float tempC, uint32_t ms) {
+  int32_t tenths = static_cast<int32_t>(lroundf(tempC * 10.0f));
+  if (tenths < 0) {
+    tenths = 0;
+  } else if (tenths > MAX_TEMP_TENTHS) {
+    tenths = MAX_TEMP_TENTHS;
+  }
+
+  // The previous reading held until now, or for MAX_TEMP_GAP_MS at most.
+  int32_t excess = lastTempTenths - THERMAL_DOSE_THRESHOLD_C * 10;
+  if (haveTemp && excess > 0) {
+    uint32_t held = ms - lastTempMs;
+    if (held > MAX_TEMP_GAP_MS) {
+      held = MAX_TEMP_GAP_MS;
+    }
+    bool changed = false;
+    for (int i = 0; i < blocks.count(); i++) {
+      RefillBlock &block = blocks.at(i);
+      // A block pushed since the last sample counts from when it landed.
+      uint32_t elapsed = held;
+      int32_t late = static_cast<int32_t>(block.addedMs - lastTempMs);
+      if (late > 0) {
+        elapsed = static_cast<uint32_t>(late) < held ? held - late : 0;
+      }
+      uint32_t product =
+          static_cast<uint32_t>(excess) * elapsed + block.doseRemainder;
+      uint32_t units = product / TENTHS_MS_PER_UNIT;
+      block.doseRemainder = product % TENTHS_MS_PER_UNIT;
+      if (units == 0) {
+        continue;
+      }
+      bool under = block.dose < DOSE_LIMIT;
+      block.dose = block.dose > UINT32_MAX - units ? UINT32_MAX
+                                                   : block.dose + units;
+      if (under && block.dose >= DOSE_LIMIT) {
+        Serial.printf("RefillEngine: block %d over dose limit, %.2f cm3\n",
+                      i, block.volume);
+      }
+      changed = true;
+    }
+    if (changed) {
+      rev++;
+    }
+  }
+
+  lastTempTenths = tenths;
+  lastTempMs = ms;
+  haveTemp = true;
+}
+
+void RefillEngine::restore(float turns, const char *state,
+                           const RefillBlock *saved, int count) {
+  blocks.clear();
+  for (int i = 0; i < count; i++) {
+    blocks.push(saved[i]);
+  }
+  // The plunger may have moved while powered off; the first live ENC sample
+  // sets the position without consuming.
+  position = turns;
+  havePosition = false;
+  strncpy(lastState, state, sizeof(lastState) - 1);
+  lastState[sizeof(lastState) - 1] = '\0';
+  refillActive = false;
+  rev++;
+}
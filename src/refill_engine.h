@@ -0,0 +1,68 @@
+#ifndef REFILL_ENGINE_H
+#define REFILL_ENGINE_H
+
+#include "refill_stack.h"
+
+#include <cstdint>
+
+// Barrel temperature above which material starts to degrade, and the dose
+// (degree seconds above it) at which a block counts as over-cooked. The
+// block colour ramp runs from 0 to the limit.
+#ifndef THERMAL_DOSE_THRESHOLD_C
+#define THERMAL_DOSE_THRESHOLD_C 180
+#endif
+#ifndef THERMAL_DOSE_LIMIT_CS
+#define THERMAL_DOSE_LIMIT_CS 3000
+#endif
+
+// Refill and consumption accounting, fed every STATE and ENC message in the
+// order they arrive, so block volumes don't depend on which samples a UI
+// frame happened to see. A REFILL -> READY_TO_INJECT sequence pushes a block
+// for the space under the plunger the stack doesn't already hold; plunger
+// travel towards the nozzle consumes blocks from the bottom. Every TEMP
+// sample adds the dose since the previous one to each block in the barrel;
+// a block that landed in between counts from when it landed.
+//
+// No locking and no hardware access: the caller owns the context it runs
+// in, and a recorded message sequence always replays to the same stack.
+class RefillEngine {
+public:
+  static constexpr float BARREL_TURNS = 360.5f; // plunger at the bottom
+  static constexpr float MIN_BLOCK = 0.5f;      // smaller refills are noise
+  static constexpr float MAX_STEP = 100.0f;     // bigger jumps aren't travel
+
+  // Dose is integer tenths of a degree second, so the per-sample sum is
+  // exact and a replayed trace gives the same dose on any build.
+  static constexpr uint32_t DOSE_UNITS_PER_CS = 10;
+  static constexpr uint32_t DOSE_LIMIT =
+      THERMAL_DOSE_LIMIT_CS * DOSE_UNITS_PER_CS;
+  // A sample holds until the next one, but not across a gap this long.
+  static constexpr uint32_t MAX_TEMP_GAP_MS = 10000;
+
+  void onState(const char *state, uint32_t ms);
+  void onEncoder(float turns, uint32_t ms);
+  void onTemperature(float tempC, uint32_t ms);
+
+  // Picks up from a saved stack, position and state (warm start).
+  void restore(float turns, const char *state, const RefillBlock *saved,
+               int count);
+
+  const RefillStack &stack() const { return blocks; }
+  bool refilling() const { return refillActive; }
+
+  // Bumped whenever the stack changes.
+  uint32_t revision() const { return rev; }
+
+private:
+  RefillStack blocks;
+  char lastState[24] = "";
+  float position = 0;
+  bool havePosition = false;
+  bool refillActive = false;
+  uint32_t rev = 0;
+  int32_t lastTempTenths = 0;
+  uint32_t lastTempMs = 0;
+  bool haveTemp = false;
+};
+
+#endif // REFILL_ENGINE_H
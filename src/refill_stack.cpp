@@ -0,0 +1,84 @@
+#include "refill_stack.h"
+
+namespace {
+
+// Leftovers smaller than this are rounding, not plastic.
+constexpr float MIN_VOLUME = 0.001f;
+
+} // namespace
+
+float RefillStack::totalVolume() const {
+  float total = 0.0f;
+  for (int i = 0; i < size; i++) {
+    total += at(i).volume;
+  }
+  return total;
+}
+
+bool RefillStack::push(const RefillBlock &block) {
+  if (size == CAPACITY) {
+    RefillBlock &top = at(size - 1);
+    top.volume += block.volume;
+    top.filledVolume += block.volume;
+    return false;
+  }
+  blocks[slot(size)] = block;
+  size++;
+  return true;
+}
+
+int RefillStack::consume(float volume, uint32_t nowMs) {
+  int retiredCount = 0;
+  while (volume > MIN_VOLUME && size > 0) {
+    RefillBlock &block = blocks[bottom];
+    if (block.volume > volume) {
+      block.volume -= volume;
+      break;
+    }
+    volume -= block.volume;
+    retire(block, nowMs);
+    block = RefillBlock();
+    bottom = (bottom + 1) % CAPACITY;
+    size--;
+    retiredCount++;
+  }
+  return retiredCount;
+}
+
+void RefillStack::clear() {
+  for (RefillBlock &block : blocks) {
+    block = RefillBlock();
+  }
+  bottom = 0;
+  size = 0;
+}
+
+void RefillStack::retire(const RefillBlock &block, uint32_t nowMs) {
+  retiredSoFar++;
+#if REFILL_HISTORY_SIZE > 0
+  history[historyNext] = {block.filledVolume, block.addedMs, nowMs,
+                          block.dose};
+  historyNext = (historyNext + 1) % HISTORY;
+#else
+  (void)block;
+  (void)nowMs;
+#endif
+}
+
+int RefillStack::historyCount() const {
+  return retiredSoFar < static_cast<uint32_t>(HISTORY)
+             ? static_cast<int>(retiredSoFar)
+             : HISTORY;
+}
+
+const RetiredBlock *RefillStack::retired(int index) const {
+#if REFILL_HISTORY_SIZE > 0
+  if (index < 0 || index >= historyCount()) {
+    return nullptr;
+  }
+  return &history[(historyNext - 1 - index + HISTORY) % HISTORY];
+#else
+  (void)index;
+  return nullptr;
+#endif
+}
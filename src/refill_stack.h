@@ -0,0 +1,90 @@
+#ifndef REFILL_STACK_H
+#define REFILL_STACK_H
+
+#include <cstdint>
+
+// Retired blocks kept for analytics and the debug console; 0 disables the
+// log.
+#ifndef REFILL_HISTORY_SIZE
+#define REFILL_HISTORY_SIZE 64
+#endif
+
+struct RefillBlock {
+  float volume; // cm3 still in the barrel
+  uint32_t addedMs;
+  bool active;
+  uint8_t colourLevel; // index into the RefillColour ramp
+  float filledVolume;  // cm3 when the refill landed
+  // Thermal dose so far, in RefillEngine::DOSE_UNITS_PER_CS per degree
+  // second above the dose threshold, and the part of a unit carried to the
+  // next sample.
+  uint32_t dose;
+  uint32_t doseRemainder;
+
+  RefillBlock()
+      : volume(0), addedMs(0), active(false), colourLevel(0), filledVolume(0),
+        dose(0), doseRemainder(0) {}
+  RefillBlock(float v, uint32_t a, bool act)
+      : volume(v), addedMs(a), active(act), colourLevel(0), filledVolume(v),
+        dose(0), doseRemainder(0) {}
+};
+
+// A block that was injected to the end.
+struct RetiredBlock {
+  float volume; // as filled
+  uint32_t filledMs;
+  uint32_t exhaustedMs;
+  uint32_t dose; // when it was used up
+};
+
+// The refill blocks in the barrel, bottom (oldest, injected first) to top.
+// A ring buffer: consuming from the bottom and pushing on top are O(1) and
+// nothing is shifted. Fully consumed blocks go to a fixed-size history log
+// that overwrites its oldest entry; reading it never touches the stack.
+class RefillStack {
+public:
+  static constexpr int CAPACITY = 16; // as PlungerWidget::MAX_BLOCKS
+  static constexpr int HISTORY = REFILL_HISTORY_SIZE;
+
+  int count() const { return size; }
+  bool empty() const { return size == 0; }
+
+  // 0 is the bottom block.
+  RefillBlock &at(int index) { return blocks[slot(index)]; }
+  const RefillBlock &at(int index) const { return blocks[slot(index)]; }
+
+  float totalVolume() const;
+
+  // Pushes on top. With the stack full the volume is added to the top block
+  // instead, so the stack still accounts for everything in the barrel, and
+  // the top block keeps its dose. Returns false in that case.
+  bool push(const RefillBlock &block);
+
+  // Takes `volume` from the bottom up, retiring blocks it empties. Returns
+  // how many blocks were retired.
+  int consume(float volume, uint32_t nowMs);
+
+  void clear();
+
+  // Retired blocks, 0 = most recent, while index < historyCount().
+  int historyCount() const;
+  const RetiredBlock *retired(int index) const;
+  // Every block retired since boot, including ones the log has dropped.
+  uint32_t retiredTotal() const { return retiredSoFar; }
+
+private:
+  int slot(int index) const { return (bottom + index) % CAPACITY; }
+  void retire(const RefillBlock &block, uint32_t nowMs);
+
+  RefillBlock blocks[CAPACITY];
+  int bottom = 0;
+  int size = 0;
+
+#if REFILL_HISTORY_SIZE > 0
+  RetiredBlock history[HISTORY] = {};
+  int historyNext = 0; // slot the next retired block goes into
+#endif
+  uint32_t retiredSoFar = 0;
+};
+
+#endif // REFILL_STACK_H
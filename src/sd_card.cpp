@@ -0,0 +1,55 @@
+#include "sd_card.h"
+
+#include <Arduino.h>
+#include <SD.h>
+#include <SPI.h>
+
+#ifndef SD_SCK_PIN
+#define SD_SCK_PIN 12
+#endif
+
+#ifndef SD_MISO_PIN
+#define SD_MISO_PIN 13
+#endif
+
+#ifndef SD_MOSI_PIN
+#define SD_MOSI_PIN 11
+#endif
+
+#ifndef SD_CS_PIN
+#define SD_CS_PIN 10
+#endif
+
+namespace SdCard {
+
+namespace {
+
+constexpr uint32_t SPI_HZ = 20000000;
+
+SPIClass sdSpi(HSPI);
+bool isMounted = false;
+
+} // namespace
+
+bool begin() {
+  if (isMounted) {
+    return true;
+  }
+  sdSpi.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
+  if (!SD.begin(SD_CS_PIN, sdSpi, SPI_HZ) || SD.cardType() == CARD_NONE) {
+    Serial.println("SdCard: no card");
+    SD.end();
+    sdSpi.end();
+    return false;
+  }
+  isMounted = true;
+  Serial.printf("SdCard: mounted, %lu MB\n",
+                static_cast<unsigned long>(SD.cardSize() / (1024 * 1024)));
+  return true;
+}
+
+bool mounted() { return isMounted; }
+
+fs::FS &fs() { return SD; }
+
+} // namespace SdCard
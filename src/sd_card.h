@@ -0,0 +1,20 @@
+#ifndef SD_CARD_H
+#define SD_CARD_H
+
+#include <FS.h>
+
+// The board's microSD slot, on its own SPI bus. Used for export and backup
+// only; the mould library itself stays on flash. Mounted on first use so a
+// missing card costs nothing at boot.
+namespace SdCard {
+
+// False if there is no card or it can't be mounted; later calls retry.
+bool begin();
+bool mounted();
+
+// Valid once begin() has returned true.
+fs::FS &fs();
+
+} // namespace SdCard
+
+#endif // SD_CARD_H
@@ -0,0 +1,157 @@
+#include "shot_stats.h"
+
+#include "display_comms.h"
+
+#include <Arduino.h>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// States the machine waits in between shots.
+const char *const IDLE_STATES[] = {"READY_TO_INJECT", "REFILL",
+                                   "INIT_HEATING",    "INIT_HOT_WAIT",
+                                   "PURGE_ZERO",      "CONFIRM_REMOVAL"};
+
+constexpr float MIN_STEP = 0.001f;
+
+const char *const METRIC_NAMES[SHOT_METRIC_COUNT] = {"cycle", "fill",
+                                                     "volume"};
+
+// Narrowest control limit per metric: what the timing of state messages
+// and the encoder can resolve, in s, s and cm3.
+const float MIN_LIMIT[SHOT_METRIC_COUNT] = {0.02f, 0.02f, 0.01f};
+
+bool isIdle(const char *state) {
+  for (const char *idle : IDLE_STATES) {
+    if (strcmp(state, idle) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+void ShotStats::onState(const char *state, uint32_t ms) {
+  if (strcmp(state, lastState) != 0) {
+    if (inShot && fillOpen) {
+      fillOpen = false;
+      fillMs = ms - shotStartMs;
+    }
+    if (inShot && isIdle(state)) {
+      finishShot(ms);
+    } else if (!inShot && strcmp(lastState, "READY_TO_INJECT") == 0 &&
+               !isIdle(state)) {
+      startShot(ms);
+    }
+  }
+  strncpy(lastState, state, sizeof(lastState) - 1);
+  lastState[sizeof(lastState) - 1] = '\0';
+}
+
+void ShotStats::onEncoder(float turns, uint32_t) {
+  // Injection moves the plunger down, so turns increase.
+  float step = turns - position;
+  if (inShot && havePosition && step > MIN_STEP && step < MAX_STEP) {
+    travel += step;
+  }
+  position = turns;
+  havePosition = true;
+}
+
+void ShotStats::reset() {
+  for (Metric &metric : metrics) {
+    metric.stats.reset();
+    metric.p50.reset();
+    metric.p95.reset();
+    metric.last = 0.0f;
+  }
+  shots = 0;
+  outOfControl = 0;
+  lastFlags = 0;
+  inShot = false;
+  haveLastStart = false;
+  rev++;
+}
+
+void ShotStats::summary(ShotSummary &out) const {
+  out.shots = shots;
+  out.outOfControl = outOfControl;
+  out.lastFlags = lastFlags;
+  for (int i = 0; i < SHOT_METRIC_COUNT; i++) {
+    const Metric &metric = metrics[i];
+    out.metrics[i] = {metric.stats.count(), metric.last,
+                      metric.stats.mean(),  metric.stats.stddev(),
+                      metric.p50.value(),   metric.p95.value()};
+  }
+}
+
+const char *ShotStats::metricName(ShotMetric metric) {
+  return metric < SHOT_METRIC_COUNT ? METRIC_NAMES[metric] : "?";
+}
+
+void ShotStats::startShot(uint32_t ms) {
+  inShot = true;
+  fillOpen = true;
+  shotStartMs = ms;
+  fillMs = 0;
+  travel = 0.0f;
+}
+
+void ShotStats::finishShot(uint32_t ms) {
+  inShot = false;
+  uint32_t duration = ms - shotStartMs;
+  bool haveCycle = haveLastStart && shotStartMs - lastStartMs <= MAX_CYCLE_MS;
+  float cycleS = (shotStartMs - lastStartMs) / 1000.0f;
+  haveLastStart = true;
+  lastStartMs = shotStartMs;
+  if (duration > MAX_SHOT_MS) {
+    Serial.printf("ShotStats: shot of %lu s dropped\n",
+                  static_cast<unsigned long>(duration / 1000));
+    return;
+  }
+
+  shots++;
+  uint32_t flags = 0;
+  for (Metric &metric : metrics) {
+    metric.last = 0.0f;
+  }
+  if (haveCycle && record(SHOT_CYCLE, cycleS)) {
+    flags |= 1u << SHOT_CYCLE;
+  }
+  if (record(SHOT_FILL, fillMs / 1000.0f)) {
+    flags |= 1u << SHOT_FILL;
+  }
+  if (record(SHOT_VOLUME, travel / DisplayComms::TURNS_PER_CM3)) {
+    flags |= 1u << SHOT_VOLUME;
+  }
+  lastFlags = flags;
+  if (flags) {
+    outOfControl++;
+    Serial.printf("ShotStats: shot %lu out of control:",
+                  static_cast<unsigned long>(shots));
+    for (int i = 0; i < SHOT_METRIC_COUNT; i++) {
+      if (flags & (1u << i)) {
+        Serial.printf(" %s %.2f", METRIC_NAMES[i], metrics[i].last);
+      }
+    }
+    Serial.println();
+  }
+  rev++;
+}
+
+bool ShotStats::record(ShotMetric which, float value) {
+  Metric &metric = metrics[which];
+  bool flagged = false;
+  if (metric.stats.count() >= MIN_SHOTS_FOR_LIMITS) {
+    float limit = fmaxf(CONTROL_SIGMA * metric.stats.stddev(),
+                        MIN_LIMIT[which]);
+    flagged = fabsf(value - metric.stats.mean()) > limit;
+  }
+  metric.stats.add(value);
+  metric.p50.add(value);
+  metric.p95.add(value);
+  metric.last = value;
+  return flagged;
+}
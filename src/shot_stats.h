@@ -0,0 +1,99 @@
+#ifndef SHOT_STATS_H
+#define SHOT_STATS_H
+
+#include "stream_stats.h"
+
+#include <cstdint>
+
+enum ShotMetric { SHOT_CYCLE, SHOT_FILL, SHOT_VOLUME, SHOT_METRIC_COUNT };
+
+// What the Main screen and the console show; a plain copy, safe to hand
+// between tasks.
+struct ShotSummary {
+  struct Metric {
+    uint32_t count;
+    float last; // 0 when the last shot didn't produce this metric
+    float mean;
+    float stddev;
+    float p50;
+    float p95;
+  };
+
+  uint32_t shots;
+  uint32_t outOfControl; // shots with at least one metric flagged
+  uint32_t lastFlags;    // 1 << ShotMetric for each flagged metric
+  Metric metrics[SHOT_METRIC_COUNT];
+};
+
+// Shot-to-shot statistics from the STATE and ENC stream, fed in arrival
+// order like RefillEngine.
+//
+// A shot starts when the machine leaves READY_TO_INJECT for anything but an
+// idle state, and ends when it is back in one. Fill time is how long the
+// first state of the shot lasted, dosed volume the plunger travel towards
+// the nozzle during the shot in cm3 (DisplayComms::TURNS_PER_CM3), and cycle
+// time the gap between shot starts.
+//
+// Each metric keeps a running mean and variance and P-squared estimates of
+// its median and 95th percentile, so memory stays constant. Once a metric
+// has MIN_SHOTS_FOR_LIMITS samples, a shot more than CONTROL_SIGMA standard
+// deviations from its mean is flagged out of control; the limits come from
+// the shots before it. A limit is never narrower than the metric's
+// measurement resolution, so after a run of identical shots any deviation
+// that can be measured is flagged.
+class ShotStats {
+public:
+  static constexpr uint32_t MIN_SHOTS_FOR_LIMITS = 10;
+  static constexpr float CONTROL_SIGMA = 3.0f;
+  // A longer gap is a break, not a cycle; a longer shot was abandoned.
+  static constexpr uint32_t MAX_CYCLE_MS = 600000;
+  static constexpr uint32_t MAX_SHOT_MS = 300000;
+  static constexpr float MAX_STEP = 100.0f; // bigger jumps aren't travel
+
+  void onState(const char *state, uint32_t ms);
+  void onEncoder(float turns, uint32_t ms);
+
+  // Forgets every shot (new mould, or asked for on the console).
+  void reset();
+
+  void summary(ShotSummary &out) const;
+
+  static const char *metricName(ShotMetric metric);
+
+  // Bumped whenever the summary changes.
+  uint32_t revision() const { return rev; }
+
+private:
+  struct Metric {
+    RunningStats stats;
+    P2Quantile p50;
+    P2Quantile p95;
+    float last;
+
+    Metric() : p50(0.5f), p95(0.95f), last(0.0f) {}
+  };
+
+  void startShot(uint32_t ms);
+  void finishShot(uint32_t ms);
+  // Returns true if `value` is out of control against the shots so far.
+  bool record(ShotMetric metric, float value);
+
+  Metric metrics[SHOT_METRIC_COUNT];
+  uint32_t shots = 0;
+  uint32_t outOfControl = 0;
+  uint32_t lastFlags = 0;
+  uint32_t rev = 0;
+
+  char lastState[24] = "";
+  bool inShot = false;
+  bool fillOpen = false; // still in the shot's first state
+  uint32_t shotStartMs = 0;
+  uint32_t fillMs = 0;
+  bool haveLastStart = false;
+  uint32_t lastStartMs = 0;
+  float position = 0.0f;
+  bool havePosition = false;
+  float travel = 0.0f; // turns
+};
+
+#endif // SHOT_STATS_H
@@ -1,11 +1,81 @@
 #include "storage.h"
+#include "flash_log.h"
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 namespace Storage {
 
 static const char *MOULDS_FILE = "/moulds.bin";
+static const char *MOULD_DIR = "/moulds";
+static const char *MOULD_LOG_FILE = "/moulds/log.bin";
+static const char *MOULD_LOG_TMP_FILE = "/moulds/log.tmp";
+static const char *MOULD_LOG_BAD_FILE = "/moulds/log.bad";
+// Data partition that holds the log instead, when the partition table has it.
+static const char *MOULD_PARTITION = "moulds";
+
+// Log header: magic, version, header size, generation, last issued id, CRC.
+static const uint32_t LOG_MAGIC = 0x31474c4d; // "MLG1"
+static const uint16_t LOG_VERSION = 1;
+static const size_t LOG_HEADER_SIZE = 20;
+// Frame header: magic, type, flags, payload length, id, CRC of everything
+// after the magic including the payload. All fields little-endian.
+static const uint32_t FRAME_MAGIC = 0x4d524652; // "RFRM"
+static const size_t FRAME_HEADER_SIZE = 16;
+static const size_t MAX_PAYLOAD = 256;
+static const size_t RECORD_PAYLOAD_SIZE = 88;
+static const size_t USE_PAYLOAD_SIZE = 4;
+// Compact once garbage is both this large and more than the live data.
+static const uint32_t COMPACT_MIN_GARBAGE = 16 * 1024;
+
+static const char *SNAPSHOT_FILE = "/snapshot.bin";
+static const char *SNAPSHOT_TMP_FILE = "/snapshot.tmp";
+// Snapshot header: magic, version, reserved, payload size, payload CRC.
+static const uint32_t SNAPSHOT_MAGIC = 0x314e5357; // "WSN1"
+static const size_t SNAPSHOT_HEADER_SIZE = 16;
+
+enum FrameType : uint8_t {
+  FRAME_RECORD = 1,
+  FRAME_USE = 2,
+  FRAME_TOMBSTONE = 3,
+};
+
+// Where each live profile's latest record sits, in list order.
+struct LogSlot {
+  uint32_t id;
+  uint32_t offset;
+  uint32_t lastUsed;
+  uint16_t length;
+};
+
 static bool _initialized = false;
+static SemaphoreHandle_t _logMutex = nullptr;
+static LogSlot *_slots = nullptr;
+static int _slotCount = 0;
+static int _slotCapacity = 0;
+static bool _logReady = false;
+static bool _mapped = false; // the log lives in the partition, not a file
+static int _bank = -1;       // partition bank holding the log
+static uint32_t _logEnd = 0; // 0 until the log file exists
+// A failed append left bytes past _logEnd; appends wait for a compaction.
+static bool _tornTail = false;
+static uint32_t _generation = 0;
+static uint32_t _nextId = 0;
+static uint32_t _useClock = 0;
+
+class LogLock {
+public:
+  LogLock() {
+    if (_logMutex)
+      xSemaphoreTake(_logMutex, portMAX_DELAY);
+  }
+  ~LogLock() {
+    if (_logMutex)
+      xSemaphoreGive(_logMutex);
+  }
+};
 
 bool init() {
   if (_initialized)
@@ -14,8 +84,15 @@ bool init() {
     Serial.println("LittleFS Mount Failed");
     return false;
   }
+  if (!_logMutex) {
+    _logMutex = xSemaphoreCreateMutex();
+  }
+  _mapped = FlashLog::begin(MOULD_PARTITION);
   _initialized = true;
   Serial.println("LittleFS Mounted");
+  if (_mapped) {
+    Serial.println("Mould log: using the flash partition");
+  }
   return true;
 }
 
@@ -64,39 +141,827 @@ void loadMoulds(DisplayComms::MouldParams *moulds, int &count, int maxCount) {
   Serial.printf("Loaded %d mould profiles.\n", count);
 }
 
-void saveMoulds(const DisplayComms::MouldParams *moulds, int count) {
-  if (!_initialized) {
-    Serial.println("Storage not initialized, skipping save.");
-    // Attempt auto-init?
-    if (!init())
-      return;
+bool hasLegacyMoulds() {
+  return _initialized && LittleFS.exists(MOULDS_FILE);
+}
+
+void removeLegacyMoulds() {
+  if (_initialized && LittleFS.exists(MOULDS_FILE)) {
+    LittleFS.remove(MOULDS_FILE);
   }
+}
 
-  File file = LittleFS.open(MOULDS_FILE, FILE_WRITE);
-  if (!file) {
-    Serial.println("Failed to open moulds file for writing");
+// --- Encoding ---
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = v >> 24;
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t getU32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length) {
+  static const uint32_t TABLE[16] = {
+      0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+      0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+      0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+  crc = ~crc;
+  while (length--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ TABLE[crc & 0x0f];
+    crc = (crc >> 4) ^ TABLE[crc & 0x0f];
+  }
+  return ~crc;
+}
+
+static uint32_t frameCrc(const uint8_t *header, const uint8_t *payload,
+                         size_t length) {
+  uint32_t crc = crc32(0, header + 4, 8);
+  return crc32(crc, payload, length);
+}
+
+// Record payload v1: name[32], mode[4], then the float parameters in this
+// order. Fields are written one by one, so the format does not follow the
+// struct's layout; a shorter payload leaves later fields zero and a longer
+// one is read as far as this version knows.
+static float DisplayComms::MouldParams::*const RECORD_FLOATS[] = {
+    &DisplayComms::MouldParams::fillVolume,
+    &DisplayComms::MouldParams::fillSpeed,
+    &DisplayComms::MouldParams::fillPressure,
+    &DisplayComms::MouldParams::packVolume,
+    &DisplayComms::MouldParams::packSpeed,
+    &DisplayComms::MouldParams::packPressure,
+    &DisplayComms::MouldParams::packTime,
+    &DisplayComms::MouldParams::coolingTime,
+    &DisplayComms::MouldParams::fillAccel,
+    &DisplayComms::MouldParams::fillDecel,
+    &DisplayComms::MouldParams::packAccel,
+    &DisplayComms::MouldParams::packDecel,
+    &DisplayComms::MouldParams::injectTorque,
+};
+static const size_t RECORD_NAME_SIZE = 32;
+static const size_t RECORD_MODE_SIZE = 4;
+
+static void encodeMould(const DisplayComms::MouldParams &mould,
+                        uint8_t *out) {
+  memset(out, 0, RECORD_PAYLOAD_SIZE);
+  strncpy(reinterpret_cast<char *>(out), mould.name, RECORD_NAME_SIZE - 1);
+  strncpy(reinterpret_cast<char *>(out + RECORD_NAME_SIZE), mould.mode,
+          sizeof(mould.mode) - 1);
+  uint8_t *p = out + RECORD_NAME_SIZE + RECORD_MODE_SIZE;
+  for (auto field : RECORD_FLOATS) {
+    uint32_t bits;
+    memcpy(&bits, &(mould.*field), sizeof(bits));
+    putU32(p, bits);
+    p += 4;
+  }
+}
+
+static void decodeMould(const uint8_t *in, size_t length,
+                        DisplayComms::MouldParams &mould) {
+  mould = {};
+  if (length < RECORD_NAME_SIZE + RECORD_MODE_SIZE) {
     return;
   }
+  memcpy(mould.name, in, sizeof(mould.name) - 1);
+  memcpy(mould.mode, in + RECORD_NAME_SIZE, sizeof(mould.mode) - 1);
+  size_t offset = RECORD_NAME_SIZE + RECORD_MODE_SIZE;
+  for (auto field : RECORD_FLOATS) {
+    if (offset + 4 > length) {
+      break;
+    }
+    uint32_t bits = getU32(in + offset);
+    memcpy(&(mould.*field), &bits, sizeof(bits));
+    offset += 4;
+  }
+}
+
+// --- Slot table ---
+
+static int findSlot(uint32_t id) {
+  for (int i = 0; i < _slotCount; i++) {
+    if (_slots[i].id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int addSlot(uint32_t id) {
+  if (_slotCount == _slotCapacity) {
+    int capacity = _slotCapacity ? _slotCapacity * 2 : 64;
+    void *grown = nullptr;
+#ifdef BOARD_HAS_PSRAM
+    grown = ps_realloc(_slots, capacity * sizeof(LogSlot));
+#endif
+    if (!grown) {
+      grown = realloc(_slots, capacity * sizeof(LogSlot));
+    }
+    if (!grown) {
+      Serial.println("Mould log: slot table allocation failed");
+      return -1;
+    }
+    _slots = static_cast<LogSlot *>(grown);
+    _slotCapacity = capacity;
+  }
+  _slots[_slotCount] = {id, 0, 0, 0};
+  return _slotCount++;
+}
+
+static void removeSlot(int i, MouldIndexEntry *entries) {
+  memmove(&_slots[i], &_slots[i + 1], (_slotCount - i - 1) * sizeof(LogSlot));
+  if (entries) {
+    memmove(&entries[i], &entries[i + 1],
+            (_slotCount - i - 1) * sizeof(MouldIndexEntry));
+  }
+  _slotCount--;
+}
+
+// --- Log backend ---
+//
+// The log is /moulds/log.bin on LittleFS, or a bank of the "moulds" data
+// partition read in place through the flash mapping. A bank has no file
+// size; the log ends at the first erased frame header.
+
+struct LogReader {
+  File file;
+  const uint8_t *base; // mapped bank, or null to read `file`
+  uint32_t size;
+};
+
+// Where a compaction writes: the tmp file, or the spare bank.
+struct LogTarget {
+  File file;
+  int bank; // -1 for the tmp file
+  uint32_t offset;
+};
+
+static void ensureMouldDir() {
+  if (!LittleFS.exists(MOULD_DIR)) {
+    LittleFS.mkdir(MOULD_DIR);
+  }
+}
+
+static bool openReader(LogReader &reader) {
+  reader.base = nullptr;
+  reader.size = 0;
+  if (_mapped) {
+    if (_bank < 0) {
+      return false;
+    }
+    reader.base = FlashLog::bank(_bank);
+    reader.size = FlashLog::bankSize();
+    return true;
+  }
+  reader.file = LittleFS.open(MOULD_LOG_FILE, FILE_READ);
+  if (!reader.file) {
+    return false;
+  }
+  reader.size = reader.file.size();
+  return true;
+}
+
+static void closeReader(LogReader &reader) {
+  if (reader.file)
+    reader.file.close();
+}
+
+// Points at `length` bytes at `offset`: into the mapping, or read into
+// `scratch`.
+static const uint8_t *readAt(LogReader &reader, uint32_t offset,
+                             size_t length, uint8_t *scratch) {
+  if (offset + length > reader.size) {
+    return nullptr;
+  }
+  if (reader.base) {
+    return reader.base + offset;
+  }
+  if (!reader.file.seek(offset) ||
+      reader.file.read(scratch, length) != length) {
+    return nullptr;
+  }
+  return scratch;
+}
+
+// The whole frame at `offset` if it is intact, else null. `scratch` holds
+// FRAME_HEADER_SIZE + MAX_PAYLOAD bytes and is only filled for a file.
+static const uint8_t *viewFrame(LogReader &reader, uint32_t offset,
+                                uint8_t *scratch) {
+  const uint8_t *frame = readAt(reader, offset, FRAME_HEADER_SIZE, scratch);
+  if (!frame || getU32(frame) != FRAME_MAGIC) {
+    return nullptr;
+  }
+  uint16_t length = getU16(frame + 6);
+  if (length > MAX_PAYLOAD ||
+      !readAt(reader, offset + FRAME_HEADER_SIZE, length,
+              scratch + FRAME_HEADER_SIZE) ||
+      frameCrc(frame, frame + FRAME_HEADER_SIZE, length) !=
+          getU32(frame + 12)) {
+    return nullptr;
+  }
+  return frame;
+}
 
-  // Write count
-  if (file.write((const uint8_t *)&count, sizeof(count)) != sizeof(count)) {
-    Serial.println("Failed to write mould count");
+// Whether the log ends cleanly at `offset`: at the end of the file, or
+// where the bank is still erased.
+static bool tailClean(LogReader &reader, uint32_t offset) {
+  if (!reader.base) {
+    return offset >= reader.size;
+  }
+  uint32_t end = offset + FRAME_HEADER_SIZE;
+  if (end > reader.size) {
+    end = reader.size;
+  }
+  for (uint32_t i = offset; i < end; i++) {
+    if (reader.base[i] != 0xff) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void encodeLogHeader(uint8_t *head, uint32_t generation,
+                            uint32_t nextId) {
+  putU32(head, LOG_MAGIC);
+  putU16(head + 4, LOG_VERSION);
+  putU16(head + 6, LOG_HEADER_SIZE);
+  putU32(head + 8, generation);
+  putU32(head + 12, nextId);
+  putU32(head + 16, crc32(0, head, 16));
+}
+
+static bool validLogHeader(const uint8_t *head) {
+  return getU32(head) == LOG_MAGIC && getU16(head + 4) == LOG_VERSION &&
+         getU32(head + 16) == crc32(0, head, 16);
+}
+
+// The bank holding the newest whole log, or -1 if neither does.
+static int newestBank() {
+  int best = -1;
+  uint32_t generation = 0;
+  for (int b = 0; b < 2; b++) {
+    const uint8_t *head = FlashLog::bank(b);
+    if (validLogHeader(head) && (best < 0 || getU32(head + 8) > generation)) {
+      best = b;
+      generation = getU32(head + 8);
+    }
+  }
+  return best;
+}
+
+static bool logExists() {
+  return _mapped ? newestBank() >= 0 : LittleFS.exists(MOULD_LOG_FILE);
+}
+
+static bool createLog() {
+  uint8_t head[LOG_HEADER_SIZE];
+  encodeLogHeader(head, _generation, _nextId);
+  if (_mapped) {
+    // Neither bank holds a log, so bank 0 is free to take.
+    if (!FlashLog::erase(0) || !FlashLog::write(0, 0, head, sizeof(head))) {
+      return false;
+    }
+    _bank = 0;
+    return true;
+  }
+  ensureMouldDir();
+  File file = LittleFS.open(MOULD_LOG_FILE, FILE_WRITE);
+  bool ok = file && file.write(head, sizeof(head)) == sizeof(head);
+  if (file)
     file.close();
-    return;
+  return ok;
+}
+
+static bool writeLog(const uint8_t *data, size_t size) {
+  if (_mapped) {
+    return FlashLog::write(_bank, _logEnd, data, size);
+  }
+  File file = LittleFS.open(MOULD_LOG_FILE, FILE_APPEND);
+  if (!file) {
+    Serial.println("Mould log: failed to open for append");
+    return false;
+  }
+  bool ok = file.write(data, size) == size;
+  file.close();
+  return ok;
+}
+
+static bool beginRewrite(LogTarget &target, bool toFlash) {
+  target.offset = LOG_HEADER_SIZE;
+  if (toFlash) {
+    target.bank = _mapped && _bank >= 0 ? 1 - _bank : 0;
+    return FlashLog::erase(target.bank);
   }
+  target.bank = -1;
+  ensureMouldDir();
+  target.file = LittleFS.open(MOULD_LOG_TMP_FILE, FILE_WRITE);
+  uint8_t head[LOG_HEADER_SIZE];
+  encodeLogHeader(head, _generation + 1, _nextId);
+  return target.file && target.file.write(head, sizeof(head)) == sizeof(head);
+}
 
-  // Write profiles
-  for (int i = 0; i < count; i++) {
-    if (file.write((const uint8_t *)&moulds[i],
-                   sizeof(DisplayComms::MouldParams)) !=
-        sizeof(DisplayComms::MouldParams)) {
-      Serial.printf("Failed to write mould %d\n", i);
+static bool writeTarget(LogTarget &target, const uint8_t *data, size_t size) {
+  bool ok = target.bank >= 0
+                ? FlashLog::write(target.bank, target.offset, data, size)
+                : target.file.write(data, size) == size;
+  target.offset += size;
+  return ok;
+}
+
+// Makes the copy the log. A bank's header goes in last, so newestBank()
+// never picks a partial copy. Caller holds the lock.
+static bool commitRewrite(LogTarget &target) {
+  if (target.bank < 0) {
+    // LittleFS replaces the target atomically.
+    return LittleFS.rename(MOULD_LOG_TMP_FILE, MOULD_LOG_FILE);
+  }
+  uint8_t head[LOG_HEADER_SIZE];
+  encodeLogHeader(head, _generation + 1, _nextId);
+  if (!FlashLog::write(target.bank, 0, head, sizeof(head))) {
+    return false;
+  }
+  _bank = target.bank;
+  return true;
+}
+
+// --- Log ---
+
+static size_t encodeFrame(uint8_t *out, uint8_t type, uint32_t id,
+                          const uint8_t *payload, size_t length) {
+  putU32(out, FRAME_MAGIC);
+  out[4] = type;
+  out[5] = 0;
+  putU16(out + 6, length);
+  putU32(out + 8, id);
+  if (length) {
+    memcpy(out + FRAME_HEADER_SIZE, payload, length);
+  }
+  putU32(out + 12, frameCrc(out, out + FRAME_HEADER_SIZE, length));
+  return FRAME_HEADER_SIZE + length;
+}
+
+// Appends one frame and returns its offset, or 0 on failure. The frame is a
+// single write; a partial one fails its CRC on the next scan.
+static uint32_t appendFrame(uint8_t type, uint32_t id, const uint8_t *payload,
+                            size_t length) {
+  if (_logEnd == 0) {
+    if (!createLog()) {
+      Serial.println("Mould log: failed to create log");
+      return 0;
+    }
+    _logEnd = LOG_HEADER_SIZE;
+  }
+
+  if (_tornTail) {
+    return 0;
+  }
+  uint8_t frame[FRAME_HEADER_SIZE + MAX_PAYLOAD];
+  size_t size = encodeFrame(frame, type, id, payload, length);
+  if (_mapped && _logEnd + size > FlashLog::bankSize()) {
+    Serial.println("Mould log: partition bank full");
+    return 0;
+  }
+  if (!writeLog(frame, size)) {
+    Serial.println("Mould log: append failed");
+    _tornTail = true;
+    return 0;
+  }
+  uint32_t offset = _logEnd;
+  _logEnd += size;
+  return offset;
+}
+
+static void applyFrame(uint8_t type, uint32_t id, uint32_t offset,
+                       const uint8_t *payload, uint16_t length,
+                       MouldIndexEntry *entries, int maxCount) {
+  if (id > _nextId) {
+    _nextId = id;
+  }
+  int i = findSlot(id);
+  switch (type) {
+  case FRAME_RECORD:
+    if (i < 0) {
+      if (entries && _slotCount >= maxCount) {
+        Serial.printf("Mould log: more than %d profiles, ignoring %lu\n",
+                      maxCount, static_cast<unsigned long>(id));
+        return;
+      }
+      i = addSlot(id);
+      if (i < 0) {
+        return;
+      }
+      if (entries) {
+        entries[i] = {};
+        entries[i].id = id;
+      }
+    }
+    _slots[i].offset = offset;
+    _slots[i].length = length;
+    if (entries && length >= RECORD_NAME_SIZE) {
+      memcpy(entries[i].name, payload, sizeof(entries[i].name) - 1);
+      entries[i].name[sizeof(entries[i].name) - 1] = '\0';
+    }
+    break;
+  case FRAME_USE:
+    if (i >= 0 && length >= USE_PAYLOAD_SIZE) {
+      _slots[i].lastUsed = getU32(payload);
+      if (entries) {
+        entries[i].lastUsed = _slots[i].lastUsed;
+      }
+      if (_slots[i].lastUsed > _useClock) {
+        _useClock = _slots[i].lastUsed;
+      }
+    }
+    break;
+  case FRAME_TOMBSTONE:
+    if (i >= 0) {
+      removeSlot(i, entries);
+    }
+    break;
+  default:
+    break; // written by a newer version; skip it
+  }
+}
+
+// Rebuilds the slot table (and `entries`, if given) in one pass over the
+// log. Sets `torn` if the scan stopped short of the end of the log.
+static bool scanLog(MouldIndexEntry *entries, int maxCount, bool &torn) {
+  _slotCount = 0;
+  _logEnd = 0;
+  _generation = 0;
+  _nextId = 0;
+  _useClock = 0;
+  _tornTail = false;
+  torn = false;
+
+  if (_mapped) {
+    _bank = newestBank();
+  }
+  LogReader reader;
+  if (!openReader(reader)) {
+    return false;
+  }
+  uint8_t headBuffer[LOG_HEADER_SIZE];
+  const uint8_t *head = readAt(reader, 0, LOG_HEADER_SIZE, headBuffer);
+  if (!head || !validLogHeader(head)) {
+    // Only a file gets here; newestBank() already checked the banks.
+    closeReader(reader);
+    Serial.println("Mould log: bad header, setting the log aside");
+    LittleFS.rename(MOULD_LOG_FILE, MOULD_LOG_BAD_FILE);
+    return false;
+  }
+  _generation = getU32(head + 8);
+  _nextId = getU32(head + 12);
+
+  uint32_t offset = getU16(head + 6);
+  uint8_t scratch[FRAME_HEADER_SIZE + MAX_PAYLOAD];
+  const uint8_t *frame;
+  while ((frame = viewFrame(reader, offset, scratch)) != nullptr) {
+    uint16_t length = getU16(frame + 6);
+    applyFrame(frame[4], getU32(frame + 8), offset, frame + FRAME_HEADER_SIZE,
+               length, entries, maxCount);
+    offset += FRAME_HEADER_SIZE + length;
+  }
+  torn = !tailClean(reader, offset);
+  closeReader(reader);
+  _logEnd = offset;
+  _tornTail = torn;
+  return true;
+}
+
+static bool ensureLogReady() {
+  if (!_initialized && !init()) {
+    return false;
+  }
+  if (!_logReady) {
+    bool torn;
+    scanLog(nullptr, 0, torn);
+    _logReady = true;
+  }
+  return true;
+}
+
+// Copies the live frames into a fresh log on the tmp file or the spare bank,
+// then swaps it in. `toFlash` differing from the current backend moves the
+// log between LittleFS and the partition.
+static bool rewriteLog(bool toFlash) {
+  uint32_t started = millis();
+  uint32_t *offsets =
+      static_cast<uint32_t *>(malloc((_slotCount ? _slotCount : 1) * 4));
+  if (!offsets) {
+    return false;
+  }
+
+  // Only the storage task appends, so the table is stable while copying;
+  // readers keep using the old log until the commit below.
+  LogReader in;
+  LogTarget out = {};
+  bool ok = openReader(in);
+  ok = ok && beginRewrite(out, toFlash);
+  uint8_t frame[FRAME_HEADER_SIZE + MAX_PAYLOAD];
+  for (int i = 0; ok && i < _slotCount; i++) {
+    const uint8_t *view = viewFrame(in, _slots[i].offset, frame);
+    ok = view && getU32(view + 8) == _slots[i].id;
+    if (!ok) {
       break;
     }
+    size_t size = FRAME_HEADER_SIZE + getU16(view + 6);
+    // Flash writes run with the cache off, so the source can't be mapped.
+    if (view != frame) {
+      memcpy(frame, view, size);
+    }
+    offsets[i] = out.offset;
+    ok = writeTarget(out, frame, size);
+    if (ok && _slots[i].lastUsed) {
+      uint8_t stamp[USE_PAYLOAD_SIZE];
+      putU32(stamp, _slots[i].lastUsed);
+      size = encodeFrame(frame, FRAME_USE, _slots[i].id, stamp, sizeof(stamp));
+      ok = writeTarget(out, frame, size);
+    }
+  }
+  closeReader(in);
+  if (out.file)
+    out.file.close();
+
+  if (ok) {
+    LogLock lock;
+    ok = commitRewrite(out);
+    if (ok) {
+      for (int i = 0; i < _slotCount; i++) {
+        _slots[i].offset = offsets[i];
+      }
+      uint32_t before = _logEnd;
+      _logEnd = out.offset;
+      _generation++;
+      _tornTail = false;
+      _mapped = toFlash;
+      Serial.printf("Mould log: compacted %lu -> %lu bytes in %lu ms\n",
+                    static_cast<unsigned long>(before),
+                    static_cast<unsigned long>(out.offset),
+                    static_cast<unsigned long>(millis() - started));
+    }
+  }
+  if (!ok) {
+    Serial.println("Mould log: compaction failed");
+    if (!toFlash) {
+      LittleFS.remove(MOULD_LOG_TMP_FILE);
+    }
+  }
+  free(offsets);
+  return ok;
+}
+
+static bool compact() { return rewriteLog(_mapped); }
+
+// Moves a LittleFS log into the empty partition. If that fails the log stays
+// on LittleFS for this boot.
+static void migrateFileLog() {
+  bool torn;
+  _mapped = false;
+  if (!scanLog(nullptr, 0, torn)) {
+    _mapped = true;
+    return;
+  }
+  if (!rewriteLog(true)) {
+    Serial.println("Mould log: move to the partition failed, using LittleFS");
+    return;
+  }
+  LittleFS.remove(MOULD_LOG_FILE);
+  Serial.printf("Mould log: moved %d profiles into the partition.\n",
+                _slotCount);
+}
+
+void getLogStats(LogStats &stats) {
+  LogLock lock;
+  stats = {};
+  stats.fileBytes = _logEnd;
+  stats.liveBytes = _logEnd ? LOG_HEADER_SIZE : 0;
+  for (int i = 0; i < _slotCount; i++) {
+    stats.liveBytes += FRAME_HEADER_SIZE + _slots[i].length;
+    if (_slots[i].lastUsed) {
+      stats.liveBytes += FRAME_HEADER_SIZE + USE_PAYLOAD_SIZE;
+    }
+  }
+  stats.records = _slotCount;
+  stats.generation = _generation;
+  stats.capacity = _mapped ? FlashLog::bankSize() : 0;
+}
+
+bool compactIfNeeded() {
+  if (!_logReady || _logEnd == 0) {
+    return false;
+  }
+  LogStats stats;
+  getLogStats(stats);
+  uint32_t garbage = stats.fileBytes - stats.liveBytes;
+  // A bank can't grow, so near the end any sector's worth of garbage is
+  // worth reclaiming.
+  bool nearlyFull =
+      stats.capacity && stats.fileBytes + COMPACT_MIN_GARBAGE > stats.capacity;
+  if (!_tornTail && !(nearlyFull && garbage >= COMPACT_MIN_GARBAGE / 4) &&
+      (garbage < COMPACT_MIN_GARBAGE || garbage < stats.liveBytes)) {
+    return false;
+  }
+  return compact();
+}
+
+bool loadMouldIndex(MouldIndexHeader &header, MouldIndexEntry *entries,
+                    int maxCount) {
+  header = {};
+  if (!_initialized) {
+    return false;
+  }
+  LittleFS.remove(MOULD_LOG_TMP_FILE); // from an interrupted compaction
+  if (!logExists()) {
+    if (_mapped && LittleFS.exists(MOULD_LOG_FILE)) {
+      migrateFileLog();
+    }
   }
 
+  uint32_t started = millis();
+  bool found;
+  bool torn;
+  {
+    LogLock lock;
+    found = scanLog(entries, maxCount, torn);
+    _logReady = true;
+  }
+  if (!found) {
+    return false;
+  }
+  header.count = _slotCount;
+  header.nextId = _nextId;
+  header.useClock = _useClock;
+  Serial.printf("Mould log: %d profiles from %lu bytes%s in %lu ms\n",
+                _slotCount, static_cast<unsigned long>(_logEnd),
+                _mapped ? " (mapped)" : "",
+                static_cast<unsigned long>(millis() - started));
+
+  // Anything appended after a torn tail would be cut off by the next scan,
+  // so rewrite the log before the first append.
+  if (torn) {
+    Serial.println("Mould log: dropping torn tail");
+    compact();
+  }
+  return true;
+}
+
+bool saveMouldIndex(const MouldIndexHeader &header,
+                    const MouldIndexEntry *entries) {
+  if (!ensureLogReady()) {
+    return false;
+  }
+  LogLock lock;
+  if (header.nextId > _nextId) {
+    _nextId = header.nextId;
+  }
+  bool ok = true;
+  for (uint32_t e = 0; e < header.count; e++) {
+    int i = findSlot(entries[e].id);
+    if (i < 0 || _slots[i].lastUsed == entries[e].lastUsed) {
+      continue;
+    }
+    uint8_t stamp[USE_PAYLOAD_SIZE];
+    putU32(stamp, entries[e].lastUsed);
+    if (appendFrame(FRAME_USE, entries[e].id, stamp, sizeof(stamp)) == 0) {
+      ok = false;
+      continue;
+    }
+    _slots[i].lastUsed = entries[e].lastUsed;
+  }
+  return ok;
+}
+
+bool loadMouldRecord(uint32_t id, DisplayComms::MouldParams &mould) {
+  if (!ensureLogReady()) {
+    return false;
+  }
+  LogLock lock;
+  int i = findSlot(id);
+  if (i < 0) {
+    Serial.printf("Mould log: no record %lu\n", static_cast<unsigned long>(id));
+    return false;
+  }
+  LogReader reader;
+  if (!openReader(reader)) {
+    Serial.println("Mould log: failed to open for reading");
+    return false;
+  }
+  // Decoded straight from flash when the log is mapped.
+  uint8_t scratch[FRAME_HEADER_SIZE + MAX_PAYLOAD];
+  const uint8_t *frame = viewFrame(reader, _slots[i].offset, scratch);
+  bool ok = frame && getU32(frame + 8) == id;
+  if (ok) {
+    decodeMould(frame + FRAME_HEADER_SIZE, getU16(frame + 6), mould);
+  }
+  closeReader(reader);
+  if (!ok) {
+    Serial.printf("Mould log: record %lu failed its check\n",
+                  static_cast<unsigned long>(id));
+    return false;
+  }
+  return true;
+}
+
+bool saveMouldRecord(uint32_t id, const DisplayComms::MouldParams &mould) {
+  if (!ensureLogReady()) {
+    return false;
+  }
+  LogLock lock;
+  uint8_t payload[RECORD_PAYLOAD_SIZE];
+  encodeMould(mould, payload);
+  uint32_t offset = appendFrame(FRAME_RECORD, id, payload, sizeof(payload));
+  if (offset == 0) {
+    return false;
+  }
+  int i = findSlot(id);
+  if (i < 0) {
+    i = addSlot(id);
+    if (i < 0) {
+      return false;
+    }
+  }
+  _slots[i].offset = offset;
+  _slots[i].length = sizeof(payload);
+  if (id > _nextId) {
+    _nextId = id;
+  }
+  return true;
+}
+
+void removeMouldRecord(uint32_t id) {
+  if (!ensureLogReady()) {
+    return;
+  }
+  LogLock lock;
+  int i = findSlot(id);
+  if (i < 0) {
+    return;
+  }
+  if (appendFrame(FRAME_TOMBSTONE, id, nullptr, 0) != 0) {
+    removeSlot(i, nullptr);
+  }
+}
+
+// --- Snapshot ---
+
+bool loadSnapshot(uint16_t version, void *data, size_t size) {
+  if (!_initialized) {
+    return false;
+  }
+  File file = LittleFS.open(SNAPSHOT_FILE, FILE_READ);
+  if (!file) {
+    return false;
+  }
+  uint8_t *bytes = static_cast<uint8_t *>(data);
+  uint8_t head[SNAPSHOT_HEADER_SIZE];
+  bool ok = file.read(head, sizeof(head)) == sizeof(head) &&
+            getU32(head) == SNAPSHOT_MAGIC && getU16(head + 4) == version &&
+            getU32(head + 8) == size && file.read(bytes, size) == size &&
+            crc32(0, bytes, size) == getU32(head + 12);
   file.close();
-  Serial.printf("Saved %d mould profiles.\n", count);
+  if (!ok) {
+    Serial.println("Snapshot: stale layout or failed check, ignoring it");
+  }
+  return ok;
+}
+
+bool saveSnapshot(uint16_t version, const void *data, size_t size) {
+  if (!_initialized) {
+    return false;
+  }
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  uint8_t head[SNAPSHOT_HEADER_SIZE];
+  putU32(head, SNAPSHOT_MAGIC);
+  putU16(head + 4, version);
+  putU16(head + 6, 0);
+  putU32(head + 8, size);
+  putU32(head + 12, crc32(0, bytes, size));
+
+  File file = LittleFS.open(SNAPSHOT_TMP_FILE, FILE_WRITE);
+  bool ok = file && file.write(head, sizeof(head)) == sizeof(head) &&
+            file.write(bytes, size) == size;
+  if (file)
+    file.close();
+  // LittleFS replaces the target atomically.
+  ok = ok && LittleFS.rename(SNAPSHOT_TMP_FILE, SNAPSHOT_FILE);
+  if (!ok) {
+    Serial.println("Snapshot: save failed");
+    LittleFS.remove(SNAPSHOT_TMP_FILE);
+  }
+  return ok;
 }
 
 } // namespace Storage
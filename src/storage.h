@@ -6,9 +6,73 @@
 
 namespace Storage {
 
+// One row of the mould library index: enough to list and order profiles
+// without reading their parameter records.
+struct MouldIndexEntry {
+  uint32_t id;
+  uint32_t lastUsed; // MouldLibrary use clock, higher = more recent
+  char name[sizeof(DisplayComms::MouldParams::name)];
+};
+
+struct MouldIndexHeader {
+  uint32_t count;
+  uint32_t nextId;
+  uint32_t useClock;
+};
+
+struct LogStats {
+  uint32_t fileBytes;
+  uint32_t liveBytes; // frames a compaction would keep
+  uint32_t records;
+  uint32_t generation; // compactions so far
+  uint32_t capacity;   // partition bank size; 0 when the log is a file
+};
+
 bool init();
+
+// Pre-library single-file format (count + array), read once for migration.
+bool hasLegacyMoulds();
 void loadMoulds(DisplayComms::MouldParams *moulds, int &count, int maxCount);
-void saveMoulds(const DisplayComms::MouldParams *moulds, int count);
+void removeLegacyMoulds();
+
+// Mould profiles live in one append-only log: a versioned header, then
+// CRC-checked frames holding a record, a use stamp or a tombstone. Saving
+// appends one frame, so a reset mid-write can only lose that frame; its bad
+// CRC ends the boot scan and the tail is dropped.
+//
+// The log is /moulds/log.bin on LittleFS unless the partition table has a
+// "moulds" data partition. There it sits in one of two banks that are read
+// in place through the flash mapping, so the boot scan and record loads
+// touch no filesystem and copy nothing but the decoded fields. A LittleFS
+// log is moved into an empty partition on first boot.
+//
+// The index is rebuilt by one sequential scan: profiles in the order they
+// were first saved, names from their latest record.
+bool loadMouldIndex(MouldIndexHeader &header, MouldIndexEntry *entries,
+                    int maxCount);
+
+// Positions and names come from the records, so this only appends use stamps
+// that changed.
+bool saveMouldIndex(const MouldIndexHeader &header,
+                    const MouldIndexEntry *entries);
+
+bool loadMouldRecord(uint32_t id, DisplayComms::MouldParams &mould);
+bool saveMouldRecord(uint32_t id, const DisplayComms::MouldParams &mould);
+void removeMouldRecord(uint32_t id);
+
+// Rewrites the log with live frames only, once superseded records, stamps
+// and tombstones pass the garbage threshold. The new log replaces the old
+// by rename, or in the partition by writing the spare bank's header last,
+// so a reset mid-compaction leaves the old one intact. Run from the storage
+// task; it reads without holding the log lock.
+bool compactIfNeeded();
+void getLogStats(LogStats &stats);
+
+// Warm-start snapshot: one small CRC-checked file replaced by rename, so a
+// reset mid-write leaves the previous one. `version` guards the caller's
+// layout; a mismatch or bad CRC reads as no snapshot.
+bool loadSnapshot(uint16_t version, void *data, size_t size);
+bool saveSnapshot(uint16_t version, const void *data, size_t size);
 
 } // namespace Storage
 
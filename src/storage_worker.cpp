@@ -0,0 +1,374 @@
+#include "storage_worker.h"
+
+#include <Arduino.h>
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+namespace StorageWorker {
+
+namespace {
+
+constexpr int QUEUE_DEPTH = 16;
+constexpr uint32_t TASK_STACK = 6144;
+constexpr UBaseType_t TASK_PRIORITY = 1; // below the GUI and comms tasks
+constexpr BaseType_t TASK_CORE = 0;      // the GUI task owns core 1
+
+struct Slot {
+  bool used;
+  bool remove;
+  uint32_t id;
+  uint32_t version; // bumped on every request, so a rewrite isn't lost
+  DisplayComms::MouldParams mould;
+};
+
+// The pending index lives in one buffer and the worker writes from the
+// other; the two are swapped under the lock instead of copied.
+struct IndexBuffer {
+  Storage::MouldIndexEntry *entries;
+  uint32_t capacity;
+};
+
+QueueHandle_t queue = nullptr;
+SemaphoreHandle_t mutex = nullptr;
+
+Slot slots[MAX_PENDING_RECORDS];
+Storage::MouldIndexHeader pendingHeader = {};
+IndexBuffer pendingIndex = {};
+IndexBuffer writeIndex = {};
+bool indexDirty = false;
+uint8_t pendingSnapshot[MAX_SNAPSHOT_BYTES];
+uint8_t writeSnapshot[MAX_SNAPSHOT_BYTES]; // worker's copy while writing
+size_t snapshotSize = 0;
+uint16_t snapshotVersion = 0;
+bool snapshotDirty = false;
+bool busy = false;
+uint32_t nextTicket = 0;
+uint32_t stalls = 0;
+
+Report report = {};
+bool reportReady = false;
+
+class Lock {
+public:
+  Lock() { xSemaphoreTake(mutex, portMAX_DELAY); }
+  ~Lock() { xSemaphoreGive(mutex); }
+};
+
+bool reserve(IndexBuffer &buffer, uint32_t count) {
+  if (buffer.capacity >= count) {
+    return true;
+  }
+  size_t bytes = count * sizeof(Storage::MouldIndexEntry);
+  void *grown = nullptr;
+#ifdef BOARD_HAS_PSRAM
+  grown = ps_realloc(buffer.entries, bytes);
+#endif
+  if (!grown) {
+    grown = realloc(buffer.entries, bytes);
+  }
+  if (!grown) {
+    return false;
+  }
+  buffer.entries = static_cast<Storage::MouldIndexEntry *>(grown);
+  buffer.capacity = count;
+  return true;
+}
+
+// Caller holds the lock.
+Slot *findSlot(uint32_t id) {
+  Slot *free = nullptr;
+  for (Slot &slot : slots) {
+    if (slot.used && slot.id == id) {
+      return &slot;
+    }
+    if (!slot.used && !free) {
+      free = &slot;
+    }
+  }
+  return free;
+}
+
+// Every slot taken means a caller is stalled waiting for this batch.
+bool tableFull() {
+  Lock lock;
+  for (const Slot &slot : slots) {
+    if (!slot.used) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void wake() {
+  uint32_t ticket = nextTicket;
+  // A full queue already holds a wake-up; the request is in the table.
+  xQueueSend(queue, &ticket, 0);
+}
+
+// Claims the slot for `id` and fills it in. With every slot taken nothing
+// is queued: the caller is the GUI task and must not wait for flash.
+bool queueRecord(uint32_t id, bool remove,
+                 const DisplayComms::MouldParams *mould) {
+  {
+    Lock lock;
+    Slot *slot = findSlot(id);
+    if (!slot) {
+      // A full table already has a wake-up pending for the worker.
+      stalls++;
+      return false;
+    }
+    slot->used = true;
+    slot->remove = remove;
+    slot->id = id;
+    slot->version++;
+    if (mould) {
+      slot->mould = *mould;
+    }
+    nextTicket++;
+  }
+  wake();
+  return true;
+}
+
+void writeBatch(uint16_t requests) {
+  Slot batch[MAX_PENDING_RECORDS];
+  int batchCount = 0;
+  Storage::MouldIndexHeader header = {};
+  bool writeHeader = false;
+  size_t snapshotBytes = 0;
+  uint16_t version = 0;
+  uint32_t ticket;
+  {
+    Lock lock;
+    for (const Slot &slot : slots) {
+      if (slot.used) {
+        batch[batchCount++] = slot;
+      }
+    }
+    if (indexDirty) {
+      IndexBuffer spare = writeIndex;
+      writeIndex = pendingIndex;
+      pendingIndex = spare;
+      header = pendingHeader;
+      indexDirty = false;
+      writeHeader = true;
+    }
+    if (snapshotDirty) {
+      memcpy(writeSnapshot, pendingSnapshot, snapshotSize);
+      snapshotBytes = snapshotSize;
+      version = snapshotVersion;
+      snapshotDirty = false;
+    }
+    ticket = nextTicket;
+    busy = true;
+  }
+
+  uint32_t start = millis();
+  bool ok = true;
+  uint16_t writes = 0;
+  for (int i = 0; i < batchCount; i++) {
+    if (!batch[i].remove) {
+      ok = Storage::saveMouldRecord(batch[i].id, batch[i].mould) && ok;
+      writes++;
+    }
+  }
+  if (writeHeader) {
+    ok = Storage::saveMouldIndex(header, writeIndex.entries) && ok;
+    writes++;
+  }
+  for (int i = 0; i < batchCount; i++) {
+    if (batch[i].remove) {
+      Storage::removeMouldRecord(batch[i].id);
+      writes++;
+    }
+  }
+  if (snapshotBytes) {
+    ok = Storage::saveSnapshot(version, writeSnapshot, snapshotBytes) && ok;
+    writes++;
+  }
+  uint32_t elapsed = millis() - start;
+
+  Lock lock;
+  for (int i = 0; i < batchCount; i++) {
+    for (Slot &slot : slots) {
+      if (slot.used && slot.id == batch[i].id &&
+          slot.version == batch[i].version) {
+        slot.used = false;
+      }
+    }
+  }
+  busy = false;
+  report = {ticket, ok, requests, writes, elapsed};
+  reportReady = true;
+}
+
+void workerTask(void *) {
+  uint32_t ticket;
+  for (;;) {
+    if (xQueueReceive(queue, &ticket, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    uint16_t requests = 1;
+    uint32_t first = millis();
+    while (!tableFull() && millis() - first < MAX_DELAY_MS &&
+           xQueueReceive(queue, &ticket, pdMS_TO_TICKS(SETTLE_MS)) == pdTRUE) {
+      requests++;
+    }
+    writeBatch(requests);
+    Storage::compactIfNeeded();
+  }
+}
+
+} // namespace
+
+bool begin() {
+  if (queue) {
+    return true;
+  }
+  mutex = xSemaphoreCreateMutex();
+  queue = xQueueCreate(QUEUE_DEPTH, sizeof(uint32_t));
+  if (!mutex || !queue ||
+      xTaskCreatePinnedToCore(workerTask, "storage", TASK_STACK, nullptr,
+                              TASK_PRIORITY, nullptr,
+                              TASK_CORE) != pdPASS) {
+    Serial.println("StorageWorker: start FAILED, writes stay synchronous");
+    if (queue) {
+      vQueueDelete(queue);
+      queue = nullptr;
+    }
+    return false;
+  }
+  Serial.println("StorageWorker: started");
+  return true;
+}
+
+bool running() { return queue != nullptr; }
+
+bool saveRecord(uint32_t id, const DisplayComms::MouldParams &mould) {
+  if (!running()) {
+    return Storage::saveMouldRecord(id, mould);
+  }
+  return queueRecord(id, false, &mould);
+}
+
+bool saveIndex(const Storage::MouldIndexHeader &header,
+               const Storage::MouldIndexEntry *entries) {
+  if (!running()) {
+    return Storage::saveMouldIndex(header, entries);
+  }
+  {
+    Lock lock;
+    if (!reserve(pendingIndex, header.count)) {
+      Serial.println("StorageWorker: index buffer allocation FAILED");
+      return false;
+    }
+    pendingHeader = header;
+    memcpy(pendingIndex.entries, entries,
+           header.count * sizeof(Storage::MouldIndexEntry));
+    indexDirty = true;
+    nextTicket++;
+  }
+  wake();
+  return true;
+}
+
+bool removeRecord(uint32_t id) {
+  if (!running()) {
+    Storage::removeMouldRecord(id);
+    return true;
+  }
+  return queueRecord(id, true, nullptr);
+}
+
+bool saveSnapshot(uint16_t version, const void *data, size_t size) {
+  if (size > MAX_SNAPSHOT_BYTES) {
+    return false;
+  }
+  if (!running()) {
+    return Storage::saveSnapshot(version, data, size);
+  }
+  {
+    Lock lock;
+    memcpy(pendingSnapshot, data, size);
+    snapshotSize = size;
+    snapshotVersion = version;
+    snapshotDirty = true;
+    nextTicket++;
+  }
+  wake();
+  return true;
+}
+
+bool loadRecord(uint32_t id, DisplayComms::MouldParams &mould) {
+  if (running()) {
+    Lock lock;
+    for (const Slot &slot : slots) {
+      if (slot.used && slot.id == id) {
+        if (slot.remove) {
+          return false;
+        }
+        mould = slot.mould;
+        return true;
+      }
+    }
+  }
+  return Storage::loadMouldRecord(id, mould);
+}
+
+uint32_t lastTicket() {
+  if (!running()) {
+    return 0;
+  }
+  Lock lock;
+  return nextTicket;
+}
+
+bool takeReport(Report &out) {
+  if (!running()) {
+    return false;
+  }
+  Lock lock;
+  if (!reportReady) {
+    return false;
+  }
+  out = report;
+  reportReady = false;
+  return true;
+}
+
+bool idle() {
+  if (!running()) {
+    return true;
+  }
+  Lock lock;
+  if (busy || indexDirty || snapshotDirty) {
+    return false;
+  }
+  for (const Slot &slot : slots) {
+    if (slot.used) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int freeSlots() {
+  if (!running()) {
+    return MAX_PENDING_RECORDS;
+  }
+  Lock lock;
+  int free = 0;
+  for (const Slot &slot : slots) {
+    if (!slot.used) {
+      free++;
+    }
+  }
+  return free;
+}
+
+uint32_t stallCount() { return stalls; }
+
+} // namespace StorageWorker
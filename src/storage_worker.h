@@ -0,0 +1,69 @@
+#ifndef STORAGE_WORKER_H
+#define STORAGE_WORKER_H
+
+#include "storage.h"
+
+#include <cstdint>
+
+// Background writer for the mould library. Requests are recorded in a small
+// pending table and the worker task is woken through a queue; it waits for
+// the burst to settle, then writes each pending record, the index and any
+// removals once. Repeated saves of the same record or of the index before
+// that point cost a single flash write.
+//
+// Until begin() runs, every request is written synchronously, so boot-time
+// migration keeps its ordering guarantees.
+namespace StorageWorker {
+
+constexpr int MAX_PENDING_RECORDS = 8;
+constexpr uint32_t SETTLE_MS = 100;    // quiet time that ends a burst
+constexpr uint32_t MAX_DELAY_MS = 500; // upper bound on batching a burst
+constexpr size_t MAX_SNAPSHOT_BYTES = 512;
+
+struct Report {
+  uint32_t ticket;   // last request covered by this batch
+  bool ok;           // every write in the batch succeeded
+  uint16_t requests; // requests coalesced into the batch
+  uint16_t writes;   // record, index, remove and snapshot writes
+  uint32_t ms;       // time spent writing
+};
+
+bool begin();
+bool running();
+
+// All three return true once the request is queued (or, before begin(),
+// once it is written). Saving a record supersedes a pending removal of the
+// same id and vice versa. None of them waits: saveRecord() and
+// removeRecord() return false while the pending table is full, and the
+// caller tries again on a later tick.
+bool saveRecord(uint32_t id, const DisplayComms::MouldParams &mould);
+bool saveIndex(const Storage::MouldIndexHeader &header,
+               const Storage::MouldIndexEntry *entries);
+bool removeRecord(uint32_t id);
+
+// Coalesces like the index: only the newest pending snapshot is written.
+bool saveSnapshot(uint16_t version, const void *data, size_t size);
+
+// Reads through pending writes, so a record is never seen older than the
+// last save request for it.
+bool loadRecord(uint32_t id, DisplayComms::MouldParams &mould);
+
+// Ticket of the latest request; compare with Report::ticket to tell when it
+// has reached flash.
+uint32_t lastTicket();
+
+// True once per finished batch, for the GUI task to poll.
+bool takeReport(Report &report);
+
+// Nothing pending or being written.
+bool idle();
+
+// Pending-table slots free for new record ids.
+int freeSlots();
+
+// Times a record request found the pending table full.
+uint32_t stallCount();
+
+} // namespace StorageWorker
+
+#endif // STORAGE_WORKER_H
@@ -0,0 +1,124 @@
+#include "stream_stats.h"
+
+#include <cmath>
+
+void RunningStats::add(float value) {
+  n++;
+  if (n == 1) {
+    lo = hi = value;
+  } else if (value < lo) {
+    lo = value;
+  } else if (value > hi) {
+    hi = value;
+  }
+  double delta = value - m;
+  m += delta / n;
+  m2 += delta * (value - m);
+}
+
+void RunningStats::reset() { *this = RunningStats(); }
+
+float RunningStats::variance() const {
+  return n > 1 ? static_cast<float>(m2 / (n - 1)) : 0.0f;
+}
+
+float RunningStats::stddev() const { return sqrtf(variance()); }
+
+void P2Quantile::add(float value) {
+  if (n < MARKERS) {
+    // Kept sorted by insertion until the markers can start.
+    int i = static_cast<int>(n);
+    while (i > 0 && heights[i - 1] > value) {
+      heights[i] = heights[i - 1];
+      i--;
+    }
+    heights[i] = value;
+    n++;
+    if (n == MARKERS) {
+      for (int m = 0; m < MARKERS; m++) {
+        positions[m] = m + 1;
+      }
+      desired[0] = 1.0f;
+      desired[1] = 1.0f + 2.0f * p;
+      desired[2] = 1.0f + 4.0f * p;
+      desired[3] = 3.0f + 2.0f * p;
+      desired[4] = 5.0f;
+    }
+    return;
+  }
+  n++;
+
+  // Cell the sample falls in; the end markers track min and max.
+  int k;
+  if (value < heights[0]) {
+    heights[0] = value;
+    k = 0;
+  } else if (value >= heights[MARKERS - 1]) {
+    heights[MARKERS - 1] = value;
+    k = MARKERS - 2;
+  } else {
+    k = 0;
+    while (value >= heights[k + 1]) {
+      k++;
+    }
+  }
+  for (int i = k + 1; i < MARKERS; i++) {
+    positions[i]++;
+  }
+  const float step[MARKERS] = {0.0f, p / 2.0f, p, (1.0f + p) / 2.0f, 1.0f};
+  for (int i = 0; i < MARKERS; i++) {
+    desired[i] += step[i];
+  }
+
+  // Move the middle markers one position towards where they should be.
+  for (int i = 1; i < MARKERS - 1; i++) {
+    float off = desired[i] - positions[i];
+    if ((off >= 1.0f && positions[i + 1] - positions[i] > 1) ||
+        (off <= -1.0f && positions[i - 1] - positions[i] < -1)) {
+      int d = off > 0 ? 1 : -1;
+      float h = parabolic(i, d);
+      if (heights[i - 1] < h && h < heights[i + 1]) {
+        heights[i] = h;
+      } else {
+        heights[i] = linear(i, d);
+      }
+      positions[i] += d;
+    }
+  }
+}
+
+void P2Quantile::reset() {
+  n = 0;
+  for (int i = 0; i < MARKERS; i++) {
+    heights[i] = 0.0f;
+    positions[i] = 0;
+    desired[i] = 0.0f;
+  }
+}
+
+float P2Quantile::value() const {
+  if (n == 0) {
+    return 0.0f;
+  }
+  if (n < MARKERS) {
+    // Nearest rank among the samples so far.
+    int rank = static_cast<int>(lroundf(p * (n - 1)));
+    return heights[rank];
+  }
+  return heights[2];
+}
+
+float P2Quantile::parabolic(int i, int d) const {
+  float below = static_cast<float>(positions[i] - positions[i - 1]);
+  float above = static_cast<float>(positions[i + 1] - positions[i]);
+  float span = static_cast<float>(positions[i + 1] - positions[i - 1]);
+  return heights[i] +
+         d / span *
+             ((below + d) * (heights[i + 1] - heights[i]) / above +
+              (above - d) * (heights[i] - heights[i - 1]) / below);
+}
+
+float P2Quantile::linear(int i, int d) const {
+  return heights[i] + d * (heights[i + d] - heights[i]) /
+                          (positions[i + d] - positions[i]);
+}
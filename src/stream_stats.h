@@ -0,0 +1,56 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <cstdint>
+
+// Running mean and variance (Welford), plus min and max. Constant memory
+// and numerically stable however many samples go in.
+class RunningStats {
+public:
+  void add(float value);
+  void reset();
+
+  uint32_t count() const { return n; }
+  float mean() const { return static_cast<float>(m); }
+  // Sample variance; 0 until there are two samples.
+  float variance() const;
+  float stddev() const;
+  float min() const { return lo; }
+  float max() const { return hi; }
+
+private:
+  uint32_t n = 0;
+  double m = 0.0;
+  double m2 = 0.0; // sum of squared differences from the mean
+  float lo = 0.0f;
+  float hi = 0.0f;
+};
+
+// One streaming quantile estimate (the P-squared algorithm of Jain and
+// Chlamtac): five markers whose heights are nudged towards the quantile as
+// samples arrive. Exact for the first five samples, then O(1) per sample.
+class P2Quantile {
+public:
+  explicit P2Quantile(float quantile) : p(quantile) {}
+
+  void add(float value);
+  void reset();
+
+  uint32_t count() const { return n; }
+  // 0 until the first sample.
+  float value() const;
+
+private:
+  static constexpr int MARKERS = 5;
+
+  float parabolic(int i, int d) const;
+  float linear(int i, int d) const;
+
+  float p;
+  uint32_t n = 0;
+  float heights[MARKERS] = {};
+  int32_t positions[MARKERS] = {}; // 1-based, as in the paper
+  float desired[MARKERS] = {};
+};
+
+#endif // STREAM_STATS_H
@@ -0,0 +1,144 @@
+#include "style_cache.h"
+
+namespace StyleCache {
+
+namespace {
+
+struct Prop {
+  lv_style_prop_t prop;
+  lv_style_selector_t selector;
+  int32_t value;
+};
+
+struct Entry {
+  lv_obj_t *obj;
+  uint8_t count;
+  Prop props[MAX_PROPS];
+};
+
+Entry entries[MAX_OBJECTS];
+int tracked = 0;
+uint32_t writes = 0;
+uint32_t suppressed = 0;
+
+void onDelete(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target_obj(e);
+  for (Entry &entry : entries) {
+    if (entry.obj == obj) {
+      entry.obj = nullptr;
+      tracked--;
+      return;
+    }
+  }
+}
+
+Entry *findEntry(lv_obj_t *obj) {
+  Entry *free = nullptr;
+  for (Entry &entry : entries) {
+    if (entry.obj == obj) {
+      return &entry;
+    }
+    if (!entry.obj && !free) {
+      free = &entry;
+    }
+  }
+  if (!free) {
+    return nullptr;
+  }
+  free->obj = obj;
+  free->count = 0;
+  tracked++;
+  lv_obj_add_event_cb(obj, onDelete, LV_EVENT_DELETE, nullptr);
+  return free;
+}
+
+// True if the write must go through, recording `value` as applied. Objects
+// or properties past the table's capacity are always written.
+bool needsWrite(lv_obj_t *obj, lv_style_prop_t prop,
+                lv_style_selector_t selector, int32_t value) {
+  Entry *entry = findEntry(obj);
+  if (!entry) {
+    writes++;
+    return true;
+  }
+  for (int i = 0; i < entry->count; i++) {
+    Prop &p = entry->props[i];
+    if (p.prop == prop && p.selector == selector) {
+      if (p.value == value) {
+        suppressed++;
+        return false;
+      }
+      p.value = value;
+      writes++;
+      return true;
+    }
+  }
+  if (entry->count < MAX_PROPS) {
+    entry->props[entry->count++] = {prop, selector, value};
+  }
+  writes++;
+  return true;
+}
+
+} // namespace
+
+void setPos(lv_obj_t *obj, int32_t x, int32_t y) {
+  if (!obj) {
+    return;
+  }
+  // Evaluate both so each coordinate's cached value stays current.
+  bool moveX = needsWrite(obj, LV_STYLE_X, 0, x);
+  bool moveY = needsWrite(obj, LV_STYLE_Y, 0, y);
+  if (moveX || moveY) {
+    lv_obj_set_pos(obj, x, y);
+  }
+}
+
+void setSize(lv_obj_t *obj, int32_t w, int32_t h) {
+  if (!obj) {
+    return;
+  }
+  bool resizeW = needsWrite(obj, LV_STYLE_WIDTH, 0, w);
+  bool resizeH = needsWrite(obj, LV_STYLE_HEIGHT, 0, h);
+  if (resizeW || resizeH) {
+    lv_obj_set_size(obj, w, h);
+  }
+}
+
+void setHidden(lv_obj_t *obj, bool hidden) {
+  if (!obj) {
+    return;
+  }
+  if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) == hidden) {
+    suppressed++;
+    return;
+  }
+  writes++;
+  if (hidden) {
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+  } else {
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+void setState(lv_obj_t *obj, lv_state_t state, bool on) {
+  if (!obj) {
+    return;
+  }
+  if (lv_obj_has_state(obj, state) == on) {
+    suppressed++;
+    return;
+  }
+  writes++;
+  if (on) {
+    lv_obj_add_state(obj, state);
+  } else {
+    lv_obj_remove_state(obj, state);
+  }
+}
+
+uint32_t writeCount() { return writes; }
+uint32_t suppressedCount() { return suppressed; }
+int trackedObjects() { return tracked; }
+
+} // namespace StyleCache
@@ -0,0 +1,36 @@
+#ifndef STYLE_CACHE_H
+#define STYLE_CACHE_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Setters for the geometry and states PrdUi changes at run time. The last
+// value written per object and property is remembered, and writing the same
+// value again is skipped: lv_obj_set_style_*() refreshes the object's style
+// and invalidates it even when nothing changed. Colours and borders come from
+// UiStyles and change through states.
+//
+// Entries are dropped from the object's LV_EVENT_DELETE. A property should
+// be written only through this layer once it is, or the cache goes stale.
+namespace StyleCache {
+
+constexpr int MAX_OBJECTS = 48;
+constexpr int MAX_PROPS = 6; // per object
+
+void setPos(lv_obj_t *obj, int32_t x, int32_t y);
+void setSize(lv_obj_t *obj, int32_t w, int32_t h);
+
+// Adding LV_OBJ_FLAG_HIDDEN invalidates the object even if it was already
+// hidden; the flag itself is the cache here.
+void setHidden(lv_obj_t *obj, bool hidden);
+
+// Adds or clears a user state (see UiStyles); the state is the cache.
+void setState(lv_obj_t *obj, lv_state_t state, bool on);
+
+uint32_t writeCount();
+uint32_t suppressedCount();
+int trackedObjects();
+
+} // namespace StyleCache
+
+#endif // STYLE_CACHE_H
@@ -148,6 +148,10 @@ void action_update_refill_bands(lv_event_t * e) {
     float current_y = BARREL_HEIGHT_PX;
     
     for (int i = 0; i < MAX_REFILLS; i++) {
+        // PrdUi releases the legacy band objects in favour of its own plunger widget
+        if (!bands[i]) {
+            continue;
+        }
         if (i < plungerState.refillCount) {
             float size_mm = plungerState.refills[i].size;
             float height_px = size_mm * SCALE_FACTOR;
@@ -0,0 +1,129 @@
+#include "ui_model.h"
+
+#include <cstring>
+
+namespace UiModel {
+
+lv_subject_t position;
+lv_subject_t temperature;
+lv_subject_t encoderSample;
+lv_subject_t state;
+lv_subject_t motion;
+lv_subject_t error;
+lv_subject_t mould;
+lv_subject_t common;
+lv_subject_t refill;
+lv_subject_t shots;
+lv_subject_t safe;
+lv_subject_t stale;
+
+namespace {
+
+constexpr size_t STATE_SIZE = sizeof(DisplayComms::Status::state);
+
+char stateBuf[STATE_SIZE] = "";
+char statePrevBuf[STATE_SIZE] = "";
+lv_subject_t *motionMembers[] = {&encoderSample, &state};
+
+DisplayComms::Status published = {};
+DisplayComms::MouldParams publishedMould = {};
+DisplayComms::CommonParams publishedCommon = {};
+bool ready = false;
+
+uint32_t sets = 0;
+uint32_t skips = 0;
+
+int32_t toFixed(float value, float scale) {
+  float scaled = value * scale;
+  return static_cast<int32_t>(scaled >= 0 ? scaled + 0.5f : scaled - 0.5f);
+}
+
+// lv_subject_set_int() notifies even when the value is unchanged.
+void setInt(lv_subject_t *subject, int32_t value) {
+  if (lv_subject_get_int(subject) == value) {
+    skips++;
+    return;
+  }
+  sets++;
+  lv_subject_set_int(subject, value);
+}
+
+} // namespace
+
+void init() {
+  if (ready) {
+    return;
+  }
+  lv_subject_init_int(&position, 0);
+  lv_subject_init_int(&temperature, 0);
+  lv_subject_init_int(&encoderSample, 0);
+  lv_subject_init_string(&state, stateBuf, statePrevBuf, STATE_SIZE, "");
+  lv_subject_init_group(&motion, motionMembers,
+                        sizeof(motionMembers) / sizeof(motionMembers[0]));
+  lv_subject_init_int(&error, 0);
+  lv_subject_init_int(&mould, 0);
+  lv_subject_init_int(&common, 0);
+  lv_subject_init_int(&refill, 0);
+  lv_subject_init_int(&shots, 0);
+  lv_subject_init_int(&safe, 0);
+  lv_subject_init_int(&stale, 0);
+  ready = true;
+}
+
+void publish(const DisplayComms::Status &nextStatus,
+             const DisplayComms::MouldParams &nextMould,
+             const DisplayComms::CommonParams &nextCommon, bool isSafe) {
+  if (!ready) {
+    return;
+  }
+  // Observers may read any part of the snapshot, so it is stored in full
+  // before the first notification goes out.
+  bool errorChanged = nextStatus.errorCode != published.errorCode ||
+                      strcmp(nextStatus.errorMsg, published.errorMsg) != 0;
+  bool stateChanged = strcmp(nextStatus.state, stateBuf) != 0;
+  bool mouldChanged = !DisplayComms::sameMould(nextMould, publishedMould);
+  bool commonChanged =
+      memcmp(&nextCommon, &publishedCommon, sizeof(nextCommon)) != 0;
+  published = nextStatus;
+  if (mouldChanged) {
+    publishedMould = nextMould;
+  }
+  if (commonChanged) {
+    publishedCommon = nextCommon;
+  }
+
+  setInt(&position, toFixed(nextStatus.encoderTurns, 100.0f));
+  setInt(&temperature, toFixed(nextStatus.tempC, 10.0f));
+  setInt(&encoderSample, static_cast<int32_t>(nextStatus.encoderSampleCount));
+  if (stateChanged) {
+    sets++;
+    lv_subject_copy_string(&state, nextStatus.state);
+  } else {
+    skips++;
+  }
+  setInt(&safe, isSafe ? 1 : 0);
+
+  lv_subject_t *revisions[] = {&error, &mould, &common};
+  bool changed[] = {errorChanged, mouldChanged, commonChanged};
+  for (int i = 0; i < 3; i++) {
+    if (changed[i]) {
+      bump(revisions[i]);
+    } else {
+      skips++;
+    }
+  }
+}
+
+void bump(lv_subject_t *revision) {
+  sets++;
+  lv_subject_set_int(revision, lv_subject_get_int(revision) + 1);
+}
+
+const DisplayComms::Status &lastStatus() { return published; }
+const DisplayComms::MouldParams &lastMould() { return publishedMould; }
+const DisplayComms::CommonParams &lastCommon() { return publishedCommon; }
+
+uint32_t setCount() { return sets; }
+uint32_t skipCount() { return skips; }
+
+} // namespace UiModel
@@ -0,0 +1,56 @@
+#ifndef UI_MODEL_H
+#define UI_MODEL_H
+
+#include "display_comms.h"
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Machine data as LVGL subjects. DisplayComms fills its structs outside the
+// LVGL thread, so PrdUi::tick() hands a snapshot to publish(), which diffs
+// it against the last one and sets only the subjects whose value moved.
+// Observers therefore run on the LVGL thread and only on change; a quiet
+// machine costs a handful of compares per tick.
+namespace UiModel {
+
+// Integer subjects carry fixed-point values: position in hundredths of a
+// turn, temperature in tenths of a degree.
+extern lv_subject_t position;
+extern lv_subject_t temperature;
+// Bumped on every ENC line, even when the position repeats.
+extern lv_subject_t encoderSample;
+extern lv_subject_t state; // string
+// Group of encoderSample and state, for logic that follows plunger motion.
+extern lv_subject_t motion;
+// Revision counters; read the data itself through the getters below.
+extern lv_subject_t error;
+extern lv_subject_t mould;
+extern lv_subject_t common;
+extern lv_subject_t refill; // bumped by PrdUi when the block stack changes
+extern lv_subject_t shots;  // bumped by PrdUi when the shot summary changes
+extern lv_subject_t safe;   // 0/1, DisplayComms::isSafeForUpdate()
+// DisplayComms::Received bits still showing warm-start snapshot values
+// rather than live data; 0 once the controller has reported each of them.
+extern lv_subject_t stale;
+
+void init();
+
+// Call from the LVGL thread only.
+void publish(const DisplayComms::Status &nextStatus,
+             const DisplayComms::MouldParams &nextMould,
+             const DisplayComms::CommonParams &nextCommon, bool isSafe);
+
+void bump(lv_subject_t *revision);
+
+// The last published snapshot.
+const DisplayComms::Status &lastStatus();
+const DisplayComms::MouldParams &lastMould();
+const DisplayComms::CommonParams &lastCommon();
+
+// Subjects set vs. left alone by publish(), for the debug console.
+uint32_t setCount();
+uint32_t skipCount();
+
+} // namespace UiModel
+
+#endif // UI_MODEL_H
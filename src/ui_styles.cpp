@@ -0,0 +1,179 @@
+#include "ui_styles.h"
+
+#include <initializer_list>
+
+namespace UiStyles {
+
+namespace {
+
+constexpr int MAX_PARTS = 4;
+
+struct Part {
+  lv_style_t *style;
+  lv_style_selector_t selector;
+};
+
+struct KindStyles {
+  Part parts[MAX_PARTS];
+  int count;
+};
+
+lv_style_t button;
+lv_style_t panel;
+lv_style_t panelError;
+lv_style_t list;
+lv_style_t formPad;
+lv_style_t row;
+lv_style_t rowCurrent;
+lv_style_t rowSelected;
+lv_style_t field;
+lv_style_t notice;
+lv_style_t noticeOk;
+lv_style_t noticeWarn;
+lv_style_t noticeAlert;
+lv_style_t keyboard;
+lv_style_t title;
+lv_style_t readoutStale;
+
+KindStyles kinds[KIND_COUNT];
+bool ready = false;
+bool local = false;
+uint32_t attached = 0;
+
+// Every property the styles above set; used by local mode only.
+const lv_style_prop_t COPIED_PROPS[] = {
+    LV_STYLE_BG_COLOR,     LV_STYLE_BG_OPA,      LV_STYLE_BORDER_COLOR,
+    LV_STYLE_BORDER_WIDTH, LV_STYLE_RADIUS,      LV_STYLE_PAD_TOP,
+    LV_STYLE_PAD_BOTTOM,   LV_STYLE_PAD_LEFT,    LV_STYLE_PAD_RIGHT,
+    LV_STYLE_TEXT_COLOR,   LV_STYLE_TEXT_ALIGN,  LV_STYLE_TEXT_FONT,
+    LV_STYLE_TEXT_OPA,
+};
+
+void define(Kind kind, std::initializer_list<Part> parts) {
+  KindStyles &k = kinds[kind];
+  k.count = 0;
+  for (const Part &part : parts) {
+    if (k.count < MAX_PARTS) {
+      k.parts[k.count++] = part;
+    }
+  }
+}
+
+void copyLocal(lv_obj_t *obj, const Part &part) {
+  for (lv_style_prop_t prop : COPIED_PROPS) {
+    lv_style_value_t value;
+    if (lv_style_get_prop(part.style, prop, &value) == LV_STYLE_RES_FOUND) {
+      lv_obj_set_local_style_prop(obj, prop, value, part.selector);
+    }
+  }
+}
+
+} // namespace
+
+void init() {
+  if (ready) {
+    return;
+  }
+  const lv_style_selector_t MAIN = LV_PART_MAIN | LV_STATE_DEFAULT;
+
+  lv_style_init(&button);
+  lv_style_set_radius(&button, 8);
+  lv_style_set_bg_color(&button, lv_color_hex(0x1f5ea8));
+  lv_style_set_bg_opa(&button, LV_OPA_COVER);
+  lv_style_set_border_width(&button, 0);
+  lv_style_set_text_color(&button, lv_color_hex(0xffffff));
+  lv_style_set_text_align(&button, LV_TEXT_ALIGN_CENTER);
+  define(BUTTON, {{&button, MAIN}});
+
+  lv_style_init(&panel);
+  lv_style_set_bg_color(&panel, lv_color_hex(0x11151a));
+  lv_style_set_bg_opa(&panel, LV_OPA_COVER);
+  lv_style_set_border_width(&panel, 0);
+  lv_style_set_border_color(&panel, lv_color_hex(0xc62828));
+  lv_style_set_pad_all(&panel, 0);
+  lv_style_set_radius(&panel, 0);
+  lv_style_init(&panelError);
+  lv_style_set_border_width(&panelError, 4);
+  define(PANEL,
+         {{&panel, MAIN}, {&panelError, LV_PART_MAIN | PANEL_ERROR}});
+
+  lv_style_init(&list);
+  lv_style_set_bg_color(&list, lv_color_hex(0x1a222b));
+  lv_style_set_border_color(&list, lv_color_hex(0x3a4a5a));
+  lv_style_set_border_width(&list, 1);
+  lv_style_set_pad_all(&list, 0);
+  define(LIST, {{&list, MAIN}});
+  lv_style_init(&formPad);
+  lv_style_set_pad_all(&formPad, 6);
+  define(FORM, {{&list, MAIN}, {&formPad, MAIN}});
+
+  lv_style_init(&row);
+  lv_style_set_bg_color(&row, lv_color_hex(0x26303a));
+  lv_style_set_border_width(&row, 1);
+  lv_style_set_border_color(&row, lv_color_hex(0x41505f));
+  lv_style_init(&rowCurrent);
+  lv_style_set_bg_color(&rowCurrent, lv_color_hex(0x2e4a3e));
+  lv_style_init(&rowSelected);
+  lv_style_set_bg_color(&rowSelected, lv_color_hex(0x2d7dd2));
+  define(ROW, {{&row, MAIN},
+              {&rowCurrent, LV_PART_MAIN | ROW_CURRENT},
+              {&rowSelected, LV_PART_MAIN | ROW_SELECTED}});
+
+  lv_style_init(&field);
+  lv_style_set_text_align(&field, LV_TEXT_ALIGN_RIGHT);
+  define(FIELD, {{&field, MAIN}});
+
+  lv_style_init(&notice);
+  lv_style_set_text_color(&notice, lv_color_hex(0xd6d6d6));
+  lv_style_init(&noticeOk);
+  lv_style_set_text_color(&noticeOk, lv_color_hex(0x9be7a5));
+  lv_style_init(&noticeWarn);
+  lv_style_set_text_color(&noticeWarn, lv_color_hex(0xfff0a0));
+  lv_style_init(&noticeAlert);
+  lv_style_set_text_color(&noticeAlert, lv_color_hex(0xffff7a));
+  define(NOTICE, {{&notice, MAIN},
+                  {&noticeOk, LV_PART_MAIN | NOTICE_OK},
+                  {&noticeWarn, LV_PART_MAIN | NOTICE_WARN},
+                  {&noticeAlert, LV_PART_MAIN | NOTICE_ALERT}});
+
+  lv_style_init(&keyboard);
+  lv_style_set_border_color(&keyboard, lv_color_hex(0xffec18));
+  lv_style_set_border_width(&keyboard, 2);
+  lv_style_set_bg_opa(&keyboard, LV_OPA_COVER);
+  lv_style_set_bg_color(&keyboard, lv_color_hex(0x1a222b));
+  define(KEYBOARD, {{&keyboard, LV_PART_MAIN}});
+
+  lv_style_init(&title);
+  lv_style_set_text_font(&title, &lv_font_montserrat_24);
+  define(TITLE, {{&title, MAIN}});
+
+  // No base style: the EEZ readouts keep their own look until marked stale.
+  lv_style_init(&readoutStale);
+  lv_style_set_text_opa(&readoutStale, LV_OPA_50);
+  define(READOUT, {{&readoutStale, LV_PART_MAIN | STALE}});
+
+  ready = true;
+}
+
+void apply(lv_obj_t *obj, Kind kind) {
+  if (!obj || kind < 0 || kind >= KIND_COUNT) {
+    return;
+  }
+  init();
+  const KindStyles &k = kinds[kind];
+  for (int i = 0; i < k.count; i++) {
+    if (local) {
+      copyLocal(obj, k.parts[i]);
+    } else {
+      lv_obj_add_style(obj, k.parts[i].style, k.parts[i].selector);
+      attached++;
+    }
+  }
+}
+
+void setLocalMode(bool enabled) { local = enabled; }
+bool localMode() { return local; }
+
+uint32_t attachCount() { return attached; }
+
+} // namespace UiStyles
@@ -0,0 +1,55 @@
+#ifndef UI_STYLES_H
+#define UI_STYLES_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Shared styles for PrdUi widgets. Each kind is a set of static lv_style_t
+// objects built once in init() and attached by reference, so a widget
+// carries a pointer per style instead of its own copy of every property.
+//
+// Variants (error frame, current/selected row, notice tone) are extra
+// styles on user states; toggle the state rather than writing colours.
+namespace UiStyles {
+
+enum Kind {
+  BUTTON,
+  PANEL,    // right-hand panel; PANEL_ERROR adds the red frame
+  LIST,     // bordered scroll container
+  FORM,     // LIST with padding, for the edit forms
+  ROW,      // on top of BUTTON; ROW_CURRENT / ROW_SELECTED recolour it
+  FIELD,    // form text area
+  NOTICE,   // status line; NOTICE_OK / NOTICE_WARN / NOTICE_ALERT tones
+  KEYBOARD,
+  TITLE,
+  READOUT,  // live value; STALE dims it while it shows a stored value
+  KIND_COUNT
+};
+
+constexpr lv_state_t PANEL_ERROR = LV_STATE_USER_1;
+constexpr lv_state_t ROW_CURRENT = LV_STATE_USER_1;
+// A higher state wins where both apply, so selection shows on the current
+// row too.
+constexpr lv_state_t ROW_SELECTED = LV_STATE_USER_2;
+constexpr lv_state_t NOTICE_OK = LV_STATE_USER_1;
+constexpr lv_state_t NOTICE_WARN = LV_STATE_USER_2;
+constexpr lv_state_t NOTICE_ALERT = LV_STATE_USER_3;
+constexpr lv_state_t NOTICE_TONES = NOTICE_OK | NOTICE_WARN | NOTICE_ALERT;
+constexpr lv_state_t STALE = LV_STATE_USER_4;
+
+void init();
+
+void apply(lv_obj_t *obj, Kind kind);
+
+// When set, apply() copies the properties into the widget's local style
+// instead, as before the registry existed. Only for measuring the savings:
+// build a panel in each mode and compare the build reports.
+void setLocalMode(bool local);
+bool localMode();
+
+// Shared styles attached so far.
+uint32_t attachCount();
+
+} // namespace UiStyles
+
+#endif // UI_STYLES_H
@@ -0,0 +1,181 @@
+#include "virtual_list.h"
+
+namespace VirtualList {
+
+namespace {
+
+struct State {
+  Config config;
+  int count;
+  lv_obj_t *spacer; // sets the scrollable height to count rows
+  lv_obj_t *rows[MAX_POOL];
+  int rowItem[MAX_POOL]; // item bound to each pool slot, or NO_ITEM
+};
+
+State *getState(lv_obj_t *list) {
+  if (!list) {
+    return nullptr;
+  }
+  return static_cast<State *>(lv_obj_get_user_data(list));
+}
+
+int firstVisible(lv_obj_t *list, const State *state) {
+  int32_t offset = lv_obj_get_scroll_y(list) - state->config.topMargin;
+  if (offset <= 0) {
+    return 0;
+  }
+  return offset / state->config.rowPitch;
+}
+
+void bindSlot(State *state, int slot, int index) {
+  lv_obj_t *row = state->rows[slot];
+  if (index == NO_ITEM) {
+    if (state->rowItem[slot] != NO_ITEM) {
+      lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+      state->rowItem[slot] = NO_ITEM;
+    }
+    return;
+  }
+  if (state->rowItem[slot] != index) {
+    lv_obj_set_y(row,
+                 state->config.topMargin + index * state->config.rowPitch);
+    lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+    state->rowItem[slot] = index;
+  }
+  state->config.bindRow(row, index);
+}
+
+// Moves slots whose item left the window onto the items that entered it.
+// Slots that keep their item are not touched.
+void layout(lv_obj_t *list, State *state) {
+  int pool = state->config.poolSize;
+  int first = firstVisible(list, state);
+  for (int index = first; index < first + pool; index++) {
+    int slot = index % pool;
+    int want = index < state->count ? index : NO_ITEM;
+    if (state->rowItem[slot] != want) {
+      bindSlot(state, slot, want);
+    }
+  }
+}
+
+void onScroll(lv_event_t *e) {
+  lv_obj_t *list = lv_event_get_target_obj(e);
+  State *state = getState(list);
+  if (state) {
+    layout(list, state);
+  }
+}
+
+void onDelete(lv_event_t *e) {
+  lv_obj_t *list = lv_event_get_target_obj(e);
+  State *state = getState(list);
+  if (state) {
+    lv_free(state);
+    lv_obj_set_user_data(list, nullptr);
+  }
+}
+
+} // namespace
+
+bool attach(lv_obj_t *list, const Config &config) {
+  if (!list || getState(list) || !config.createRow || !config.bindRow ||
+      config.rowPitch <= 0 || config.poolSize < 1 ||
+      config.poolSize > MAX_POOL) {
+    return false;
+  }
+  State *state = static_cast<State *>(lv_malloc_zeroed(sizeof(State)));
+  if (!state) {
+    return false;
+  }
+  state->config = config;
+
+  state->spacer = lv_obj_create(list);
+  lv_obj_remove_style_all(state->spacer);
+  lv_obj_set_size(state->spacer, 1, 1);
+  lv_obj_set_pos(state->spacer, 0, 0);
+  lv_obj_remove_flag(state->spacer, LV_OBJ_FLAG_CLICKABLE);
+
+  for (int i = 0; i < config.poolSize; i++) {
+    lv_obj_t *row = config.createRow(list);
+    if (!row) {
+      lv_obj_delete(state->spacer);
+      for (int j = 0; j < i; j++) {
+        lv_obj_delete(state->rows[j]);
+      }
+      lv_free(state);
+      return false;
+    }
+    lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+    state->rows[i] = row;
+    state->rowItem[i] = NO_ITEM;
+  }
+
+  lv_obj_set_user_data(list, state);
+  lv_obj_add_event_cb(list, onScroll, LV_EVENT_SCROLL, nullptr);
+  lv_obj_add_event_cb(list, onDelete, LV_EVENT_DELETE, nullptr);
+  return true;
+}
+
+void setCount(lv_obj_t *list, int count) {
+  State *state = getState(list);
+  if (!state) {
+    return;
+  }
+  if (count < 0) {
+    count = 0;
+  }
+  if (count != state->count) {
+    state->count = count;
+    lv_coord_t bottom =
+        state->config.topMargin + count * state->config.rowPitch;
+    lv_obj_set_y(state->spacer, bottom > 0 ? bottom - 1 : 0);
+    // A shorter list may leave the view scrolled past its new end.
+    lv_obj_update_layout(list);
+    lv_obj_readjust_scroll(list, LV_ANIM_OFF);
+  }
+  layout(list, state);
+}
+
+int count(lv_obj_t *list) {
+  State *state = getState(list);
+  return state ? state->count : 0;
+}
+
+void refresh(lv_obj_t *list, int index) {
+  State *state = getState(list);
+  if (!state || index < 0 || index >= state->count) {
+    return;
+  }
+  int slot = index % state->config.poolSize;
+  if (state->rowItem[slot] == index) {
+    state->config.bindRow(state->rows[slot], index);
+  }
+}
+
+void refreshAll(lv_obj_t *list) {
+  State *state = getState(list);
+  if (!state) {
+    return;
+  }
+  for (int slot = 0; slot < state->config.poolSize; slot++) {
+    if (state->rowItem[slot] != NO_ITEM) {
+      state->config.bindRow(state->rows[slot], state->rowItem[slot]);
+    }
+  }
+}
+
+int rowIndex(lv_obj_t *row) {
+  State *state = getState(row ? lv_obj_get_parent(row) : nullptr);
+  if (!state) {
+    return NO_ITEM;
+  }
+  for (int slot = 0; slot < state->config.poolSize; slot++) {
+    if (state->rows[slot] == row) {
+      return state->rowItem[slot];
+    }
+  }
+  return NO_ITEM;
+}
+
+} // namespace VirtualList
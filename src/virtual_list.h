@@ -0,0 +1,45 @@
+#ifndef VIRTUAL_LIST_H
+#define VIRTUAL_LIST_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Recycled row view for a scrollable container. A fixed pool of row widgets
+// covers the visible window; item i always lives in pool slot i % poolSize,
+// so scrolling re-binds only the rows whose item changed, and the widget
+// count stays constant however many items there are.
+namespace VirtualList {
+
+constexpr int MAX_POOL = 16;
+constexpr int NO_ITEM = -1;
+
+// Creates one pool row as a child of the list. Called poolSize times.
+typedef lv_obj_t *(*CreateRowFn)(lv_obj_t *list);
+// Shows item `index` in `row`. Should skip writes that change nothing, since
+// refreshAll() re-binds every visible row.
+typedef void (*BindRowFn)(lv_obj_t *row, int index);
+
+struct Config {
+  lv_coord_t rowPitch;  // distance between row tops
+  lv_coord_t topMargin; // space above the first row
+  int poolSize;         // rows in the pool, >= visible rows + 1
+  CreateRowFn createRow;
+  BindRowFn bindRow;
+};
+
+// Turns an existing scrollable container into a virtual list.
+bool attach(lv_obj_t *list, const Config &config);
+
+void setCount(lv_obj_t *list, int count);
+int count(lv_obj_t *list);
+
+// Re-binds the row showing `index`, if it is in the window.
+void refresh(lv_obj_t *list, int index);
+void refreshAll(lv_obj_t *list);
+
+// Item bound to a pool row, or NO_ITEM.
+int rowIndex(lv_obj_t *row);
+
+} // namespace VirtualList
+
+#endif // VIRTUAL_LIST_H
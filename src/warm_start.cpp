@@ -0,0 +1,86 @@
+#include "warm_start.h"
+
+#include "storage.h"
+#include "storage_worker.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace WarmStart {
+
+namespace {
+
+constexpr float ENCODER_DRIFT = 0.5f; // turns
+constexpr float TEMP_DRIFT = 1.0f;    // degrees C
+constexpr float VOLUME_DRIFT = 0.5f;  // cm3, per block
+
+static_assert(sizeof(Snapshot) <= StorageWorker::MAX_SNAPSHOT_BYTES,
+              "snapshot outgrew the storage worker buffer");
+
+Snapshot saved = {};
+bool haveSaved = false;
+uint32_t savedMs = 0;
+uint32_t saves = 0;
+
+bool changed(const Snapshot &next) {
+  return next.parts != saved.parts ||
+         strcmp(next.status.state, saved.status.state) != 0 ||
+         next.status.errorCode != saved.status.errorCode ||
+         !DisplayComms::sameMould(next.mould, saved.mould) ||
+         memcmp(&next.common, &saved.common, sizeof(next.common)) != 0 ||
+         next.blockCount != saved.blockCount;
+}
+
+// Block ages and doses are left out: they grow every second and are only
+// advisory.
+bool drifted(const Snapshot &next) {
+  if (fabsf(next.status.encoderTurns - saved.status.encoderTurns) >=
+          ENCODER_DRIFT ||
+      fabsf(next.status.tempC - saved.status.tempC) >= TEMP_DRIFT) {
+    return true;
+  }
+  for (int i = 0; i < next.blockCount && i < MAX_BLOCKS; i++) {
+    if (fabsf(next.blocks[i].volume - saved.blocks[i].volume) >=
+        VOLUME_DRIFT) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+bool load(Snapshot &snapshot) {
+  if (!Storage::loadSnapshot(VERSION, &snapshot, sizeof(snapshot))) {
+    return false;
+  }
+  if (snapshot.blockCount > MAX_BLOCKS) {
+    snapshot.blockCount = MAX_BLOCKS;
+  }
+  // What is on flash already is the baseline for the next save.
+  saved = snapshot;
+  haveSaved = true;
+  return true;
+}
+
+void offer(const Snapshot &snapshot, uint32_t now) {
+  if (haveSaved) {
+    uint32_t since = now - savedMs;
+    bool due = (since >= MIN_CHANGE_INTERVAL_MS && changed(snapshot)) ||
+               (since >= MIN_DRIFT_INTERVAL_MS && drifted(snapshot));
+    if (!due) {
+      return;
+    }
+  }
+  if (!StorageWorker::saveSnapshot(VERSION, &snapshot, sizeof(snapshot))) {
+    return;
+  }
+  saved = snapshot;
+  haveSaved = true;
+  savedMs = now;
+  saves++;
+}
+
+uint32_t saveCount() { return saves; }
+
+} // namespace WarmStart
@@ -0,0 +1,47 @@
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include "display_comms.h"
+
+#include <cstdint>
+
+// Last known machine state, kept on flash so a reboot can draw the previous
+// readouts, state and refill stack before the controller has said anything.
+// Saves are rate limited: a state, error, profile or block change is worth a
+// write within seconds, slow drift of position or temperature only every
+// few minutes, and nothing is written while the machine is idle.
+namespace WarmStart {
+
+constexpr int MAX_BLOCKS = 16;
+// Bump when Snapshot changes shape; older files then read as absent.
+constexpr uint16_t VERSION = 2;
+
+constexpr uint32_t MIN_CHANGE_INTERVAL_MS = 10000;
+constexpr uint32_t MIN_DRIFT_INTERVAL_MS = 120000;
+
+struct Block {
+  float volume;   // cm3
+  uint32_t ageMs; // age when saved; there is no clock across power-off
+  uint32_t dose;  // RefillBlock::dose, which doesn't grow while off
+};
+
+struct Snapshot {
+  uint32_t parts; // DisplayComms::Received bits that hold real data
+  DisplayComms::Status status;
+  DisplayComms::MouldParams mould;
+  DisplayComms::CommonParams common;
+  uint8_t blockCount;
+  Block blocks[MAX_BLOCKS];
+};
+
+bool load(Snapshot &snapshot);
+
+// Queues `snapshot` for a background write when it differs enough from the
+// last one saved (or loaded) and the matching interval has passed.
+void offer(const Snapshot &snapshot, uint32_t now);
+
+uint32_t saveCount();
+
+} // namespace WarmStart
+
+#endif // WARM_START_H
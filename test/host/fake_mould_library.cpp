@@ -0,0 +1,63 @@
+#include "host_support.h"
+
+#include "mould_library.h"
+#include "storage_worker.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+std::vector<DisplayComms::MouldParams> library;
+} // namespace
+
+namespace HostLibrary {
+
+int freeSlots = StorageWorker::MAX_PENDING_RECORDS;
+
+void clear() { library.clear(); }
+
+} // namespace HostLibrary
+
+namespace StorageWorker {
+
+int freeSlots() { return HostLibrary::freeSlots; }
+
+} // namespace StorageWorker
+
+namespace MouldLibrary {
+
+int count() { return static_cast<int>(library.size()); }
+
+const DisplayComms::MouldParams *get(int position) {
+  if (position < 0 || position >= count()) {
+    return nullptr;
+  }
+  return &library[position];
+}
+
+int find(const char *name) {
+  for (int i = 0; i < count(); i++) {
+    if (strcmp(library[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int merge(const DisplayComms::MouldParams *moulds, int size) {
+  int stored = 0;
+  for (int i = 0; i < size; i++) {
+    int position = find(moulds[i].name);
+    if (position >= 0) {
+      library[position] = moulds[i];
+    } else if (count() < MAX_PROFILES) {
+      library.push_back(moulds[i]);
+    } else {
+      continue;
+    }
+    stored++;
+  }
+  return stored;
+}
+
+} // namespace MouldLibrary
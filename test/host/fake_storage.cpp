@@ -0,0 +1,88 @@
+#include "host_support.h"
+
+#include "storage.h"
+#include "storage_worker.h"
+
+#include <cstring>
+#include <map>
+
+namespace {
+std::map<uint32_t, DisplayComms::MouldParams> records;
+} // namespace
+
+namespace HostStorage {
+
+bool tableFull = false;
+int loads = 0;
+
+void clear() {
+  records.clear();
+  tableFull = false;
+  loads = 0;
+}
+
+} // namespace HostStorage
+
+// display_comms.cpp needs LVGL; this is its field-wise compare.
+namespace DisplayComms {
+
+bool sameMould(const MouldParams &a, const MouldParams &b) {
+  return strcmp(a.name, b.name) == 0 && strcmp(a.mode, b.mode) == 0 &&
+         a.fillVolume == b.fillVolume && a.fillSpeed == b.fillSpeed &&
+         a.fillPressure == b.fillPressure && a.packVolume == b.packVolume &&
+         a.packSpeed == b.packSpeed && a.packPressure == b.packPressure &&
+         a.packTime == b.packTime && a.coolingTime == b.coolingTime &&
+         a.fillAccel == b.fillAccel && a.fillDecel == b.fillDecel &&
+         a.packAccel == b.packAccel && a.packDecel == b.packDecel &&
+         a.injectTorque == b.injectTorque;
+}
+
+} // namespace DisplayComms
+
+namespace Storage {
+
+bool loadMouldIndex(MouldIndexHeader &, MouldIndexEntry *, int) {
+  return false;
+}
+bool hasLegacyMoulds() { return false; }
+void loadMoulds(DisplayComms::MouldParams *, int &count, int) { count = 0; }
+void removeLegacyMoulds() {}
+
+} // namespace Storage
+
+namespace StorageWorker {
+
+bool saveRecord(uint32_t id, const DisplayComms::MouldParams &mould) {
+  if (HostStorage::tableFull) {
+    return false;
+  }
+  records[id] = mould;
+  return true;
+}
+
+bool saveIndex(const Storage::MouldIndexHeader &,
+               const Storage::MouldIndexEntry *) {
+  return true;
+}
+
+bool removeRecord(uint32_t id) {
+  if (HostStorage::tableFull) {
+    return false;
+  }
+  records.erase(id);
+  return true;
+}
+
+bool loadRecord(uint32_t id, DisplayComms::MouldParams &mould) {
+  auto found = records.find(id);
+  if (found == records.end()) {
+    return false;
+  }
+  HostStorage::loads++;
+  mould = found->second;
+  return true;
+}
+
+int freeSlots() { return HostStorage::tableFull ? 0 : MAX_PENDING_RECORDS; }
+
+} // namespace StorageWorker
@@ -0,0 +1,10 @@
+#include "host_support.h"
+
+#include <Arduino.h>
+
+HardwareSerial Serial;
+
+namespace HostClock {
+uint32_t nowMs = 0;
+uint32_t stepMs = 1;
+} // namespace HostClock
@@ -0,0 +1,37 @@
+#ifndef HOST_SUPPORT_H
+#define HOST_SUPPORT_H
+
+// Shared by the host tests: a checking macro that survives NDEBUG, and the
+// knobs of the fakes each test links.
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(condition)                                                     \
+  do {                                                                       \
+    if (!(condition)) {                                                      \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                   #condition);                                              \
+      std::exit(1);                                                          \
+    }                                                                        \
+  } while (0)
+
+// In-memory MouldLibrary and StorageWorker::freeSlots(), for
+// MouldTransfer.
+namespace HostLibrary {
+void clear();
+// What StorageWorker::freeSlots() reports.
+extern int freeSlots;
+} // namespace HostLibrary
+
+// In-memory StorageWorker and Storage, for the real MouldLibrary.
+namespace HostStorage {
+void clear();
+// saveRecord() and removeRecord() refuse while this is set, as with the
+// worker's pending table full.
+extern bool tableFull;
+// Records read through loadRecord() so far.
+extern int loads;
+} // namespace HostStorage
+
+#endif // HOST_SUPPORT_H
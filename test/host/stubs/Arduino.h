@@ -0,0 +1,42 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino core for the host tests. millis() is a fake
+// clock the tests move by hand.
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+class HardwareSerial {
+public:
+  void println(const char *text = "") { std::puts(text); }
+  int printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = std::vprintf(format, args);
+    va_end(args);
+    return n;
+  }
+};
+
+extern HardwareSerial Serial;
+
+namespace HostClock {
+extern uint32_t nowMs;
+// Every call to millis() moves the clock on by this much, so time budgets
+// run out even though nothing is slow.
+extern uint32_t stepMs;
+} // namespace HostClock
+
+inline uint32_t millis() {
+  uint32_t now = HostClock::nowMs;
+  HostClock::nowMs += HostClock::stepMs;
+  return now;
+}
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,55 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// fs::FS and File over a host directory, for the transfer tests.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+
+class File {
+public:
+  File() = default;
+  explicit File(FILE *handle) : handle(handle) {}
+
+  explicit operator bool() const { return handle != nullptr; }
+  bool isDirectory() const { return false; }
+  size_t write(const uint8_t *data, size_t size) {
+    return std::fwrite(data, 1, size, handle);
+  }
+  int read(uint8_t *data, size_t size) {
+    return static_cast<int>(std::fread(data, 1, size, handle));
+  }
+  void close() {
+    if (handle) {
+      std::fclose(handle);
+    }
+    handle = nullptr;
+  }
+
+private:
+  FILE *handle = nullptr;
+};
+
+namespace fs {
+
+class FS {
+public:
+  explicit FS(const std::string &root) : root(root) {}
+
+  File open(const char *path, const char *mode) {
+    return File(std::fopen((root + path).c_str(), mode));
+  }
+
+  std::string path(const char *name) const { return root + name; }
+
+private:
+  std::string root;
+};
+
+} // namespace fs
+
+#endif // HOST_FS_H
@@ -0,0 +1,70 @@
+#include "host_support.h"
+
+#include "mould_library.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+typedef DisplayComms::MouldParams Mould;
+
+Mould mould(const char *name, float fillVolume) {
+  Mould out = {};
+  snprintf(out.name, sizeof(out.name), "%s", name);
+  strcpy(out.mode, "2D");
+  out.fillVolume = fillVolume;
+  return out;
+}
+
+// While the worker's table is full, saves wait dirty in the cache. With
+// every slot dirty, get() of a profile that isn't cached still reads it,
+// and flush() hands the dirty ones on once there is room.
+void testAllSlotsDirty() {
+  HostStorage::clear();
+  CHECK(MouldLibrary::begin());
+  const char *names[] = {"a", "b", "c", "d", "e", "f"};
+  for (const char *name : names) {
+    CHECK(MouldLibrary::add(mould(name, 1)) >= 0);
+  }
+
+  HostStorage::tableFull = true;
+  for (int i = 0; i < MouldLibrary::CACHE_SIZE; i++) {
+    CHECK(MouldLibrary::put(i, mould(names[i], 2)));
+  }
+  CHECK(MouldLibrary::writesDeferred());
+
+  int loads = HostStorage::loads;
+  const Mould *uncached = MouldLibrary::get(5);
+  CHECK(uncached && strcmp(uncached->name, "f") == 0);
+  CHECK(uncached->fillVolume == 1);
+  CHECK(HostStorage::loads == loads + 1);
+  // Dirty profiles read back as saved, not as in flash.
+  CHECK(MouldLibrary::get(0)->fillVolume == 2);
+  // No slot and no room in the table: the save is refused, not lost.
+  CHECK(!MouldLibrary::put(4, mould("e", 2)));
+  CHECK(MouldLibrary::get(4)->fillVolume == 1);
+
+  HostStorage::tableFull = false;
+  MouldLibrary::flush();
+  CHECK(!MouldLibrary::writesDeferred());
+  loads = HostStorage::loads;
+  CHECK(MouldLibrary::get(5)->fillVolume == 1);
+  CHECK(MouldLibrary::get(5)->fillVolume == 1); // now cached
+  CHECK(HostStorage::loads == loads + 1);
+  // The flushed saves reached storage: evicted and read back, they hold.
+  for (int i = 2; i < 6; i++) {
+    MouldLibrary::get(i);
+  }
+  loads = HostStorage::loads;
+  CHECK(MouldLibrary::get(0)->fillVolume == 2);
+  CHECK(HostStorage::loads == loads + 1);
+}
+
+} // namespace
+
+int main() {
+  testAllSlotsDirty();
+  std::puts("test_mould_library: ok");
+  return 0;
+}
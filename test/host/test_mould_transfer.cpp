@@ -0,0 +1,240 @@
+#include "host_support.h"
+
+#include "mould_library.h"
+#include "mould_transfer.h"
+#include "storage_worker.h"
+
+#include <FS.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+typedef DisplayComms::MouldParams Mould;
+
+std::string makeRoot() {
+  char root[] = "/tmp/mould_transfer_XXXXXX";
+  CHECK(mkdtemp(root) != nullptr);
+  return root;
+}
+
+void writeFile(fs::FS &fs, const char *name, const std::string &text) {
+  FILE *file = std::fopen(fs.path(name).c_str(), "w");
+  CHECK(file);
+  std::fputs(text.c_str(), file);
+  std::fclose(file);
+}
+
+MouldTransfer::Report run(bool import, fs::FS &fs, const char *path) {
+  MouldTransfer::Format format = MouldTransfer::formatFor(path);
+  CHECK(import ? MouldTransfer::startImport(fs, path, format)
+               : MouldTransfer::startExport(fs, path, format));
+  while (MouldTransfer::step(5)) {
+  }
+  MouldTransfer::Report report;
+  CHECK(MouldTransfer::takeReport(report));
+  return report;
+}
+
+MouldTransfer::Report import(fs::FS &fs, const char *path) {
+  HostLibrary::clear();
+  return run(true, fs, path);
+}
+
+bool same(const Mould &a, const Mould &b) {
+  return strcmp(a.name, b.name) == 0 && strcmp(a.mode, b.mode) == 0 &&
+         a.fillVolume == b.fillVolume && a.fillSpeed == b.fillSpeed &&
+         a.fillPressure == b.fillPressure && a.packVolume == b.packVolume &&
+         a.packSpeed == b.packSpeed && a.packPressure == b.packPressure &&
+         a.packTime == b.packTime && a.coolingTime == b.coolingTime &&
+         a.fillAccel == b.fillAccel && a.fillDecel == b.fillDecel &&
+         a.packAccel == b.packAccel && a.packDecel == b.packDecel &&
+         a.injectTorque == b.injectTorque;
+}
+
+// Names with separators, quotes and backslashes; values exact in binary.
+std::vector<Mould> sampleLibrary(int size) {
+  std::vector<Mould> moulds;
+  for (int i = 0; i < size; i++) {
+    Mould mould = {};
+    const char *pattern = i % 5 == 0   ? "Cap, \"lid\" %d"
+                          : i % 5 == 1 ? "Back\\slash %d"
+                                       : "Mould %d";
+    snprintf(mould.name, sizeof(mould.name), pattern, i);
+    strcpy(mould.mode, i % 2 ? "2D" : "3D");
+    mould.fillVolume = i * 0.25f;
+    mould.fillSpeed = 12.5f;
+    mould.fillPressure = i % 100;
+    mould.packVolume = 0.125f;
+    mould.packSpeed = 3;
+    mould.packPressure = 1500;
+    mould.packTime = 2.5f;
+    mould.coolingTime = 30;
+    mould.fillAccel = 9999;
+    mould.fillDecel = 0;
+    mould.packAccel = 100;
+    mould.packDecel = 50.75f;
+    mould.injectTorque = 1.25f;
+    moulds.push_back(mould);
+  }
+  return moulds;
+}
+
+void testRoundTrip(fs::FS &fs, const char *path) {
+  std::vector<Mould> moulds = sampleLibrary(300);
+  HostLibrary::clear();
+  CHECK(MouldLibrary::merge(moulds.data(), moulds.size()) == 300);
+
+  MouldTransfer::Report report = run(false, fs, path);
+  CHECK(report.ok && !report.import && report.records == 300);
+  CHECK(report.rejected == 0 && report.bytes > 0);
+
+  report = import(fs, path);
+  CHECK(report.ok && report.import && report.records == 300);
+  CHECK(report.rejected == 0);
+  CHECK(MouldLibrary::count() == 300);
+  for (int i = 0; i < 300; i++) {
+    CHECK(same(*MouldLibrary::get(i), moulds[i]));
+  }
+}
+
+void testCsvFields(fs::FS &fs) {
+  // Columns in any order and case, an unknown one skipped, CRLF endings, a
+  // quoted name holding a comma and doubled quotes, no final line break.
+  writeFile(fs, "/fields.csv",
+            "notes,Mode,NAME,fillVolume\r\n"
+            "\"a, b\",2D,plain,3.5\r\n"
+            "x,3D,\"Cap, \"\"lid\"\"\",5\r\n"
+            "y,2D,\"multi\nline\",1");
+  MouldTransfer::Report report = import(fs, "/fields.csv");
+  CHECK(report.ok && report.records == 3 && report.rejected == 0);
+  CHECK(strcmp(MouldLibrary::get(0)->name, "plain") == 0);
+  CHECK(strcmp(MouldLibrary::get(0)->mode, "2D") == 0);
+  CHECK(MouldLibrary::get(0)->fillVolume == 3.5f);
+  CHECK(MouldLibrary::get(0)->packTime == 0); // missing column reads as 0
+  CHECK(strcmp(MouldLibrary::get(1)->name, "Cap, \"lid\"") == 0);
+  CHECK(MouldLibrary::get(1)->fillVolume == 5);
+  CHECK(strcmp(MouldLibrary::get(2)->name, "multi\nline") == 0);
+}
+
+void testCsvRejects(fs::FS &fs) {
+  writeFile(fs, "/bad.csv",
+            "name,mode,packTime\n"
+            "good,2D,1\n"
+            ",2D,1\n"             // no name
+            "mode,4D,1\n"         // bad mode
+            "negative,3D,-1\n"    // out of range
+            "huge,3D,10000\n"     // out of range
+            "word,3D,ten\n"       // not a number
+            "\"x\"y,3D,1\n"       // text after a closing quote
+            "trailing,2D,1 \n"    // trailing space is fine
+            "\n"                  // blank lines are ignored
+            "also good,3D,2\n"
+            "\"open,3D,1\n");     // quote never closed, up to the end
+  MouldTransfer::Report report = import(fs, "/bad.csv");
+  CHECK(report.ok);
+  CHECK(report.records == 3);
+  CHECK(report.rejected == 7);
+  CHECK(MouldLibrary::find("good") == 0);
+  CHECK(MouldLibrary::find("trailing") == 1);
+  CHECK(MouldLibrary::find("also good") == 2);
+}
+
+void testCsvHeader(fs::FS &fs) {
+  writeFile(fs, "/nameless.csv", "mode,fillVolume\n2D,1\n");
+  MouldTransfer::Report report = import(fs, "/nameless.csv");
+  CHECK(!report.ok && report.records == 0);
+}
+
+// Rows of exactly MAX_RECORD bytes fit; one more byte and the row is
+// rejected on its own, without losing the rows around it.
+void testRecordLimit(fs::FS &fs) {
+  const size_t limit = 512;
+  std::string prefix = "fits,2D,";
+  std::string fits = prefix + std::string(limit - prefix.size(), 'x');
+  std::string over = "over,2D," + std::string(limit - prefix.size() + 1, 'x');
+  CHECK(fits.size() == limit && over.size() == limit + 1);
+  writeFile(fs, "/long.csv",
+            "name,mode,padding\n" + fits + "\n" + over + "\nafter,3D,\n");
+  MouldTransfer::Report report = import(fs, "/long.csv");
+  CHECK(report.ok && report.records == 2 && report.rejected == 1);
+  CHECK(MouldLibrary::find("fits") == 0);
+  CHECK(MouldLibrary::find("over") == -1);
+  CHECK(MouldLibrary::find("after") == 1);
+
+  std::string padding(limit, ' ');
+  writeFile(fs, "/long.json",
+            "[{\"name\": \"big\", \"mode\": \"2D\"" + padding + "},\n"
+            " {\"name\": \"small\", \"mode\": \"3D\"}]");
+  report = import(fs, "/long.json");
+  CHECK(report.ok && report.records == 1 && report.rejected == 1);
+  CHECK(MouldLibrary::find("small") == 0);
+}
+
+void testJson(fs::FS &fs) {
+  // The wrapper object, unknown keys of every type, braces inside strings,
+  // escapes, numbers as strings and in exponent form.
+  writeFile(fs, "/wrapped.json",
+            "{\"version\": 1, \"moulds\": [\n"
+            "  {\"name\": \"a\\\"b\", \"mode\": \"3D\", \"note\": \"{x}\",\n"
+            "   \"flag\": true, \"fillSpeed\": \"2\"},\n"
+            "  {\"name\": \"c\"},\n"
+            "  {\"name\": \"d\", \"mode\": \"2D\", \"packTime\": 1e2},\n"
+            "  {\"name\": \"e\", \"mode\": \"2D\", \"packTime\": -1},\n"
+            "  {\"name\": \"f\" \"mode\": \"2D\"},\n"
+            "  {}\n"
+            "]}\n");
+  MouldTransfer::Report report = import(fs, "/wrapped.json");
+  CHECK(report.ok && report.records == 2 && report.rejected == 4);
+  CHECK(strcmp(MouldLibrary::get(0)->name, "a\"b") == 0);
+  CHECK(MouldLibrary::get(0)->fillSpeed == 2);
+  CHECK(strcmp(MouldLibrary::get(1)->name, "d") == 0);
+  CHECK(MouldLibrary::get(1)->packTime == 100);
+
+  writeFile(fs, "/bare.json", "[{\"name\": \"g\", \"mode\": \"3D\"}]");
+  report = import(fs, "/bare.json");
+  CHECK(report.ok && report.records == 1 && report.rejected == 0);
+}
+
+// Import holds each batch until the storage worker has room for it.
+void testWaitsForStorage(fs::FS &fs) {
+  std::vector<Mould> moulds = sampleLibrary(20);
+  HostLibrary::clear();
+  MouldLibrary::merge(moulds.data(), moulds.size());
+  run(false, fs, "/wait.csv");
+
+  HostLibrary::clear();
+  HostLibrary::freeSlots = 0;
+  CHECK(MouldTransfer::startImport(fs, "/wait.csv", MouldTransfer::CSV));
+  for (int i = 0; i < 50; i++) {
+    CHECK(MouldTransfer::step(5));
+  }
+  CHECK(MouldLibrary::count() == 0);
+  HostLibrary::freeSlots = StorageWorker::MAX_PENDING_RECORDS;
+  while (MouldTransfer::step(5)) {
+  }
+  MouldTransfer::Report report;
+  CHECK(MouldTransfer::takeReport(report));
+  CHECK(report.ok && report.records == 20 && MouldLibrary::count() == 20);
+}
+
+} // namespace
+
+int main() {
+  fs::FS fs(makeRoot());
+  CHECK(MouldTransfer::formatFor("/a.JSON") == MouldTransfer::JSON);
+  CHECK(MouldTransfer::formatFor("/a.csv") == MouldTransfer::CSV);
+  testRoundTrip(fs, "/library.csv");
+  testRoundTrip(fs, "/library.json");
+  testCsvFields(fs);
+  testCsvRejects(fs);
+  testCsvHeader(fs);
+  testRecordLimit(fs);
+  testJson(fs);
+  testWaitsForStorage(fs);
+  std::puts("test_mould_transfer: ok");
+  return 0;
+}
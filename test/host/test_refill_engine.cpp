@@ -0,0 +1,301 @@
+#include "host_support.h"
+
+#include "refill_engine.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+// One recorded message: a STATE when `state` is set, else an ENC.
+struct Event {
+  uint32_t ms;
+  const char *state;
+  float turns;
+};
+
+#define STATE(ms, name) {ms, name, 0}
+#define ENC(ms, turns) {ms, nullptr, turns}
+
+// Three refills and the shots between them, with the noise a real log has:
+// repeated states, encoder steps backwards, a position glitch, a refill too
+// small to count. Volumes are exact in binary so the checks can be too.
+const Event SESSION[] = {
+    ENC(0, 360.5f),
+    STATE(0, "INIT_HEATING"),
+    STATE(5000, "REFILL"),
+    ENC(5100, 330.0f),
+    ENC(5200, 300.0f),
+    STATE(6000, "READY_TO_INJECT"), // block 0: 60.5
+    STATE(6100, "READY_TO_INJECT"),
+    STATE(7000, "INJECT"),
+    ENC(7100, 305.0f),
+    ENC(7200, 310.0f),
+    ENC(7300, 320.0f), // 20 used
+    STATE(8000, "PACK"),
+    ENC(8100, 999.0f), // glitch: too far to be travel
+    ENC(8200, 320.0f),
+    STATE(9000, "REFILL"),
+    ENC(9100, 250.0f),
+    STATE(10000, "READY_TO_INJECT"), // block 1: 110.5 - 40.5 = 70
+    STATE(11000, "INJECT"),
+    ENC(11100, 290.5f), // block 0 used up
+    ENC(11200, 310.0f), // block 1 down to 50.5
+    STATE(12000, "REFILL"),
+    ENC(12100, 309.75f), // refill starts with a little jitter back
+    STATE(13000, "READY_TO_INJECT"), // 0.25: too small for a block
+    STATE(14000, "REFILL"),
+    ENC(14100, 200.0f),
+    STATE(15000, "READY_TO_INJECT"), // block 2: 160.5 - 50.5 = 110
+    STATE(16000, "INJECT"),
+    ENC(16100, 250.5f), // block 1 used up
+    ENC(16200, 300.0f), // block 2 down to 60.5
+};
+
+void replay(RefillEngine &engine, const Event *events, int count) {
+  for (int i = 0; i < count; i++) {
+    if (events[i].state) {
+      engine.onState(events[i].state, events[i].ms);
+    } else {
+      engine.onEncoder(events[i].turns, events[i].ms);
+    }
+  }
+}
+
+template <int N> void replay(RefillEngine &engine, const Event (&events)[N]) {
+  replay(engine, events, N);
+}
+
+void testSession() {
+  RefillEngine engine;
+  replay(engine, SESSION);
+
+  const RefillStack &stack = engine.stack();
+  CHECK(stack.count() == 1);
+  CHECK(stack.at(0).volume == 60.5f);
+  CHECK(stack.at(0).filledVolume == 110.0f);
+  CHECK(stack.at(0).addedMs == 15000);
+  CHECK(stack.totalVolume() == RefillEngine::BARREL_TURNS - 300.0f);
+  CHECK(!engine.refilling());
+
+  CHECK(stack.retiredTotal() == 2 && stack.historyCount() == 2);
+  const RetiredBlock *last = stack.retired(0);
+  CHECK(last->volume == 70.0f);
+  CHECK(last->filledMs == 10000 && last->exhaustedMs == 16100);
+  const RetiredBlock *first = stack.retired(1);
+  CHECK(first->volume == 60.5f);
+  CHECK(first->filledMs == 6000 && first->exhaustedMs == 11100);
+  CHECK(!stack.retired(2));
+}
+
+// A recorded sequence replays to the same stack, however it is chunked.
+void testDeterministic() {
+  RefillEngine whole;
+  replay(whole, SESSION);
+  int count = sizeof(SESSION) / sizeof(SESSION[0]);
+  RefillEngine split;
+  replay(split, SESSION, 10);
+  replay(split, SESSION + 10, count - 10);
+  CHECK(split.revision() == whole.revision());
+  CHECK(split.stack().count() == whole.stack().count());
+  for (int i = 0; i < whole.stack().count(); i++) {
+    CHECK(split.stack().at(i).volume == whole.stack().at(i).volume);
+    CHECK(split.stack().at(i).addedMs == whole.stack().at(i).addedMs);
+  }
+}
+
+// With more refills than slots the stack stays full and the top block
+// takes the extra volume; the history keeps only the latest retirements.
+void testFullStackAndHistory() {
+  RefillEngine engine;
+  uint32_t ms = 0;
+  float position = RefillEngine::BARREL_TURNS;
+  engine.onEncoder(position, ms);
+  for (int i = 0; i < RefillStack::CAPACITY + 4; i++) {
+    engine.onState("REFILL", ms += 100);
+    engine.onEncoder(position -= 2.0f, ms += 100);
+    engine.onState("READY_TO_INJECT", ms += 100);
+  }
+  CHECK(engine.stack().count() == RefillStack::CAPACITY);
+  CHECK(engine.stack().at(RefillStack::CAPACITY - 1).volume == 10.0f);
+  CHECK(engine.stack().totalVolume() == 40.0f);
+
+  int injected = 0;
+  while (!engine.stack().empty()) {
+    engine.onState("INJECT", ms += 100);
+    engine.onEncoder(position += 1.0f, ms += 100);
+    engine.onState("READY_TO_INJECT", ms += 100);
+    injected++;
+  }
+  CHECK(injected == 40);
+  CHECK(engine.stack().retiredTotal() == RefillStack::CAPACITY);
+  CHECK(engine.stack().retired(0)->volume == 10.0f);
+  CHECK(engine.stack().retired(RefillStack::CAPACITY - 1)->volume == 2.0f);
+}
+
+// A warm start picks the stack up again; the first live sample only sets
+// the position, however far the plunger moved while off.
+void testRestore() {
+  RefillEngine engine;
+  replay(engine, SESSION);
+  RefillBlock saved[RefillStack::CAPACITY];
+  int count = engine.stack().count();
+  for (int i = 0; i < count; i++) {
+    saved[i] = engine.stack().at(i);
+  }
+
+  RefillEngine restored;
+  restored.restore(300.0f, "READY_TO_INJECT", saved, count);
+  restored.onEncoder(302.0f, 20000);
+  CHECK(restored.stack().totalVolume() == 60.5f);
+  restored.onState("READY_TO_INJECT", 20100); // not a new refill
+  CHECK(restored.stack().count() == 1);
+  restored.onEncoder(312.0f, 20200);
+  CHECK(restored.stack().totalVolume() == 50.5f);
+  CHECK(restored.stack().at(0).addedMs == 15000);
+}
+
+// A refill of `volume` landing at `ms`, plunger from wherever it is.
+void refill(RefillEngine &engine, float volume, uint32_t ms) {
+  float top = RefillEngine::BARREL_TURNS - engine.stack().totalVolume();
+  engine.onState("REFILL", ms);
+  engine.onEncoder(top - volume, ms);
+  engine.onState("READY_TO_INJECT", ms);
+}
+
+// Dose units for `excessTenths` above the threshold held for `ms`.
+uint32_t doseFor(uint32_t excessTenths, uint32_t ms) {
+  return excessTenths * ms / (10 * 1000 / RefillEngine::DOSE_UNITS_PER_CS);
+}
+
+void testSteadyDose() {
+  RefillEngine engine;
+  engine.onEncoder(RefillEngine::BARREL_TURNS, 0);
+  refill(engine, 100, 0);
+  // 10 degrees over for 60 s at 1 Hz: 600 degree seconds.
+  for (uint32_t ms = 0; ms <= 60000; ms += 1000) {
+    engine.onTemperature(THERMAL_DOSE_THRESHOLD_C + 10.0f, ms);
+  }
+  CHECK(engine.stack().at(0).dose == 600 * RefillEngine::DOSE_UNITS_PER_CS);
+
+  // At or below the threshold nothing accrues.
+  engine.onTemperature(THERMAL_DOSE_THRESHOLD_C, 61000);
+  uint32_t dose = engine.stack().at(0).dose;
+  engine.onTemperature(THERMAL_DOSE_THRESHOLD_C - 20.0f, 62000);
+  engine.onTemperature(THERMAL_DOSE_THRESHOLD_C + 20.0f, 63000);
+  CHECK(engine.stack().at(0).dose == dose);
+
+  // A reading holds for MAX_TEMP_GAP_MS at most.
+  engine.onTemperature(THERMAL_DOSE_THRESHOLD_C + 20.0f, 663000);
+  CHECK(engine.stack().at(0).dose ==
+        dose + doseFor(200, RefillEngine::MAX_TEMP_GAP_MS));
+}
+
+// 0.3 degrees over sampled every 333 ms earns under one unit per sample;
+// each block carries its own remainder, so nothing is lost or shared.
+void testRemainderPerBlock() {
+  RefillEngine engine;
+  engine.onEncoder(RefillEngine::BARREL_TURNS, 0);
+  refill(engine, 100, 0);
+  uint32_t ms = 0;
+  for (int i = 0; i <= 3000; i++, ms += 333) {
+    if (ms > 5000 && engine.stack().count() == 1) {
+      refill(engine, 50, 5000);
+    }
+    engine.onTemperature(THERMAL_DOSE_THRESHOLD_C + 0.3f, ms);
+  }
+  uint32_t end = 3000 * 333;
+  CHECK(engine.stack().at(0).dose == doseFor(3, end));
+  CHECK(engine.stack().at(1).dose == doseFor(3, end - 5000));
+}
+
+// A block pushed between two samples counts from when it landed, not from
+// the sample before.
+void testBlockCountsFromPush() {
+  RefillEngine engine;
+  engine.onEncoder(RefillEngine::BARREL_TURNS, 0);
+  refill(engine, 100, 0);
+  float hot = THERMAL_DOSE_THRESHOLD_C + 50.0f;
+  engine.onTemperature(hot, 0);
+  refill(engine, 50, 4000);
+  engine.onTemperature(hot, 10000);
+  CHECK(engine.stack().at(0).dose == doseFor(500, 10000));
+  CHECK(engine.stack().at(1).dose == doseFor(500, 6000));
+
+  // Pushed after a reading stopped holding: nothing until the next one.
+  refill(engine, 50, 25000);
+  engine.onTemperature(hot, 30000);
+  CHECK(engine.stack().at(2).dose == 0);
+  engine.onTemperature(hot, 31000);
+  CHECK(engine.stack().at(2).dose == doseFor(500, 1000));
+}
+
+// Barrel temperature at `second` of a replayed trace: a ramp from 170 C
+// to 230 C over 60 s, a soak, then cooling from 480 s.
+int traceTenths(int second) {
+  if (second < 60) {
+    return 1700 + second * 10;
+  }
+  return second < 480 ? 2300 : 2300 - (second - 480) * 10;
+}
+
+// Replaying the trace at 1 Hz, with a refill half a second before a sample
+// and the bottom block shot out later, gives each block the dose of the
+// time it spent in the barrel. The retired block keeps the dose it left
+// with.
+void testTraceReplay() {
+  RefillEngine engine;
+  engine.onEncoder(RefillEngine::BARREL_TURNS, 0);
+  refill(engine, 60, 0);
+  uint32_t product[2] = {}; // tenths x ms, expected per block
+  for (int second = 0; second <= 600; second++) {
+    uint32_t ms = second * 1000;
+    if (second == 200) {
+      refill(engine, 30, ms - 500);
+    }
+    if (second == 400) {
+      float position = RefillEngine::BARREL_TURNS -
+                       engine.stack().totalVolume();
+      engine.onState("INJECT", ms);
+      engine.onEncoder(position + engine.stack().at(0).volume, ms);
+      engine.onState("READY_TO_INJECT", ms);
+    }
+    engine.onTemperature(traceTenths(second) / 10.0f, ms);
+
+    // The reading before this one held over the last second, or over the
+    // half second since the refill landed.
+    int excess = second > 0 ? traceTenths(second - 1) -
+                                  THERMAL_DOSE_THRESHOLD_C * 10
+                            : 0;
+    if (excess <= 0) {
+      continue;
+    }
+    if (second < 400) {
+      product[0] += excess * 1000;
+    }
+    if (second >= 200) {
+      product[1] += excess * (second == 200 ? 500 : 1000);
+    }
+  }
+  CHECK(engine.stack().count() == 1);
+  CHECK(engine.stack().retiredTotal() == 1);
+  const RetiredBlock *shot = engine.stack().retired(0);
+  CHECK(shot->volume == 60 && shot->exhaustedMs == 400000);
+  CHECK(shot->dose == doseFor(1, product[0]));
+  CHECK(engine.stack().at(0).dose == doseFor(1, product[1]));
+}
+
+} // namespace
+
+int main() {
+  testSession();
+  testDeterministic();
+  testFullStackAndHistory();
+  testRestore();
+  testSteadyDose();
+  testRemainderPerBlock();
+  testBlockCountsFromPush();
+  testTraceReplay();
+  std::puts("test_refill_engine: ok");
+  return 0;
+}
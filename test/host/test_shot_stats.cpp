@@ -0,0 +1,155 @@
+#include "host_support.h"
+
+#include "display_comms.h"
+#include "shot_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Replays one recorded shot cycle: READY_TO_INJECT, injection with the
+// plunger moving `turns` in ten ENC steps, pack, refill, and back.
+struct Machine {
+  ShotStats stats;
+  uint32_t ms = 0;
+  float position = 100.0f;
+
+  Machine() {
+    stats.onEncoder(position, ms);
+    stats.onState("READY_TO_INJECT", ms);
+  }
+
+  void shot(float turns, uint32_t fillMs = 2000, uint32_t waitMs = 3000) {
+    ms += waitMs;
+    stats.onState("INJECT", ms);
+    for (int step = 1; step <= 10; step++) {
+      stats.onEncoder(position + turns * step / 10, ms + step * 100);
+    }
+    position += turns;
+    ms += fillMs;
+    stats.onState("PACK", ms);
+    stats.onState("PACK", ms + 100); // repeated state
+    ms += 5000;
+    stats.onState("REFILL", ms);
+    position -= turns; // refill pulls the plunger back up
+    stats.onEncoder(position, ms + 500);
+    ms += 3000;
+    stats.onState("READY_TO_INJECT", ms);
+  }
+
+  ShotSummary summary() const {
+    ShotSummary out;
+    stats.summary(out);
+    return out;
+  }
+};
+
+bool near(float a, float b) { return fabsf(a - b) < 1e-4f; }
+
+// A steady run with one short shot: only that shot is flagged, and only on
+// volume, which is reported in cm3.
+void testReplay() {
+  Machine machine;
+  for (int i = 0; i < 30; i++) {
+    float turns = i == 25 ? 5.0f : 10.0f + (i % 3) * 0.1f;
+    machine.shot(turns, 2000 + (i % 2) * 10);
+  }
+  ShotSummary summary = machine.summary();
+  CHECK(summary.shots == 30);
+  CHECK(summary.outOfControl == 1);
+  CHECK(summary.lastFlags == 0);
+
+  const ShotSummary::Metric &volume = summary.metrics[SHOT_VOLUME];
+  CHECK(volume.count == 30);
+  CHECK(near(volume.last, 10.2f / DisplayComms::TURNS_PER_CM3));
+  CHECK(fabsf(volume.p50 - 10.1f / DisplayComms::TURNS_PER_CM3) < 0.1f);
+
+  const ShotSummary::Metric &fill = summary.metrics[SHOT_FILL];
+  CHECK(fill.count == 30 && near(fill.mean, 2.005f));
+  // Cycle time needs the shot before it, so it sees 15 short fills and 14
+  // long ones.
+  const ShotSummary::Metric &cycle = summary.metrics[SHOT_CYCLE];
+  CHECK(cycle.count == 29);
+  CHECK(near(cycle.mean, (3000 + 2000 + 5000 + 3000 + 140 / 29.0f) / 1000));
+}
+
+// Identical shots give a standard deviation of 0; a deviation the machine
+// can measure is still flagged, one below its resolution is not.
+void testZeroSpread() {
+  Machine machine;
+  for (uint32_t i = 0; i < ShotStats::MIN_SHOTS_FOR_LIMITS; i++) {
+    machine.shot(10.0f);
+  }
+  CHECK(machine.summary().metrics[SHOT_VOLUME].stddev == 0.0f);
+  CHECK(machine.summary().metrics[SHOT_FILL].stddev == 0.0f);
+
+  machine.shot(10.005f);
+  CHECK(machine.summary().lastFlags == 0);
+  machine.shot(10.05f);
+  CHECK(machine.summary().lastFlags == 1u << SHOT_VOLUME);
+  machine.shot(10.0f, 2050);
+  CHECK(machine.summary().lastFlags == 1u << SHOT_FILL);
+  CHECK(machine.summary().outOfControl == 2);
+}
+
+// No limits before MIN_SHOTS_FOR_LIMITS shots; a long break is not a cycle
+// and an abandoned shot is not counted.
+void testEdges() {
+  Machine machine;
+  machine.shot(10.0f);
+  machine.shot(50.0f);
+  CHECK(machine.summary().outOfControl == 0);
+
+  machine.shot(10.0f, 2000, ShotStats::MAX_CYCLE_MS);
+  CHECK(machine.summary().metrics[SHOT_CYCLE].count == 1);
+  machine.shot(10.0f, ShotStats::MAX_SHOT_MS);
+  CHECK(machine.summary().shots == 3);
+
+  machine.stats.reset();
+  CHECK(machine.summary().shots == 0);
+  CHECK(machine.summary().metrics[SHOT_VOLUME].count == 0);
+}
+
+// The P-squared estimates stay close to the exact quantiles of a
+// reproducible sample.
+void testQuantiles() {
+  P2Quantile median(0.5f);
+  P2Quantile high(0.95f);
+  RunningStats stats;
+  std::vector<float> values;
+  uint32_t seed = 1;
+  for (int i = 0; i < 5000; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    float value = 10.0f + (seed >> 8) * (4.0f / (1u << 24)); // 10..14
+    median.add(value);
+    high.add(value);
+    stats.add(value);
+    values.push_back(value);
+  }
+  std::sort(values.begin(), values.end());
+  CHECK(fabsf(median.value() - values[2500]) < 0.05f);
+  CHECK(fabsf(high.value() - values[4750]) < 0.05f);
+  CHECK(fabsf(stats.mean() - 12.0f) < 0.05f);
+  CHECK(stats.min() == values.front() && stats.max() == values.back());
+
+  P2Quantile few(0.5f);
+  few.add(3);
+  few.add(1);
+  few.add(2);
+  CHECK(few.value() == 2);
+}
+
+} // namespace
+
+int main() {
+  testReplay();
+  testZeroSpread();
+  testEdges();
+  testQuantiles();
+  std::puts("test_shot_stats: ok");
+  return 0;
+}